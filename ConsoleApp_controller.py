@@ -3,6 +3,7 @@ from tkinter import ttk, filedialog, messagebox, scrolledtext
 import ttkbootstrap as bs
 import subprocess
 import pandas as pd
+from ant_results import load_results, load_profile, follow_metrics
 import os
 import threading
 import queue
@@ -10,8 +11,12 @@ import queue
 class SimulationLauncherApp(bs.Window):
     """
     A GUI application to launch a C++ ant simulation, configure its parameters,
-    and display the resulting data from the output CSV file.
+    plot the sampled cluster sizes live and display the resulting data from
+    the output CSV file.
     """
+    PLOT_COLORS = ["#1f77b4", "#ff7f0e", "#2ca02c", "#d62728", "#9467bd",
+                   "#8c564b", "#e377c2", "#7f7f7f", "#bcbd22", "#17becf"]
+
     def __init__(self):
         super().__init__(themename="litera") # You can try other themes like 'superhero', 'darkly', 'litera'
         self.title("Ant Simulation Launcher")
@@ -24,6 +29,9 @@ class SimulationLauncherApp(bs.Window):
         
         # Queue for thread-safe communication with the GUI
         self.log_queue = queue.Queue()
+        # Events of the live metrics stream, and what the plot shows so far
+        self.metrics_queue = queue.Queue()
+        self.reset_live_plot()
 
         # --- UI Setup ---
         self.setup_ui()
@@ -83,6 +91,13 @@ class SimulationLauncherApp(bs.Window):
             "cooldown_start": ("Cooldown Start", "0"), "cooldown_end": ("Cooldown End", "20"),
             "cooldown_interval": ("Cooldown Interval", "5"),
             "prob_relu_low": ("Prob. ReLU Low", "0.3"), "prob_relu_high": ("Prob. ReLU High", "0.7"),
+            "seed": ("Random Seed", "20240601"),
+            "sample_interval": ("Sample Interval", "10000"),
+            "neighborhood": ("Neighborhood (moore/von_neumann)", "moore"),
+            "grid_layout": ("Grid Layout (row_major/tiled)", "row_major"),
+            "sort_interval": ("Ant Sort Interval (0 = off)", "0"),
+            "converge_tolerance": ("Convergence Tolerance (0 = off)", "0"),
+            "converge_window": ("Convergence Window (samples)", "10"),
         }
 
         row_num = 0
@@ -108,10 +123,17 @@ class SimulationLauncherApp(bs.Window):
         status_bar.pack(side=tk.BOTTOM, fill=tk.X, pady=(10, 0))
 
     def create_results_display(self, parent_frame):
-        """Creates the table view for displaying CSV data."""
+        """Creates the live plot and the table view for displaying CSV data."""
         ttk.Label(parent_frame, text="Simulation Results", font="-weight bold").pack(anchor="w")
-        tree_container = ttk.Frame(parent_frame)
-        tree_container.pack(fill=tk.BOTH, expand=True, pady=5)
+        notebook = ttk.Notebook(parent_frame)
+        notebook.pack(fill=tk.BOTH, expand=True, pady=5)
+
+        self.plot_canvas = tk.Canvas(notebook, background="white", highlightthickness=0)
+        self.plot_canvas.bind("<Configure>", lambda _: self.draw_live_plot())
+        notebook.add(self.plot_canvas, text="Live Plot")
+
+        tree_container = ttk.Frame(notebook)
+        notebook.add(tree_container, text="Table")
         self.results_tree = ttk.Treeview(tree_container, show="headings", bootstyle="primary")
         
         vsb = ttk.Scrollbar(tree_container, orient="vertical", command=self.results_tree.yview)
@@ -136,15 +158,95 @@ class SimulationLauncherApp(bs.Window):
         self.console_output.config(state='disabled')
 
     def process_log_queue(self):
-        """Processes messages from the log queue to update the GUI."""
+        """Processes messages from the log and metrics queues to update the GUI."""
         try:
             while True:
                 message = self.log_queue.get_nowait()
                 self.log_message(message)
         except queue.Empty:
             pass # No more messages
+        try:
+            while True:
+                self.handle_metrics_event(self.metrics_queue.get_nowait())
+        except queue.Empty:
+            pass
+        if self.plot_dirty:
+            self.draw_live_plot()
         self.after(100, self.process_log_queue) # Check again after 100ms
 
+    def reset_live_plot(self):
+        self.live_series = {}
+        self.live_configs = {}
+        self.runs_total = 0
+        self.runs_done = 0
+        self.plot_iterations = 1
+        self.plot_dirty = True
+
+    def handle_metrics_event(self, event):
+        """Adds one event of the --metrics_output stream to the live plot."""
+        kind = event.get("event")
+        if kind == "start":
+            self.reset_live_plot()
+            self.runs_total = event.get("runs", 0)
+            self.plot_iterations = max(event.get("parameters", {}).get("iterations", 1), 1)
+        elif kind == "sample":
+            config = (event["cooldown"], event["threshold"])
+            self.live_configs.setdefault(config, len(self.live_configs))
+            key = config + (event["run"],)
+            self.live_series.setdefault(key, []).append((event["iteration"], event["cluster"]))
+            self.status_var.set(f"Runs finished: {self.runs_done}/{self.runs_total}. "
+                                f"C: {key[0]}, T: {key[1]}, Exp: {key[2]}, Iter: {event['iteration']}, "
+                                f"Cluster: {event['cluster']:.3f}, Interact: {event['interactions']}")
+            self.plot_dirty = True
+        elif kind == "run_end":
+            self.runs_done += 1
+            self.status_var.set(f"Runs finished: {self.runs_done}/{self.runs_total}.")
+            if "converged" in event:
+                self.log_message(f"C: {event['cooldown']}, T: {event['threshold']}, Exp: {event['run']} "
+                                 f"converged at iteration {event['converged']}\n")
+        elif kind == "end" and event.get("dropped", 0):
+            self.log_message(f"Metrics stream dropped {event['dropped']} samples; the live plot is incomplete.\n")
+
+    def draw_live_plot(self):
+        """Draws the cluster size of every run against the iteration, one colour per (cooldown, threshold)."""
+        self.plot_dirty = False
+        canvas = self.plot_canvas
+        canvas.delete("all")
+        width, height = canvas.winfo_width(), canvas.winfo_height()
+        left, right, top, bottom = 60, 20, 20, 40
+        if width <= left + right or height <= top + bottom:
+            return
+        y_max = max((c for points in self.live_series.values() for _, c in points), default=1.0) * 1.05 or 1.0
+        x_max = self.plot_iterations
+
+        def to_xy(iteration, cluster):
+            return (left + (width - left - right) * iteration / x_max,
+                    height - bottom - (height - top - bottom) * cluster / y_max)
+
+        canvas.create_rectangle(left, top, width - right, height - bottom, outline="#999999")
+        for k in range(5):
+            x, y = to_xy(x_max * k / 4, y_max * k / 4)
+            canvas.create_text(x, height - bottom + 12, text=f"{x_max * k / 4:.0f}", fill="#555555")
+            canvas.create_text(left - 8, y, text=f"{y_max * k / 4:.2f}", anchor="e", fill="#555555")
+        canvas.create_text((left + width - right) / 2, height - 10, text="Iteration")
+        canvas.create_text(14, (top + height - bottom) / 2, text="Cluster", angle=90)
+        for (cooldown, threshold, _), points in self.live_series.items():
+            color = self.PLOT_COLORS[self.live_configs[(cooldown, threshold)] % len(self.PLOT_COLORS)]
+            coords = [v for point in points for v in to_xy(*point)]
+            if len(coords) >= 4:
+                canvas.create_line(*coords, fill=color)
+        for (cooldown, threshold), index in self.live_configs.items():
+            canvas.create_text(width - right - 8, top + 10 + 14 * index, anchor="e",
+                               text=f"C {cooldown}, T {threshold}", fill=self.PLOT_COLORS[index % len(self.PLOT_COLORS)])
+
+    def follow_metrics_stream(self, metrics_path, process):
+        """Forwards the events of a running simulation's metrics stream to the GUI thread."""
+        try:
+            for event in follow_metrics(metrics_path, lambda: process.poll() is not None):
+                self.metrics_queue.put(event)
+        except (OSError, ValueError) as e:
+            self.log_queue.put(f"Could not follow metrics stream {metrics_path}: {e}\n")
+
     def browse_for_exe(self):
         path = filedialog.askopenfilename(title="Select Executable", filetypes=(("Executable files", "*.exe"), ("All files", "*.*")))
         if path: self.executable_path.set(path)
@@ -177,6 +279,19 @@ class SimulationLauncherApp(bs.Window):
                 command.append(f"--{name}")
                 command.append(entry.get())
             command.append("--csv_filename"); command.append(self.output_csv_path.get())
+            # A .antcol output path selects the binary columnar format.
+            if self.output_csv_path.get().lower().endswith(".antcol"):
+                command.append("--output_format"); command.append("binary")
+            # Only written by executables built with ANT_PROFILING.
+            profile_path = self.output_csv_path.get() + ".profile.json"
+            if os.path.exists(profile_path):
+                os.remove(profile_path)
+            command.append("--profile_output"); command.append(profile_path)
+            # Progress and samples arrive through the metrics stream, not the console.
+            metrics_path = self.output_csv_path.get() + ".metrics.ndjson"
+            if os.path.exists(metrics_path):
+                os.remove(metrics_path)
+            command.append("--metrics_output"); command.append(metrics_path)
         except ValueError:
             messagebox.showerror("Error", "Invalid parameter value. Please ensure all inputs are correct.")
             self.status_var.set("Error: Invalid parameter.")
@@ -185,12 +300,15 @@ class SimulationLauncherApp(bs.Window):
 
         try:
             process = subprocess.Popen(command, stdout=subprocess.PIPE, stderr=subprocess.STDOUT, text=True, creationflags=subprocess.CREATE_NO_WINDOW)
+            follower = threading.Thread(target=self.follow_metrics_stream, args=(metrics_path, process), daemon=True)
+            follower.start()
             
             for line in iter(process.stdout.readline, ''):
                 self.log_queue.put(line)
 
             process.stdout.close()
             return_code = process.wait()
+            follower.join()
 
             if return_code != 0:
                 self.log_queue.put(f"\n--- SIMULATION FAILED (Exit Code: {return_code}) ---\n")
@@ -199,6 +317,7 @@ class SimulationLauncherApp(bs.Window):
                 self.log_queue.put("\n--- SIMULATION FINISHED SUCCESSFULLY ---\n")
                 self.status_var.set("Simulation finished successfully. Loading results...")
                 self.load_results_from_csv() 
+                self.log_profile(profile_path)
                 self.status_var.set("Ready.")
 
         except FileNotFoundError:
@@ -211,13 +330,29 @@ class SimulationLauncherApp(bs.Window):
         finally:
             self.run_button.config(state=tk.NORMAL)
 
+    def log_profile(self, profile_path):
+        """Logs where the run spent its time, if the executable recorded a profile."""
+        if not os.path.exists(profile_path):
+            return
+        try:
+            phases, counters = load_profile(profile_path)
+        except (OSError, ValueError, KeyError) as e:
+            self.log_queue.put(f"Could not read profile {profile_path}: {e}\n")
+            return
+        lines = ["\n--- PROFILE ---\n"]
+        for _, row in phases.iterrows():
+            lines.append(f"{row['Phase']:<24}{row['Seconds']:>10.3f} s {row['Share']:>7.1%}\n")
+        for name, value in counters.items():
+            lines.append(f"{name:<24}{value:>12}\n")
+        self.log_queue.put("".join(lines))
+
     def load_results_from_csv(self):
         csv_path = self.output_csv_path.get()
         if not os.path.exists(csv_path):
             messagebox.showwarning("Warning", f"Could not find the results file:\n{csv_path}")
             return
         try:
-            df = pd.read_csv(csv_path)
+            df = load_results(csv_path)
             # The results table is cleared and rebuilt dynamically from the CSV columns
             for item in self.results_tree.get_children(): self.results_tree.delete(item)
             self.results_tree["columns"] = list(df.columns)
@@ -0,0 +1,107 @@
+"""
+Loader for ConsoleApp_ffmpeg result files.
+
+Both output formats load into the same pandas DataFrame. Binary columnar
+files (--output_format binary) are memory mapped, so the columns are not
+parsed at all; their JSON parameter header is returned in df.attrs["parameters"].
+The NDJSON stream of --metrics_output can be followed while a run writes it.
+"""
+import json
+import os
+import time
+import numpy as np
+import pandas as pd
+
+MAGIC = b"ANTCOL1\0"
+COLUMNS = ["Cooldown", "Threshold", "Run", "Iteration", "ClusterSize", "InteractionCount"]
+
+
+def is_binary_results(path):
+    with open(path, "rb") as f:
+        return f.read(len(MAGIC)) == MAGIC
+
+
+def load_binary_results(path):
+    with open(path, "rb") as f:
+        header = f.read(16)
+        if header[:8] != MAGIC:
+            raise ValueError(f"{path} is not a binary results file")
+        version, meta_len = np.frombuffer(header, dtype="<u4", offset=8, count=2)
+        if version not in (1, 2):
+            raise ValueError(f"Unsupported results format version {version}")
+        metadata = f.read(int(meta_len)).decode("utf-8")
+
+    offset = 16 + int(meta_len)
+    offset += (8 - offset % 8) % 8
+    data = np.memmap(path, dtype=np.uint8, mode="r")
+    rows = int(np.frombuffer(data, dtype="<u8", offset=offset, count=1)[0])
+    offset += 8
+
+    # Version 2 adds the ConvergedIteration column of --converge_tolerance runs.
+    names = COLUMNS + ["ConvergedIteration"] if version == 2 else COLUMNS
+    columns = {"ClusterSize": np.frombuffer(data, dtype="<f8", offset=offset, count=rows)}
+    offset += 8 * rows
+    for name in names:
+        if name == "ClusterSize":
+            continue
+        columns[name] = np.frombuffer(data, dtype="<i4", offset=offset, count=rows)
+        offset += 4 * rows
+
+    df = pd.DataFrame({name: columns[name] for name in names}, copy=False)
+    df.attrs["parameters"] = json.loads(metadata) if metadata else {}
+    return df
+
+
+def load_results(path):
+    """Load a results file written in either CSV or binary columnar format."""
+    if is_binary_results(path):
+        return load_binary_results(path)
+    return pd.read_csv(path)
+
+
+def load_profile(path):
+    """
+    Load the --profile_output JSON of a profiling build.
+
+    Returns (phases, counters): phases is a DataFrame with one row per timed
+    phase (Seconds, Calls, Share of the timed total), counters a dict of
+    event counts. Both are summed over all threads.
+    """
+    with open(path, "r", encoding="utf-8") as f:
+        profile = json.load(f)
+    total = profile["total"]
+    phases = pd.DataFrame(
+        [(name, p["ns"] * 1e-9, p["calls"]) for name, p in total["phases"].items() if p["calls"]],
+        columns=["Phase", "Seconds", "Calls"])
+    timed = phases["Seconds"].sum()
+    phases["Share"] = phases["Seconds"] / timed if timed > 0 else 0.0
+    return phases, total["counters"]
+
+
+def follow_metrics(path, stop, poll=0.1):
+    """
+    Yield the events of a --metrics_output stream as dicts while it is written.
+
+    Waits for the file to appear and for complete new lines. Returns after the
+    "end" event, or when stop() is true and no further lines are available,
+    e.g. because the simulation exited early.
+    """
+    while not os.path.exists(path):
+        if stop():
+            return
+        time.sleep(poll)
+    with open(path, "r", encoding="utf-8") as f:
+        line = ""
+        while True:
+            line += f.readline()
+            if not line.endswith("\n"):
+                # Nothing new, or the writer is in the middle of a line.
+                if stop():
+                    return
+                time.sleep(poll)
+                continue
+            event = json.loads(line)
+            line = ""
+            yield event
+            if event.get("event") == "end":
+                return
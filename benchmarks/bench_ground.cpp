@@ -0,0 +1,559 @@
+// File: benchmarks/bench_ground.cpp
+//
+// Microbenchmarks for the Ant and Ground hot paths. Every case is timed over
+// enough iterations to run for at least --min_time seconds, and the results
+// are printed as a table, CSV or JSON so runs can be compared over time.
+//
+// How to compile (from the root project directory):
+//   Using g++:
+//   g++ -std=c++17 -O3 -fopenmp -DIS_TEST_BUILD -Iinclude benchmarks/bench_ground.cpp src/Ant.cpp src/AntColony.cpp src/Ground.cpp src/Grid.cpp src/DirectionSampler.cpp src/MemoryRing.cpp src/CellIndex.cpp src/ClusterTracker.cpp src/FramePipeline.cpp src/Profiling.cpp src/VisitBitmap.cpp src/ReplicaBatch.cpp -o benchmarks/ant_bench
+//
+// How to run:
+//   ./benchmarks/ant_bench [--filter Ground/assignWork] [--format console|csv|json]
+//                          [--min_time 0.2] [--sizes 50,256,1024,4096]
+//                          [--ants 100,1000,10000] [--memory 20]
+//
+// Case names encode their parameters, e.g. "Ground/assignWork/1024/1000/20" is
+// a 1024x1024 ground with 1000 ants of memory size 20.
+//
+
+#include "ant_intelligence/Ant.h"
+#include "ant_intelligence/Config.h"
+#include "ant_intelligence/DirectionSampler.h"
+#include "ant_intelligence/Ground.h"
+#include "ant_intelligence/ReplicaBatch.h"
+#include "ant_intelligence/Rng.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <numeric>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+/**
+ * @brief Timing state handed to a benchmark body
+ *
+ * A runner performs its operation iterations() times. Work inside the loop
+ * that should not be measured (refilling a ground, moving ants before a work
+ * pass) goes between pause() and resume().
+ */
+class BenchState {
+public:
+    explicit BenchState(std::int64_t iterations) : count(iterations) {}
+
+    std::int64_t iterations() const { return count; }
+    void pause() { elapsed += Clock::now() - started; }
+    void resume() { started = Clock::now(); }
+    /** @brief Number of items (ants, cells) one iteration processes */
+    void setItemsPerIteration(double items) { itemsPerIteration = items; }
+
+    void start() { elapsed = Clock::duration::zero(); started = Clock::now(); }
+    void stop() { elapsed += Clock::now() - started; }
+    double seconds() const { return std::chrono::duration<double>(elapsed).count(); }
+    double items() const { return itemsPerIteration; }
+
+private:
+    std::int64_t count;
+    Clock::time_point started;
+    Clock::duration elapsed = Clock::duration::zero();
+    double itemsPerIteration = 1.0;
+};
+
+/** @brief Timed part of a case; runs state.iterations() operations */
+using BenchRunner = std::function<void(BenchState&)>;
+
+/** @brief A named case whose untimed setup builds its runner once */
+struct BenchCase {
+    std::string name;
+    std::function<BenchRunner()> setup;
+};
+
+struct BenchResult {
+    std::string name;
+    std::int64_t iterations;
+    double nsPerIteration;
+    double itemsPerSecond;
+};
+
+struct BenchOptions {
+    std::string filter;
+    std::string format = "console";
+    double minTime = 0.2;
+    std::vector<int> sizes = { 50, 256, 1024, 4096 };
+    std::vector<int> ants = { 100, 1000, 10000 };
+    std::vector<int> memory = { AIConfig::DEFAULT_MEMORY_SIZE };
+};
+
+std::vector<int> parse_list(const std::string& text) {
+    std::vector<int> values;
+    std::stringstream stream(text);
+    std::string item;
+    while (std::getline(stream, item, ',')) {
+        int value = std::stoi(item);
+        if (value <= 0) {
+            throw std::invalid_argument("Benchmark parameters must be positive");
+        }
+        values.push_back(value);
+    }
+    if (values.empty()) {
+        throw std::invalid_argument("Empty benchmark parameter list");
+    }
+    return values;
+}
+
+BenchOptions parse_options(int argc, char* argv[]) {
+    BenchOptions options;
+    for (int i = 1; i < argc; ++i) {
+        std::string key = argv[i];
+        if (i + 1 >= argc) {
+            throw std::invalid_argument("Missing value for " + key);
+        }
+        std::string value = argv[++i];
+        if (key == "--filter") options.filter = value;
+        else if (key == "--format") options.format = value;
+        else if (key == "--min_time") options.minTime = std::stod(value);
+        else if (key == "--sizes") options.sizes = parse_list(value);
+        else if (key == "--ants") options.ants = parse_list(value);
+        else if (key == "--memory") options.memory = parse_list(value);
+        else throw std::invalid_argument("Unknown option " + key);
+    }
+    if (options.format != "console" && options.format != "csv" && options.format != "json") {
+        throw std::invalid_argument("--format must be console, csv or json");
+    }
+    return options;
+}
+
+// Same movement weights and object mix as the console application.
+std::vector<double> movement_probabilities() {
+    std::vector<double> prob = { 12, 5, 2, 1, 0.1, 1, 2, 5 };
+    double sum = std::accumulate(prob.begin(), prob.end(), 0.0);
+    for (auto& p : prob) {
+        p /= sum;
+    }
+    return prob;
+}
+
+const std::unordered_map<AIConfig::ObjectType, double>& object_mix() {
+    static const std::unordered_map<AIConfig::ObjectType, double> mix = {
+        {AIConfig::ObjectType::Food,  0.05},
+        {AIConfig::ObjectType::Egg,   0.05},
+        {AIConfig::ObjectType::Waste, 0.05},
+        {AIConfig::ObjectType::None,  0.85}
+    };
+    return mix;
+}
+
+Ground make_ground(int size, int ants, int memorySize) {
+    Ground ground(size, size, movement_probabilities(),
+        { AIConfig::DEFAULT_PROB_RELU[0], AIConfig::DEFAULT_PROB_RELU[1] },
+        AIConfig::DEFAULT_THRESHOLD_START, AIConfig::DEFAULT_INTERACTION_COOLDOWN, AIConfig::DEFAULT_SEED);
+    ground.addObject(object_mix());
+    for (int i = 0; i < ants; ++i) {
+        ground.addAnt(memorySize);
+    }
+    return ground;
+}
+
+// Keeps the optimiser from discarding a computed value.
+volatile double sink;
+
+std::string case_name(const std::string& base, std::initializer_list<int> args) {
+    std::string name = base;
+    for (int arg : args) {
+        name += "/" + std::to_string(arg);
+    }
+    return name;
+}
+
+std::vector<BenchCase> build_cases(const BenchOptions& options) {
+    std::vector<BenchCase> cases;
+    const std::vector<double> prob = movement_probabilities();
+    const std::vector<double> probRelu = { AIConfig::DEFAULT_PROB_RELU[0], AIConfig::DEFAULT_PROB_RELU[1] };
+
+    cases.push_back({ "Ant/getRandomWeightedDirection", [prob]() -> BenchRunner {
+        auto ant = std::make_shared<Ant>(std::pair<int, int>{ 0, 0 }, 1, 1);
+        return [prob, ant](BenchState& state) {
+            CounterRng gen(AIConfig::DEFAULT_SEED, 0, 0);
+            int direction = 0;
+            for (std::int64_t i = 0; i < state.iterations(); ++i) {
+                direction = ant->getRandomWeightedDirection(prob, direction, gen);
+            }
+            sink = direction;
+        };
+    } });
+
+    cases.push_back({ "DirectionSampler/sample", [prob]() -> BenchRunner {
+        auto sampler = std::make_shared<DirectionSampler>(prob);
+        return [sampler](BenchState& state) {
+            CounterRng gen(AIConfig::DEFAULT_SEED, 0, 0);
+            int direction = 0;
+            for (std::int64_t i = 0; i < state.iterations(); ++i) {
+                direction = sampler->sample(direction, gen);
+            }
+            sink = direction;
+        };
+    } });
+
+    for (int size : options.sizes) {
+        cases.push_back({ case_name("Ant/move", { size }), [prob, size]() -> BenchRunner {
+            auto sampler = std::make_shared<DirectionSampler>(prob);
+            auto ant = std::make_shared<Ant>(std::pair<int, int>{ size / 2, size / 2 }, size, size);
+            return [sampler, ant](BenchState& state) {
+                CounterRng gen(AIConfig::DEFAULT_SEED, 0, 0);
+                for (std::int64_t i = 0; i < state.iterations(); ++i) {
+                    ant->move(*sampler, gen);
+                }
+                sink = ant->getPosition().first;
+            };
+        } });
+
+        cases.push_back({ case_name("Ant/move/recordPath", { size }), [prob, size]() -> BenchRunner {
+            auto sampler = std::make_shared<DirectionSampler>(prob);
+            auto ant = std::make_shared<Ant>(std::pair<int, int>{ size / 2, size / 2 }, size, size, true);
+            return [sampler, ant](BenchState& state) {
+                CounterRng gen(AIConfig::DEFAULT_SEED, 0, 0);
+                for (std::int64_t i = 0; i < state.iterations(); ++i) {
+                    ant->move(*sampler, gen);
+                }
+                sink = static_cast<double>(ant->getVisitedPositions().size());
+            };
+        } });
+    }
+
+    for (int size : options.sizes) {
+        const double cells = static_cast<double>(size) * size;
+
+        cases.push_back({ case_name("Ground/construct", { size }), [prob, probRelu, size, cells]() -> BenchRunner {
+            return [prob, probRelu, size, cells](BenchState& state) {
+                state.setItemsPerIteration(cells);
+                for (std::int64_t i = 0; i < state.iterations(); ++i) {
+                    Ground ground(size, size, prob, probRelu, AIConfig::DEFAULT_THRESHOLD_START);
+                    sink = ground.getInteractionCount();
+                }
+            };
+        } });
+
+        cases.push_back({ case_name("Ground/addObject", { size }), [size, cells]() -> BenchRunner {
+            auto ground = std::make_shared<Ground>(make_ground(size, 0, AIConfig::DEFAULT_MEMORY_SIZE));
+            return [ground, cells](BenchState& state) {
+                state.setItemsPerIteration(cells);
+                for (std::int64_t i = 0; i < state.iterations(); ++i) {
+                    ground->addObject(object_mix());
+                }
+            };
+        } });
+
+        // The first query after a refill rebuilds the tracker from scratch;
+        // later ones are answered from the incrementally maintained counts.
+        cases.push_back({ case_name("Ground/averageClusterSize/rebuild", { size }), [size, cells]() -> BenchRunner {
+            auto ground = std::make_shared<Ground>(make_ground(size, 0, AIConfig::DEFAULT_MEMORY_SIZE));
+            return [ground, cells](BenchState& state) {
+                state.setItemsPerIteration(cells);
+                for (std::int64_t i = 0; i < state.iterations(); ++i) {
+                    state.pause();
+                    ground->addObject(object_mix());
+                    state.resume();
+                    sink = ground->averageClusterSize();
+                }
+            };
+        } });
+
+        cases.push_back({ case_name("Ground/averageClusterSize/incremental", { size }), [size]() -> BenchRunner {
+            auto ground = std::make_shared<Ground>(make_ground(size, 0, AIConfig::DEFAULT_MEMORY_SIZE));
+            sink = ground->averageClusterSize();
+            return [ground](BenchState& state) {
+                for (std::int64_t i = 0; i < state.iterations(); ++i) {
+                    sink = ground->averageClusterSize();
+                }
+            };
+        } });
+    }
+
+    for (int size : options.sizes) {
+        for (int ants : options.ants) {
+            // Placement on a fresh ground, as at the start of every sweep run.
+            cases.push_back({ case_name("Ground/addAnts", { size, ants }), [prob, probRelu, size, ants]() -> BenchRunner {
+                return [prob, probRelu, size, ants](BenchState& state) {
+                    state.setItemsPerIteration(ants);
+                    for (std::int64_t i = 0; i < state.iterations(); ++i) {
+                        state.pause();
+                        Ground ground(size, size, prob, probRelu, AIConfig::DEFAULT_THRESHOLD_START);
+                        state.resume();
+                        ground.addAnts(ants, AIConfig::DEFAULT_MEMORY_SIZE);
+                        sink = static_cast<double>(ground.getColony().size());
+                    }
+                };
+            } });
+
+            cases.push_back({ case_name("Ground/moveAnts", { size, ants }), [size, ants]() -> BenchRunner {
+                auto ground = std::make_shared<Ground>(make_ground(size, ants, AIConfig::DEFAULT_MEMORY_SIZE));
+                return [ground, ants](BenchState& state) {
+                    state.setItemsPerIteration(ants);
+                    for (std::int64_t i = 0; i < state.iterations(); ++i) {
+                        ground->moveAnts();
+                    }
+                };
+            } });
+
+            for (int memorySize : options.memory) {
+                cases.push_back({ case_name("Ground/phasedStep", { size, ants, memorySize }),
+                    [size, ants, memorySize]() -> BenchRunner {
+                    auto ground = std::make_shared<Ground>(make_ground(size, ants, memorySize));
+                    return [ground, ants](BenchState& state) {
+                        state.setItemsPerIteration(ants);
+                        for (std::int64_t i = 0; i < state.iterations(); ++i) {
+                            ground->moveAnts();
+                            ground->assignWork();
+                            ground->handleAntInteractions(static_cast<int>(i));
+                        }
+                    };
+                } });
+
+                cases.push_back({ case_name("Ground/step", { size, ants, memorySize }),
+                    [size, ants, memorySize]() -> BenchRunner {
+                    auto ground = std::make_shared<Ground>(make_ground(size, ants, memorySize));
+                    return [ground, ants](BenchState& state) {
+                        state.setItemsPerIteration(ants);
+                        for (std::int64_t i = 0; i < state.iterations(); ++i) {
+                            ground->step();
+                        }
+                    };
+                } });
+
+                // Same step on a tiled grid, without and with periodic ant sorting.
+                for (int sortInterval : { 0, 64 }) {
+                    cases.push_back({ case_name(sortInterval ? "Ground/step/tiled/sorted" : "Ground/step/tiled",
+                        { size, ants, memorySize }), [size, ants, memorySize, sortInterval]() -> BenchRunner {
+                        auto ground = std::make_shared<Ground>(make_ground(size, ants, memorySize));
+                        ground->setGridLayout(AIConfig::GridLayout::Tiled);
+                        ground->setAntSortInterval(sortInterval);
+                        return [ground, ants](BenchState& state) {
+                            state.setItemsPerIteration(ants);
+                            for (std::int64_t i = 0; i < state.iterations(); ++i) {
+                                ground->step();
+                            }
+                        };
+                    } });
+                }
+
+                cases.push_back({ case_name("Ground/assignWork", { size, ants, memorySize }),
+                    [size, ants, memorySize]() -> BenchRunner {
+                    auto ground = std::make_shared<Ground>(make_ground(size, ants, memorySize));
+                    return [ground, ants](BenchState& state) {
+                        state.setItemsPerIteration(ants);
+                        for (std::int64_t i = 0; i < state.iterations(); ++i) {
+                            state.pause();
+                            ground->moveAnts();
+                            state.resume();
+                            ground->assignWork();
+                        }
+                    };
+                } });
+
+                // Same pass with the compile-time specialisations switched off.
+                cases.push_back({ case_name("Ground/assignWork/generic", { size, ants, memorySize }),
+                    [size, ants, memorySize]() -> BenchRunner {
+                    auto ground = std::make_shared<Ground>(make_ground(size, ants, memorySize));
+                    ground->setSpecializedKernels(false);
+                    return [ground, ants](BenchState& state) {
+                        state.setItemsPerIteration(ants);
+                        for (std::int64_t i = 0; i < state.iterations(); ++i) {
+                            state.pause();
+                            ground->moveAnts();
+                            state.resume();
+                            ground->assignWork();
+                        }
+                    };
+                } });
+
+                cases.push_back({ case_name("Ground/handleAntInteractions", { size, ants, memorySize }),
+                    [size, ants, memorySize]() -> BenchRunner {
+                    auto ground = std::make_shared<Ground>(make_ground(size, ants, memorySize));
+                    // Warm the memories up so similarity checks see real data.
+                    for (int i = 0; i < 100; ++i) {
+                        ground->moveAnts();
+                        ground->assignWork();
+                    }
+                    return [ground, ants](BenchState& state) {
+                        state.setItemsPerIteration(ants);
+                        for (std::int64_t i = 0; i < state.iterations(); ++i) {
+                            ground->handleAntInteractions(static_cast<int>(i));
+                        }
+                        sink = ground->getInteractionCount();
+                    };
+                } });
+            }
+        }
+    }
+    // Many small sweep runs: separate grounds stepped one after another
+    // against the same runs in one ReplicaBatch. Items are ant-steps.
+    constexpr int REPLICAS = 16;
+    for (int size : options.sizes) {
+        if (size > 256) {
+            continue;
+        }
+        for (int ants : options.ants) {
+            auto make_replicas = [size, ants]() {
+                std::vector<std::shared_ptr<Ground>> grounds;
+                for (int r = 0; r < REPLICAS; ++r) {
+                    Ground ground(size, size, movement_probabilities(),
+                        { AIConfig::DEFAULT_PROB_RELU[0], AIConfig::DEFAULT_PROB_RELU[1] },
+                        AIConfig::DEFAULT_THRESHOLD_START, AIConfig::DEFAULT_INTERACTION_COOLDOWN,
+                        AIConfig::DEFAULT_SEED + r);
+                    ground.addObject(object_mix());
+                    for (int i = 0; i < ants; ++i) {
+                        ground.addAnt(AIConfig::DEFAULT_MEMORY_SIZE);
+                    }
+                    grounds.push_back(std::make_shared<Ground>(std::move(ground)));
+                }
+                return grounds;
+            };
+
+            cases.push_back({ case_name("Replicas/grounds", { size, ants, REPLICAS }), [ants, make_replicas]() -> BenchRunner {
+                auto grounds = make_replicas();
+                return [grounds, ants](BenchState& state) {
+                    state.setItemsPerIteration(static_cast<double>(ants) * REPLICAS);
+                    for (std::int64_t i = 0; i < state.iterations(); ++i) {
+                        for (auto& ground : grounds) {
+                            ground->moveAnts();
+                            ground->assignWork();
+                            ground->handleAntInteractions(static_cast<int>(i));
+                        }
+                    }
+                };
+            } });
+
+            cases.push_back({ case_name("Replicas/batch", { size, ants, REPLICAS }), [ants, make_replicas]() -> BenchRunner {
+                auto grounds = make_replicas();
+                std::vector<const Ground*> replicas;
+                for (auto& ground : grounds) {
+                    replicas.push_back(ground.get());
+                }
+                auto batch = std::make_shared<ReplicaBatch>(replicas);
+                return [batch, ants](BenchState& state) {
+                    state.setItemsPerIteration(static_cast<double>(ants) * REPLICAS);
+                    for (std::int64_t i = 0; i < state.iterations(); ++i) {
+                        batch->step();
+                    }
+                };
+            } });
+        }
+    }
+    return cases;
+}
+
+/** @brief Double the iteration count until a run lasts at least minTime */
+BenchResult run_case(const BenchCase& bench, double minTime) {
+    BenchRunner runner = bench.setup();
+    std::int64_t iterations = 1;
+    while (true) {
+        BenchState state(iterations);
+        state.start();
+        runner(state);
+        state.stop();
+        double seconds = state.seconds();
+        if (seconds >= minTime || iterations >= (std::int64_t(1) << 40)) {
+            double perIteration = seconds / iterations;
+            double itemsPerSecond = (seconds > 0.0) ? state.items() * iterations / seconds : 0.0;
+            return { bench.name, iterations, perIteration * 1e9, itemsPerSecond };
+        }
+        // Jump close to the target, but at most 10x per round.
+        double scale = (seconds > 0.0) ? 1.4 * minTime / seconds : 10.0;
+        scale = std::min(10.0, std::max(2.0, scale));
+        iterations = static_cast<std::int64_t>(iterations * scale);
+    }
+}
+
+std::string json_escape(const std::string& text) {
+    std::string out;
+    for (char c : text) {
+        if (c == '"' || c == '\\') {
+            out += '\\';
+        }
+        out += c;
+    }
+    return out;
+}
+
+void print_header(const BenchOptions& options) {
+    if (options.format == "csv") {
+        std::cout << "name,iterations,ns_per_iteration,items_per_second" << std::endl;
+    }
+    else if (options.format == "json") {
+        std::cout << "{\n  \"context\": {\"min_time\": " << options.minTime
+#ifdef _OPENMP
+                  << ", \"openmp\": true"
+#else
+                  << ", \"openmp\": false"
+#endif
+                  << "},\n  \"benchmarks\": [";
+    }
+    else {
+        std::cout << std::left << std::setw(48) << "Benchmark" << std::right
+                  << std::setw(16) << "ns/iter" << std::setw(14) << "iterations"
+                  << std::setw(16) << "items/s" << std::endl;
+    }
+}
+
+void print_result(const BenchOptions& options, const BenchResult& result, bool first) {
+    if (options.format == "csv") {
+        std::cout << result.name << "," << result.iterations << ","
+                  << std::setprecision(10) << result.nsPerIteration << "," << result.itemsPerSecond << std::endl;
+    }
+    else if (options.format == "json") {
+        std::cout << (first ? "\n" : ",\n") << std::setprecision(10)
+                  << "    {\"name\": \"" << json_escape(result.name) << "\""
+                  << ", \"iterations\": " << result.iterations
+                  << ", \"ns_per_iteration\": " << result.nsPerIteration
+                  << ", \"items_per_second\": " << result.itemsPerSecond << "}" << std::flush;
+    }
+    else {
+        std::cout << std::left << std::setw(48) << result.name << std::right << std::fixed
+                  << std::setprecision(1) << std::setw(16) << result.nsPerIteration
+                  << std::setw(14) << result.iterations
+                  << std::setprecision(0) << std::setw(16) << result.itemsPerSecond
+                  << std::defaultfloat << std::endl;
+    }
+}
+
+void print_footer(const BenchOptions& options) {
+    if (options.format == "json") {
+        std::cout << "\n  ]\n}" << std::endl;
+    }
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    BenchOptions options;
+    try {
+        options = parse_options(argc, argv);
+    }
+    catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+
+    print_header(options);
+    bool first = true;
+    for (const auto& bench : build_cases(options)) {
+        if (!options.filter.empty() && bench.name.find(options.filter) == std::string::npos) {
+            continue;
+        }
+        print_result(options, run_case(bench, options.minTime), first);
+        first = false;
+    }
+    print_footer(options);
+    return 0;
+}
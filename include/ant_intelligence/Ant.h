@@ -14,6 +14,12 @@
 #include <sstream>  // For memory serialization
 #include <string>   // For std::string
 #include <deque>    // OPTIMIZATION: Added for std::deque
+#include "ant_intelligence/MemoryRing.h"
+#include "ant_intelligence/Utils.h" // pair_hash
+#include "ant_intelligence/Config.h"
+#include "ant_intelligence/DirectionSampler.h"
+#include "ant_intelligence/Rng.h"
+#include "ant_intelligence/VisitBitmap.h"
 
  // Forward declarations
 class Object;
@@ -21,16 +27,6 @@ class Food;
 class Waste;
 class Egg;
 
-
-// Custom hash function for std::pair<int, int>
-struct pair_hash {
-    template <class T1, class T2>
-    std::size_t operator() (const std::pair<T1, T2>& pair) const {
-        // A simple combination of hashes for pair
-        return std::hash<T1>()(pair.first) ^ std::hash<T2>()(pair.second);
-    }
-};
-
 /**
  * @class Ant
  * @brief Agent that moves around the grid and interacts with objects.
@@ -43,37 +39,58 @@ public:
      * @param position     Initial position on the grid
      * @param width        Grid width
      * @param length       Grid length
-     * @param recordPath   Whether to record visited positions
+     * @param recordPath   Whether to record visited positions (off by default)
      * @param memorySize   Capacity of the internal memory
+     * @param initialDirection  Starting movement direction (0..7)
      */
     Ant(std::pair<int, int> position = { -1, -1 },
         int width = 0,
         int length = 0,
         bool recordPath = false,
-        int memorySize = 20);
+        int memorySize = 20,
+        int initialDirection = 0);
 
     /**
      * @brief Move the ant according to the probability distribution.
      *
-     * @param possiblePositions  Map of valid neighbor cells for every grid cell.
-     * @param probabilities      Probability for choosing each of the 8 directions.
-     * @param gen                The random number generator to use (for thread safety).
+     * The ant stays on its width x length grid; it does not move if it is
+     * currently off the grid.
+     *
+     * @param sampler  Precomputed direction tables for the 8 directions.
+     * @param gen      Random stream for this ant and step.
      */
     void move(
-        const std::unordered_map<std::pair<int, int>, std::vector<std::pair<int, int>>, pair_hash>& possiblePositions,
-        const std::vector<double>& probabilities,
-        std::mt19937& gen);
+        const DirectionSampler& sampler,
+        CounterRng& gen);
+
+    /**
+     * @brief Movement rule shared by Ant and Ground's colony.
+     *
+     * Interior cells sample a direction with inertia; boundary cells pick a
+     * uniformly random valid neighbour. Updates position and prevDirection.
+     */
+    static void moveStep(
+        std::pair<int, int>& position,
+        int& prevDirection,
+        int width,
+        int length,
+        const DirectionSampler& sampler,
+        CounterRng& gen);
 
     /** @name Getters */
     ///@{
     /** @brief Current position of the ant */
     std::pair<int, int> getPosition() const;
-    /** @brief Object the ant is currently carrying */
-    std::shared_ptr<Object> getLoad() const;
-    /** @brief Collection of visited grid positions */
-    const std::unordered_set<std::pair<int, int>, pair_hash>& getVisitedPositions() const;
-    /** @brief Sequence of recently seen objects */
-    const std::deque<int>& getMemory() const; // OPTIMIZATION: Changed return type to const std::deque<int>&
+    /** @brief Type of the object the ant is currently carrying */
+    AIConfig::ObjectType getLoad() const;
+    /** @brief Whether the ant is carrying anything */
+    bool hasLoad() const { return load != AIConfig::ObjectType::None; }
+    /** @brief Cells entered while path recording was on */
+    const VisitBitmap& getVisitedPositions() const;
+    /** @brief Sequence of recently seen objects, oldest first */
+    std::deque<int> getMemory() const;
+    /** @brief How many remembered objects are of the given type (O(1)) */
+    int countMemory(AIConfig::ObjectType type) const { return memory.count(type); }
     /** @brief Steps remaining before the ant can interact again */
     int getInteractionCooldown() const;
     /** @brief Previous movement direction */
@@ -82,9 +99,11 @@ public:
 
     /** @name Setters */
     ///@{
-    /** @brief Set the object carried by the ant */
-    void setLoad(std::shared_ptr<Object> newLoad);
-    /** @brief Enable or disable path recording */
+    /** @brief Set the type of object carried by the ant */
+    void setLoad(AIConfig::ObjectType newLoad);
+    /** @brief Set the carried object from an Object instance (API adapter) */
+    void setLoad(const std::shared_ptr<Object>& newLoad);
+    /** @brief Enable or disable path recording; the first enable allocates the bitmap */
     void setRecordPath(bool record);
     /** @brief Adjust the interaction cooldown */
     void setInteractionCooldown(int cooldown);
@@ -101,18 +120,24 @@ public:
 
     /**
      * @brief Update memory with information about a seen object.
+     *
+     * ObjectType::None is ignored.
      */
-    void updateMemory(std::shared_ptr<Object> seenObject);
+    void updateMemory(AIConfig::ObjectType seenType);
+    /** @brief Update memory from an Object instance (API adapter) */
+    void updateMemory(const std::shared_ptr<Object>& seenObject);
 
     /**
      * @brief Pick a direction using weighted probabilities.
      *
      * The distribution is rotated based on the previous direction to introduce
-     * inertia in movement.
+     * inertia in movement. This builds the distribution on every call; the
+     * simulation samples from a precomputed DirectionSampler instead.
      */
     int getRandomWeightedDirection(
         const std::vector<double>& probabilities,
-        int prevDirection);
+        int prevDirection,
+        CounterRng& gen);
 
 
 private:
@@ -126,37 +151,27 @@ private:
     int width;
     int length;
 
-    // Movement dictionary and inverse
-    std::unordered_map<int, std::pair<int, int>> movementDict;
-    std::unordered_map<std::pair<int, int>, int, pair_hash> invMovementDict;
-
     // Tracks the previous direction (0..7)
     int prevDirection;
 
-    // The object this ant is carrying
-    std::shared_ptr<Object> load;
+    // OPTIMIZATION: The carried object is a plain type tag, so copying an ant
+    // or its load involves no RTTI and no atomic refcounting.
+    AIConfig::ObjectType load;
 
-    // OPTIMIZATION: Switched from std::vector to std::deque for efficient FIFO memory.
+    // OPTIMIZATION: Fixed-capacity ring with running per-type counts, so the
+    // similarity check needs no scan.
     // Memory: stores information about objects encountered
     // e.g. 1 for Food, 2 for Waste, 3 for Egg
-    std::deque<int> memory;
+    MemoryRing memory;
 
     // Whether we record visited positions
     bool recordPath;
 
-    // Set of visited positions (if recordPath == true)
-    std::unordered_set<std::pair<int, int>, pair_hash> visitedPositions;
+    // OPTIMIZATION: Visited cells are one bit each in a bitmap allocated
+    // only when recording, instead of a hash set of positions.
+    VisitBitmap visitedPositions;
 
     // Interaction cooldown: steps remaining until ant can interact again
     int interactionCooldown;
 
-    /** @name Helper functions */
-    ///@{
-    /** @brief Initialise the movement dictionary */
-    void updateMovementDict();
-    /** @brief Pick a random direction in range [0,7] */
-    int getRandomDirection();
-    ///@}
-
-
 };
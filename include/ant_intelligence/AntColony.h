@@ -0,0 +1,153 @@
+#pragma once
+
+/**
+ * @file AntColony.h
+ * @brief Structure-of-arrays storage for every ant on a Ground.
+ */
+
+#include "ant_intelligence/Config.h"
+#include "ant_intelligence/MemoryRing.h"
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <istream>
+#include <ostream>
+#include <vector>
+
+/**
+ * @class AntColony
+ * @brief Contiguous per-field arrays holding the state of a population of ants.
+ *
+ * Ground's per-ant loops walk these arrays linearly instead of chasing the
+ * heap blocks of individual Ant objects. Each ant's memory is a fixed-capacity
+ * ring buffer of ObjectType bytes stored in one shared array, memoryStride()
+ * bytes per ant.
+ */
+class AntColony {
+public:
+    /** @brief Number of ants */
+    std::size_t size() const { return xs.size(); }
+    bool empty() const { return xs.empty(); }
+    /** @brief Pre-allocate room for a number of ants */
+    void reserve(std::size_t count);
+
+    /**
+     * @brief Append an ant and return its index
+     *
+     * @param x              Initial column
+     * @param y              Initial row
+     * @param prevDirection  Initial movement direction (0..7)
+     * @param memorySize     Capacity of the ant's memory ring
+     */
+    std::size_t add(int x, int y, int prevDirection, int memorySize);
+
+    /** @name Per-ant state */
+    ///@{
+    /** @brief Permanent id of the ant at index i; its index at creation, kept through permute() */
+    std::uint32_t getId(std::size_t i) const { return ids[i]; }
+    /** @brief All ids in index order */
+    const std::uint32_t* idData() const { return ids.data(); }
+    /** @brief Give an ant the id it has in a larger population this colony is part of */
+    void setId(std::size_t i, std::uint32_t id) { ids[i] = id; }
+    int getX(std::size_t i) const { return xs[i]; }
+    int getY(std::size_t i) const { return ys[i]; }
+    void setPosition(std::size_t i, int x, int y) { xs[i] = x; ys[i] = y; }
+    int getPrevDirection(std::size_t i) const { return prevDirections[i]; }
+    void setPrevDirection(std::size_t i, int direction) { prevDirections[i] = static_cast<std::uint8_t>(direction); }
+    AIConfig::ObjectType getLoad(std::size_t i) const { return static_cast<AIConfig::ObjectType>(loads[i]); }
+    void setLoad(std::size_t i, AIConfig::ObjectType type) { loads[i] = static_cast<std::uint8_t>(type); }
+    int getCooldown(std::size_t i) const { return cooldowns[i]; }
+    void setCooldown(std::size_t i, int steps) { cooldowns[i] = steps; }
+    ///@}
+
+    /** @name Memory ring */
+    ///@{
+    /** @brief Record a seen object type; ObjectType::None is ignored */
+    void updateMemory(std::size_t i, AIConfig::ObjectType type) {
+        MemoryRing::push(memory.data() + i * stride, memoryHead[i], memoryCount[i], memoryCapacity[i],
+            &memoryTypeCounts[i * AIConfig::NUM_OBJECT_TYPES], static_cast<std::uint8_t>(type));
+    }
+    /**
+     * @brief updateMemory for colonies whose fixedCapacity() is Capacity
+     *
+     * The ring offset and wrap-around use the constant, so the push compiles
+     * to straight-line code.
+     */
+    template <int Capacity>
+    void updateMemoryFixed(std::size_t i, AIConfig::ObjectType type) {
+        MemoryRing::push(memory.data() + i * Capacity, memoryHead[i], memoryCount[i], Capacity,
+            &memoryTypeCounts[i * AIConfig::NUM_OBJECT_TYPES], static_cast<std::uint8_t>(type));
+    }
+    /** @brief Number of remembered objects of a type (O(1)) */
+    int countMemory(std::size_t i, AIConfig::ObjectType type) const {
+        return memoryTypeCounts[i * AIConfig::NUM_OBJECT_TYPES + static_cast<int>(type)];
+    }
+    /** @brief Remembered types, oldest first */
+    std::deque<int> getMemory(std::size_t i) const;
+    /** @brief Capacity of an ant's memory */
+    int getMemoryCapacity(std::size_t i) const { return memoryCapacity[i]; }
+    /** @brief Bytes reserved per ant in the shared memory array */
+    int memoryStride() const { return stride; }
+    /** @brief Memory capacity shared by every ant (equal to the stride), or -1 if capacities differ */
+    int fixedCapacity() const { return uniformCapacity ? stride : -1; }
+    ///@}
+
+    /**
+     * @brief Reorder the ants so that old index order[k] becomes index k
+     *
+     * order must be a permutation of 0..size()-1. Ids move with their ants.
+     */
+    void permute(const std::vector<std::uint32_t>& order);
+
+    /** @brief Remove every ant whose flag is set, keeping the others in order */
+    void remove(const std::vector<bool>& gone);
+
+    /** @brief Write one ant (id, state and memory ring) in little-endian binary form */
+    void saveAnt(std::size_t i, std::ostream& out) const;
+    /** @brief Append an ant written by saveAnt() and return its index; throws std::runtime_error on bad data */
+    std::size_t loadAnt(std::istream& in);
+
+    /** @brief Write every per-ant array in little-endian binary form */
+    void save(std::ostream& out) const;
+    /**
+     * @brief Replace the colony with one written by save(); throws std::runtime_error on bad data
+     *
+     * @param withIds  false for data written before ids were saved; ants get their index as id
+     */
+    void load(std::istream& in, bool withIds = true);
+
+private:
+    // Map the arrays to an offload device, or interleave them across replicas.
+    friend class DeviceGround;
+    friend class ReplicaBatch;
+
+    std::vector<std::uint32_t> ids;
+    std::vector<int> xs;
+    std::vector<int> ys;
+    std::vector<std::uint8_t> prevDirections;
+    std::vector<std::uint8_t> loads;
+    std::vector<int> cooldowns;
+
+    int stride = 0;
+    std::vector<std::uint8_t> memory;
+    std::vector<std::uint16_t> memoryHead;
+    std::vector<std::uint16_t> memoryCount;
+    std::vector<std::uint16_t> memoryCapacity;
+    // AIConfig::NUM_OBJECT_TYPES running counters per ant
+    std::vector<std::uint16_t> memoryTypeCounts;
+    // Whether every ant's capacity equals the stride
+    bool uniformCapacity = true;
+
+    /**
+     * @brief Rebuild the type counters of ant i from its ring
+     *
+     * Loaded counters are never trusted, since the kernels index arrays with
+     * them; the ring bytes must already be checked to be ObjectType values.
+     */
+    void recountMemory(std::size_t i);
+
+    /** @brief Keep only ants order[0], order[1], ..., in that order */
+    void select(const std::vector<std::uint32_t>& order);
+    /** @brief Grow the per-ant memory stride, keeping every ring's contents */
+    void restride(int newStride);
+};
@@ -0,0 +1,100 @@
+#pragma once
+
+/**
+ * @file BinaryIO.h
+ * @brief Little-endian encoding helpers shared by the binary file formats.
+ *
+ * Values are written byte by byte in little-endian order whatever the host,
+ * so files move freely between machines. Arrays are encoded into one buffer
+ * and written with a single call.
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <istream>
+#include <ostream>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+namespace BinaryIO {
+    /** @brief Unsigned integer with the same size as T */
+    template <typename T>
+    using Bits = typename std::conditional<sizeof(T) == 1, std::uint8_t,
+        typename std::conditional<sizeof(T) == 2, std::uint16_t,
+        typename std::conditional<sizeof(T) == 4, std::uint32_t, std::uint64_t>::type>::type>::type;
+
+    /** @brief Encode count values of T starting at values into out */
+    template <typename T>
+    void encode(const T* values, std::size_t count, char* out) {
+        static_assert(std::is_arithmetic<T>::value, "BinaryIO encodes arithmetic types only");
+        for (std::size_t i = 0; i < count; ++i) {
+            Bits<T> bits;
+            std::memcpy(&bits, &values[i], sizeof(T));
+            for (std::size_t k = 0; k < sizeof(T); ++k) {
+                out[i * sizeof(T) + k] = static_cast<char>((static_cast<std::uint64_t>(bits) >> (8 * k)) & 0xFF);
+            }
+        }
+    }
+
+    /** @brief Decode count values of T from in */
+    template <typename T>
+    void decode(const char* in, std::size_t count, T* values) {
+        static_assert(std::is_arithmetic<T>::value, "BinaryIO decodes arithmetic types only");
+        for (std::size_t i = 0; i < count; ++i) {
+            std::uint64_t bits = 0;
+            for (std::size_t k = 0; k < sizeof(T); ++k) {
+                bits |= static_cast<std::uint64_t>(static_cast<unsigned char>(in[i * sizeof(T) + k])) << (8 * k);
+            }
+            Bits<T> narrow = static_cast<Bits<T>>(bits);
+            std::memcpy(&values[i], &narrow, sizeof(T));
+        }
+    }
+
+    template <typename T>
+    void write(std::ostream& out, T value) {
+        char buffer[sizeof(T)];
+        encode(&value, 1, buffer);
+        out.write(buffer, sizeof(T));
+    }
+
+    template <typename T>
+    void writeArray(std::ostream& out, const std::vector<T>& values) {
+        std::vector<char> buffer(values.size() * sizeof(T));
+        encode(values.data(), values.size(), buffer.data());
+        out.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+    }
+
+    /** @brief Read exactly size bytes; throws std::runtime_error on a short read */
+    inline void readBytes(std::istream& in, char* data, std::size_t size) {
+        if (!in.read(data, static_cast<std::streamsize>(size))) {
+            throw std::runtime_error("Unexpected end of binary data");
+        }
+    }
+
+    template <typename T>
+    T read(std::istream& in) {
+        char buffer[sizeof(T)];
+        readBytes(in, buffer, sizeof(T));
+        T value;
+        decode(buffer, 1, &value);
+        return value;
+    }
+
+    /** @brief Read count values into values, replacing its contents */
+    template <typename T>
+    void readArray(std::istream& in, std::size_t count, std::vector<T>& values) {
+        std::vector<char> buffer(count * sizeof(T));
+        readBytes(in, buffer.data(), buffer.size());
+        values.resize(count);
+        decode(buffer.data(), count, values.data());
+    }
+
+    /** @brief Write zero bytes until the stream position is a multiple of alignment */
+    inline void pad(std::ostream& out, std::size_t written, std::size_t alignment) {
+        for (std::size_t k = (alignment - written % alignment) % alignment; k > 0; --k) {
+            out.put('\0');
+        }
+    }
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+/**
+ * @file CellIndex.h
+ * @brief Cell list mapping grid cells to the ants standing on them.
+ */
+
+#include "ant_intelligence/AntColony.h"
+#include <cstddef>
+#include <vector>
+
+/**
+ * @class CellIndex
+ * @brief Persistent per-cell linked lists of ant indices.
+ *
+ * head[cell] is the first ant on a cell and next[ant] the following one, so
+ * a rebuild only touches the cells ants occupied before and after the step:
+ * O(ants) work and no allocation once the ant count stops growing. Ants on a
+ * cell are listed in ascending index order.
+ */
+class CellIndex {
+public:
+    /** @brief Construct an empty index */
+    CellIndex(int width = 0, int length = 0);
+
+    /** @brief Re-index every ant of the colony at its current position */
+    void rebuild(const AntColony& colony);
+
+    /** @brief First ant on cell (x, y), or -1 when the cell is empty */
+    int first(int x, int y) const {
+        return (x >= 0 && x < width && y >= 0 && y < length) ? head[static_cast<std::size_t>(y) * width + x] : -1;
+    }
+    /** @brief Ant following antIndex on the same cell, or -1 */
+    int next(int antIndex) const { return nextAnt[antIndex]; }
+
+    /** @brief Number of ants on cell (x, y) */
+    int countAt(int x, int y) const;
+
+private:
+    int width;
+    int length;
+    std::vector<int> head;
+    std::vector<int> nextAnt;
+    // Cell each ant was indexed under, used to clear head on the next rebuild.
+    std::vector<int> antCell;
+};
@@ -0,0 +1,85 @@
+#pragma once
+
+/**
+ * @file ClusterTracker.h
+ * @brief Incrementally maintained statistics of same-type object clusters.
+ */
+
+#include "ant_intelligence/Config.h"
+#include "ant_intelligence/Grid.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @class ClusterTracker
+ * @brief Union-find over the grid cells tracking 8-connected same-type clusters.
+ *
+ * A drop (or the new half of a swap) only ever merges clusters, which
+ * union-find handles in near-constant time. A pick can split a cluster; the
+ * 3x3 ring around the removed cell tells whether it might, and only then is
+ * the structure flagged for an O(cells) scanline relabel on the next query.
+ *
+ * Cells map to union-find nodes through an indirection table, so a removed
+ * cell simply leaves its node behind and a later object on that cell gets a
+ * fresh one. Nodes are compacted by every rebuild.
+ */
+class ClusterTracker {
+public:
+    /** @brief Construct a tracker for a width x length grid */
+    ClusterTracker(int width = 0, int length = 0);
+
+    /** @brief Relabel every cluster of the grid from scratch */
+    void rebuild(const Grid& grid);
+
+    /**
+     * @brief Account for a single cell change
+     *
+     * Must be called after grid has been updated at (x, y).
+     *
+     * @param oldType  Type the cell held before the change
+     */
+    void update(const Grid& grid, int x, int y, AIConfig::ObjectType oldType);
+
+    /** @brief Force a rebuild on the next query (e.g. after bulk grid writes) */
+    void invalidate() { dirty = true; }
+    /** @brief Whether the next query will rebuild */
+    bool isDirty() const { return dirty; }
+
+    /** @brief Mean object count per cluster, 0 when the grid is empty */
+    double averageSize(const Grid& grid);
+    /** @brief Number of clusters */
+    std::size_t clusterCount(const Grid& grid);
+    /** @brief Number of cells holding an object */
+    std::size_t objectCount(const Grid& grid);
+    /**
+     * @brief Label of the cluster the object at (x, y) belongs to, -1 for an empty cell
+     *
+     * Labels are equal exactly for cells of the same cluster and stay valid
+     * until the tracker next changes.
+     */
+    int clusterOf(const Grid& grid, int x, int y);
+
+private:
+    int width;
+    int length;
+    bool dirty = true;
+    std::size_t objects = 0;
+    std::size_t clusters = 0;
+
+    // Union-find node of every cell in row-major order (whatever the grid's
+    // layout), -1 for empty cells.
+    std::vector<int> cellNode;
+    // Row-major copy of a tiled grid for rebuild()
+    std::vector<std::uint8_t> rowMajor;
+    std::vector<int> parent;
+    std::vector<int> clusterSize;
+
+    /** @brief Row-major id of cell (x, y) */
+    std::size_t cellId(int x, int y) const { return static_cast<std::size_t>(y) * width + x; }
+    int find(int node);
+    /** @brief Merge two nodes' sets; returns false if already joined */
+    bool unite(int a, int b);
+    /** @brief Start a singleton set for the object at a cell */
+    int makeNode(std::size_t cell);
+};
@@ -0,0 +1,111 @@
+#pragma once
+
+/**
+ * @file Communicator.h
+ * @brief Message passing between the ranks of a distributed simulation.
+ */
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+/**
+ * @class Communicator
+ * @brief Point-to-point byte messages plus the few collectives DistributedGround needs.
+ *
+ * Implementations provide send() and recv(); the collectives have portable
+ * defaults built on them and may be overridden with native ones (MPI). Every
+ * rank must call a collective in the same order. Messages between a pair of
+ * ranks arrive in the order they were sent.
+ */
+class Communicator {
+public:
+    using Buffer = std::vector<std::uint8_t>;
+
+    virtual ~Communicator() = default;
+
+    virtual int rank() const = 0;
+    virtual int size() const = 0;
+
+    /** @brief Queue a message for a rank; must not wait for the matching recv() */
+    virtual void send(int destination, const Buffer& message) = 0;
+    /** @brief Block until the next message from a rank arrives */
+    virtual void recv(int source, Buffer& message) = 0;
+
+    /**
+     * @brief Swap buffers with the ranks on either side
+     *
+     * toPrev goes to rank() - 1 and toNext to rank() + 1; from those ranks
+     * fromPrev and fromNext are received. Missing neighbours send nothing
+     * and leave their buffer empty.
+     */
+    virtual void exchangeNeighbors(const Buffer& toPrev, const Buffer& toNext, Buffer& fromPrev, Buffer& fromNext);
+    /** @brief Element-wise sum over every rank, left on every rank */
+    virtual void allreduceSum(std::vector<std::int64_t>& values);
+    /** @brief Every rank's buffer, in rank order, on root; other ranks get nothing */
+    virtual void gather(const Buffer& local, std::vector<Buffer>& all, int root = 0);
+    /** @brief Replace data on every rank with root's */
+    virtual void broadcast(Buffer& data, int root = 0);
+};
+
+/**
+ * @class SelfCommunicator
+ * @brief The single rank of an undistributed run; messages to itself are queued.
+ */
+class SelfCommunicator : public Communicator {
+public:
+    int rank() const override { return 0; }
+    int size() const override { return 1; }
+    void send(int destination, const Buffer& message) override;
+    void recv(int source, Buffer& message) override;
+
+private:
+    std::deque<Buffer> queue;
+};
+
+/**
+ * @class InProcessWorld
+ * @brief Mailboxes shared by the ranks of a run whose ranks are threads of one process.
+ *
+ * Used to run and test the distributed code paths without MPI. Each thread
+ * drives the InProcessCommunicator returned by communicator(rank).
+ */
+class InProcessWorld {
+public:
+    explicit InProcessWorld(int ranks);
+
+    int size() const { return ranks; }
+    /** @brief Communicator of one rank; owned by the world */
+    class InProcessCommunicator& communicator(int rank);
+
+private:
+    friend class InProcessCommunicator;
+
+    int ranks;
+    std::mutex mutex;
+    std::condition_variable arrived;
+    // (source, destination) -> messages in flight
+    std::map<std::pair<int, int>, std::deque<Communicator::Buffer>> mailboxes;
+    std::vector<std::unique_ptr<class InProcessCommunicator>> members;
+};
+
+/** @brief One rank of an InProcessWorld */
+class InProcessCommunicator : public Communicator {
+public:
+    InProcessCommunicator(InProcessWorld& world, int rank) : world(world), ownRank(rank) {}
+
+    int rank() const override { return ownRank; }
+    int size() const override { return world.size(); }
+    void send(int destination, const Buffer& message) override;
+    void recv(int source, Buffer& message) override;
+
+private:
+    InProcessWorld& world;
+    int ownRank;
+};
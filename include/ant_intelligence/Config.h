@@ -10,6 +10,7 @@ namespace AIConfig {
         Waste = 2,
         Egg = 3
     };
+    constexpr int NUM_OBJECT_TYPES = 4;
 
     // Enumeration for ant movement directions
     enum class Direction {
@@ -25,6 +26,52 @@ namespace AIConfig {
 
     constexpr int NUM_DIRECTIONS = 8;
 
+    // Grid offset of each Direction, shared by every ant
+    constexpr std::array<int, NUM_DIRECTIONS> DIRECTION_DX{ { 0,  1,  1,  1,  0, -1, -1, -1 } };
+    constexpr std::array<int, NUM_DIRECTIONS> DIRECTION_DY{ {-1, -1,  0,  1,  1,  1,  0, -1 } };
+
+    // Inverse of the offset tables, indexed by (dy + 1) * 3 + (dx + 1); -1 for no move
+    constexpr std::array<int, 9> OFFSET_TO_DIRECTION{ { 7, 0, 1, 6, -1, 2, 5, 4, 3 } };
+
+    /** @brief Direction of a one-cell move, or -1 if (dx, dy) is not a neighbour offset */
+    constexpr int directionFromOffset(int dx, int dy) {
+        return (dx < -1 || dx > 1 || dy < -1 || dy > 1) ? -1 : OFFSET_TO_DIRECTION[(dy + 1) * 3 + (dx + 1)];
+    }
+
+    // Cells an ant inspects around itself when picking up, dropping and
+    // meeting other ants. Movement always uses all eight directions.
+    enum class NeighborhoodType {
+        Moore = 0,    // All eight surrounding cells
+        VonNeumann    // The four orthogonal cells (N, E, S, W)
+    };
+
+    // How Ground advances its ants within one step
+    enum class StepMode {
+        Serial = 0,   // One ant after another, in index order
+        Parallel      // Multithreaded; reproducible for any thread count
+    };
+
+    // Storage order of the cells of a Grid
+    enum class GridLayout {
+        RowMajor = 0, // Cell (x, y) at y * width + x
+        Tiled         // GRID_TILE_SIZE square blocks, row-major inside and between blocks
+    };
+
+    // log2 of the side length of the blocks of GridLayout::Tiled
+    constexpr int GRID_TILE_SHIFT = 6;
+    constexpr int GRID_TILE_SIZE = 1 << GRID_TILE_SHIFT;
+
+    // Side length of the tiles used to schedule pick/drop work in parallel.
+    // Must be at least 2 so same-coloured tiles never share a neighbourhood.
+    constexpr int PARALLEL_TILE_SIZE = 16;
+
+    // Cells from which Ground::addObject fills rows on several threads
+    constexpr int PARALLEL_FILL_MIN_CELLS = 1 << 16;
+
+    // Ants whose random streams are derived together before the ant loop
+    // consumes them; small enough for the states to stay in L1.
+    constexpr int RNG_BLOCK_SIZE = 256;
+
     // Default simulation parameters
     constexpr int DEFAULT_GROUND_WIDTH = 50;
     constexpr int DEFAULT_GROUND_LENGTH = 50;
@@ -32,6 +79,10 @@ namespace AIConfig {
     constexpr int DEFAULT_NUM_EXPERIMENTS = 1;
     constexpr int DEFAULT_ITERATIONS = 30001; // Reduced for quicker testing
     constexpr int DEFAULT_MEMORY_SIZE = 20;
+    // Iterations between recorded cluster-size samples
+    constexpr int DEFAULT_SAMPLE_INTERVAL = 10000;
+    // Default seed for the counter-based random number generator
+    constexpr unsigned long long DEFAULT_SEED = 20240601ULL;
 
     // Default sweep for similarity threshold
     constexpr int DEFAULT_THRESHOLD_START = 10;
@@ -51,4 +102,34 @@ namespace AIConfig {
     constexpr std::array<double, 2> DEFAULT_PROB_RELU{ {0.3, 0.7} };
     // --- NEW: Default for video generation ---
     constexpr bool DEFAULT_VIDEO_ENABLED = true;
+    // Show frames in a window while encoding (false for headless servers)
+    constexpr bool DEFAULT_VIDEO_WINDOW = true;
+    // Pixels per grid cell in rendered frames
+    constexpr int DEFAULT_VIDEO_SCALE = 6;
+    // Frame rate of the encoded video
+    constexpr int DEFAULT_VIDEO_FPS = 120;
+    // Iterations per rendered frame (1 renders every iteration)
+    constexpr int DEFAULT_VIDEO_STRIDE = 1;
+    // Frames that may wait for the encoder thread before the simulation blocks
+    constexpr int DEFAULT_VIDEO_QUEUE_DEPTH = 8;
+    // Metrics events that may wait for the stream writer before new ones are dropped
+    constexpr int DEFAULT_METRICS_QUEUE_DEPTH = 65536;
+    // Milliseconds between writes of the metrics stream
+    constexpr int DEFAULT_METRICS_FLUSH_MS = 100;
+    // Default for multithreading inside a single experiment
+    constexpr bool DEFAULT_PARALLEL_STEP = false;
+    // Default for advancing with Ground::step() instead of the separate phases
+    constexpr bool DEFAULT_FUSED_STEP = false;
+    // Default for counting the cells ants visit
+    constexpr bool DEFAULT_RECORD_PATH = false;
+    // Default neighbourhood for pick/drop densities and interactions
+    constexpr NeighborhoodType DEFAULT_NEIGHBORHOOD = NeighborhoodType::Moore;
+    // Default cell storage order
+    constexpr GridLayout DEFAULT_GRID_LAYOUT = GridLayout::RowMajor;
+    // Default steps between re-sorts of the ants by cell (0 never sorts)
+    constexpr int DEFAULT_ANT_SORT_INTERVAL = 0;
+    // Sample intervals the cluster metric must stay flat over before a run stops
+    constexpr int DEFAULT_CONVERGENCE_WINDOW = 10;
+    // Relative spread of the cluster metric that counts as flat (0 never stops early)
+    constexpr double DEFAULT_CONVERGENCE_TOLERANCE = 0.0;
 }
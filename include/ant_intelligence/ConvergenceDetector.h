@@ -0,0 +1,46 @@
+#pragma once
+
+/**
+ * @file ConvergenceDetector.h
+ * @brief Plateau test on a sampled run metric.
+ */
+
+#include <cstddef>
+#include <deque>
+
+/**
+ * @class ConvergenceDetector
+ * @brief Decides that a metric has settled once a sliding window of samples stays flat.
+ *
+ * The window holds the last window + 1 samples, so it spans window sample
+ * intervals. The metric has converged when the window is full and its
+ * spread, max - min, is at most tolerance times the mean absolute value of
+ * the window. Using the spread instead of the change between the ends also
+ * rejects windows that oscillate around a level. Once converged, the
+ * detector stays converged.
+ */
+class ConvergenceDetector {
+public:
+    /**
+     * @brief Detector over window sample intervals
+     *
+     * A tolerance of 0 or less disables detection: add() never reports
+     * convergence. Throws std::invalid_argument if window is 0 while
+     * detection is enabled.
+     */
+    ConvergenceDetector(std::size_t window, double tolerance);
+
+    /** @brief Whether detection is enabled */
+    bool enabled() const { return tolerance > 0.0; }
+
+    /** @brief Add the next sample; returns whether the metric has converged */
+    bool add(double value);
+    /** @brief Whether a previous add() reported convergence */
+    bool converged() const { return settled; }
+
+private:
+    std::size_t window;
+    double tolerance;
+    std::deque<double> samples;
+    bool settled = false;
+};
@@ -0,0 +1,126 @@
+#pragma once
+
+/**
+ * @file DeviceGround.h
+ * @brief A Ground whose state lives on an OpenMP offload device.
+ */
+
+#include "ant_intelligence/AntColony.h"
+#include "ant_intelligence/Config.h"
+#include "ant_intelligence/FramePipeline.h"
+#include "ant_intelligence/Ground.h"
+#include "ant_intelligence/Grid.h"
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <vector>
+
+/**
+ * @class DeviceGround
+ * @brief Ground engine that steps every ant in data-parallel device kernels.
+ *
+ * The type grid and the ant arrays are mapped to the default OpenMP target
+ * device once, on construction, and stay there: moves, pick/drop,
+ * interactions and the cluster statistic all run as target kernels. Only
+ * snapshot() and saveState() copy state back to the host. Without an
+ * offload device, or with a compiler that does not offload, the kernels run
+ * on the host threads instead.
+ *
+ * Random draws are keyed exactly as on Ground, and moves match Ground step
+ * for step. The other phases resolve conflicts without relying on any
+ * processing order, so they are equally valid but differ from Ground:
+ * - Pick/drop decisions all read the grid as it was before the pass. When
+ *   several ants share a cell, the one with the lowest id may act; the
+ *   others draw their number and update their memory as if the draw failed.
+ * - Interactions read the neighbours' directions from before the pass, as on
+ *   DistributedGround, and take the matching neighbour with the lowest id.
+ *
+ * Ants are kept in id order. Neighbourhood and memory size behave as on
+ * Ground; grid layouts, ant sorting and path recording are not supported.
+ */
+class DeviceGround {
+public:
+    /**
+     * @brief Copy an initialised ground to the device
+     *
+     * Configuration, counters and the seed are taken over from initial, so a
+     * ground can be filled or loaded on the host and continued here. Throws
+     * std::invalid_argument unless initial has AIConfig::NUM_DIRECTIONS
+     * movement probabilities.
+     */
+    explicit DeviceGround(const Ground& initial);
+    /** @brief Releases the device copy */
+    ~DeviceGround();
+
+    DeviceGround(const DeviceGround&) = delete;
+    DeviceGround& operator=(const DeviceGround&) = delete;
+
+    /** @brief Whether an offload device is present; if not, kernels run on the host */
+    static bool deviceAvailable();
+
+    /** @brief Move all ants one step */
+    void moveAnts();
+    /** @brief Propose every pick/drop against the pre-pass grid, then commit the winners */
+    void assignWork();
+    /** @brief Check neighbouring ants and count cooldowns down */
+    void handleAntInteractions(int currentIteration);
+    /** @brief moveAnts(), assignWork() and handleAntInteractions() in that order */
+    void step();
+
+    /** @brief Average size of 8-connected same-type object clusters, labelled on the device */
+    double averageClusterSize();
+    /** @brief Number of interactions detected so far */
+    int getInteractionCount() const { return static_cast<int>(interactions); }
+
+    int getWidth() const { return width; }
+    int getLength() const { return length; }
+    std::size_t antCount() const { return colony.size(); }
+
+    /** @brief Copy the type grid and ant positions back for rendering */
+    void snapshot(FrameSnapshot& frame);
+    /** @brief Copy everything back and write it in Ground::saveState format */
+    void saveState(std::ostream& out);
+
+private:
+    int width;
+    int length;
+    // Host mirrors of the device arrays; only up to date after a download.
+    Grid grid;
+    AntColony colony;
+
+    std::vector<double> acceptance;
+    std::vector<int> alias;
+    Ground::DensityRamp densityRamp;
+    int similarityThreshold;
+    int cooldownDuration;
+    AIConfig::NeighborhoodType neighborhood;
+    std::uint64_t lanes;
+
+    std::uint64_t seed;
+    std::uint64_t objectFills;
+    std::uint64_t moveSteps;
+    std::uint64_t workSteps;
+    std::int64_t interactions;
+
+    // Ants per cell as linked lists (cellHead per cell, antNext per ant),
+    // rebuilt after every move.
+    std::vector<int> cellHead;
+    std::vector<int> antNext;
+    // Pick/drop proposals: type to write into the ant's cell, or NO_WRITE.
+    std::vector<std::uint8_t> proposals;
+    // Directions at the start of the interaction pass.
+    std::vector<std::uint8_t> directionSnapshot;
+    // Cluster labels, double-buffered.
+    std::vector<int> labels;
+    std::vector<int> nextLabels;
+
+    /** @brief Call apply(data, count) for every array whose contents live on the device */
+    template <typename F>
+    void forEachState(F&& apply);
+    /** @brief Call apply(data, count) for the device-only working arrays */
+    template <typename F>
+    void forEachScratch(F&& apply);
+
+    /** @brief Link every ant into the list of its cell */
+    void indexCells();
+};
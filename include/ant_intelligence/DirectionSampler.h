@@ -0,0 +1,64 @@
+#pragma once
+
+/**
+ * @file DirectionSampler.h
+ * @brief Precomputed alias tables for inertia-weighted direction sampling.
+ */
+
+#include "ant_intelligence/Rng.h"
+#include <vector>
+
+/**
+ * @class DirectionSampler
+ * @brief O(1), allocation-free sampling of the next movement direction.
+ *
+ * The movement probabilities are given relative to the previous direction:
+ * probabilities[k] is the chance of turning k steps clockwise. For every
+ * previous direction the rotated distribution is turned into a Walker/Vose
+ * alias table once, so a draw costs one uniform index and one uniform coin.
+ */
+class DirectionSampler {
+public:
+    /** @brief Construct an empty sampler (every draw returns 0) */
+    DirectionSampler() = default;
+
+    /**
+     * @brief Build the alias tables
+     *
+     * @param probabilities  Relative weight of turning k steps away from the
+     *                       previous direction. Need not be normalised.
+     */
+    explicit DirectionSampler(const std::vector<double>& probabilities);
+
+    /** @brief Number of directions covered by the tables */
+    int size() const { return numDirections; }
+    /** @brief Whether the sampler has no directions */
+    bool empty() const { return numDirections == 0; }
+
+    /**
+     * @brief Draw the next direction given the previous one.
+     *
+     * Equivalent in distribution to a std::discrete_distribution over the
+     * probabilities rotated right by prevDirection.
+     */
+    int sample(int prevDirection, CounterRng& gen) const;
+
+    /** @brief Exact probability of moving in newDirection after prevDirection */
+    double probability(int prevDirection, int newDirection) const;
+
+    /** @brief Row-major [prevDirection][column] acceptance thresholds, size() * size() entries */
+    const double* acceptanceTable() const { return acceptance.data(); }
+    /** @brief Row-major [prevDirection][column] alias directions, size() * size() entries */
+    const int* aliasTable() const { return alias.data(); }
+
+private:
+    int numDirections = 0;
+    // Row-major [prevDirection][column] tables.
+    std::vector<double> acceptance;
+    std::vector<int> alias;
+    // Normalised, unrotated probabilities.
+    std::vector<double> weights;
+
+    /** @brief Fill one alias table row for a normalised distribution */
+    void buildTable(int row, const std::vector<double>& distribution);
+};
@@ -0,0 +1,169 @@
+#pragma once
+
+/**
+ * @file DistributedGround.h
+ * @brief A Ground split into row slabs, one per rank of a Communicator.
+ */
+
+#include "ant_intelligence/AntColony.h"
+#include "ant_intelligence/ClusterTracker.h"
+#include "ant_intelligence/Communicator.h"
+#include "ant_intelligence/Config.h"
+#include "ant_intelligence/DirectionSampler.h"
+#include "ant_intelligence/Ground.h"
+#include "ant_intelligence/Grid.h"
+#include "ant_intelligence/Rng.h"
+#include <array>
+#include <cstdint>
+#include <ostream>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+/**
+ * @class DistributedGround
+ * @brief Ground whose cells and ants are partitioned over the ranks of a Communicator.
+ *
+ * Every rank owns a slab of whole rows, a multiple of PARALLEL_TILE_SIZE
+ * high (except the last), and stores it with one halo row above and below
+ * that mirrors the neighbouring slabs. Ants live on the rank that owns their
+ * cell and migrate after each move.
+ *
+ * Random draws are keyed exactly as on Ground, so a run does not depend on
+ * the number of ranks. Object placement, ant placement, movement and
+ * pick/drop reproduce a Ground in StepMode::Parallel step for step: work
+ * uses the same checkerboard tile schedule, and since the slabs are
+ * tile-aligned only the halo rows have to be refreshed between colours.
+ * Interactions are resolved against the ants' state at the start of the
+ * pass rather than ant by ant, which makes every ant's outcome local; they
+ * are equally valid but differ from Ground's serial pass.
+ *
+ * Methods marked collective must be called by every rank, in the same
+ * order. Neighbourhood and memory size behave as on Ground; grid layouts,
+ * ant sorting and path recording are not supported.
+ */
+class DistributedGround {
+public:
+    /**
+     * @brief Construct this rank's part of a width x length ground
+     *
+     * Parameters are those of Ground and must be equal on every rank.
+     * Throws std::invalid_argument if there are more ranks than tile rows.
+     */
+    DistributedGround(Communicator& comm,
+        int width,
+        int length,
+        const std::vector<double>& probabilities,
+        const std::vector<double>& probRelu,
+        int similarityThreshold,
+        int interactionCooldown = AIConfig::DEFAULT_INTERACTION_COOLDOWN,
+        std::uint64_t seed = AIConfig::DEFAULT_SEED);
+
+    /** @brief Rows [first, second) owned by a rank of a ranks-way split */
+    static std::pair<int, int> slabRows(int length, int ranks, int rank);
+
+    /** @brief Create the next ant at the position Ground::addAnt would; kept only by its owner */
+    void addAnt(int memorySize = 20);
+    /** @brief Fill the ground with objects according to the type distribution, as Ground::addObject */
+    void addObject(const std::unordered_map<AIConfig::ObjectType, double>& typeDict);
+
+    /** @brief Move all ants one step and migrate those leaving the slab (collective) */
+    void moveAnts();
+    /** @brief Pick up and drop objects with the checkerboard tile schedule (collective) */
+    void assignWork();
+    /** @brief Check neighbouring ants, including those across slab edges, and count cooldowns down (collective) */
+    void handleAntInteractions(int currentIteration);
+    /** @brief moveAnts(), assignWork() and handleAntInteractions() in that order (collective) */
+    void step();
+
+    /** @brief Average size of 8-connected same-type clusters over the whole ground (collective) */
+    double averageClusterSize();
+    /** @brief Interactions detected on every rank so far (collective) */
+    int getInteractionCount();
+
+    /** @brief Select the cells inspected for pick/drop densities and interactions */
+    void setNeighborhood(AIConfig::NeighborhoodType type);
+    AIConfig::NeighborhoodType getNeighborhood() const { return neighborhood; }
+
+    /**
+     * @brief Write the whole ground in Ground::saveState format on root (collective)
+     *
+     * Other ranks write nothing. Ants are numbered by id, so loading the
+     * state into a Ground continues the run there. Root briefly holds the
+     * complete state.
+     */
+    void gatherState(std::ostream& out, int root = 0);
+
+    /** @name This rank's part */
+    ///@{
+    int getWidth() const { return width; }
+    int getLength() const { return length; }
+    int firstRow() const { return rowBegin; }
+    int endRow() const { return rowEnd; }
+    /** @brief Object type at (x, y), which must be an owned or halo row */
+    AIConfig::ObjectType getObjectType(int x, int y) const { return grid.get(x, localRow(y)); }
+    /** @brief Ants on the owned rows, in id order */
+    const AntColony& getColony() const { return colony; }
+    /** @brief Ants on every rank */
+    std::size_t globalAntCount() const { return totalAnts; }
+    ///@}
+
+private:
+    Communicator& comm;
+    int width;
+    int length;
+    // Owned global rows [rowBegin, rowEnd), stored from local row 1 on.
+    int rowBegin;
+    int rowEnd;
+    Grid grid;
+    AntColony colony;
+    std::size_t totalAnts = 0;
+
+    DirectionSampler directionSampler;
+    Ground::DensityRamp densityRamp;
+    int similarityThreshold;
+    int cooldownDuration;
+    AIConfig::NeighborhoodType neighborhood = AIConfig::DEFAULT_NEIGHBORHOOD;
+    std::uint64_t lanes;
+    std::int64_t interactions = 0;
+
+    std::uint64_t seed;
+    std::uint64_t objectFills = 0;
+    std::uint64_t moveSteps = 0;
+    std::uint64_t workSteps = 0;
+    CounterRngBlock moveRng;
+    CounterRngBlock workRng;
+
+    // Tile schedule of the owned rows: local tile indices of each checkerboard
+    // colour and the ants of each tile in id order.
+    int tilesX = 0;
+    int firstTileRow = 0;
+    std::vector<std::vector<int>> tilesByColor;
+    std::vector<int> tileStart;
+    std::vector<int> tileAnts;
+
+    // Interaction pass: owned ants followed by the neighbours' edge-row ants,
+    // with their pre-pass direction and memory counts, bucketed by local cell.
+    std::vector<std::uint8_t> candidateDirection;
+    std::vector<std::uint16_t> candidateCounts;
+    std::vector<int> candidateCell;
+    std::vector<int> cellStart;
+    std::vector<int> cellAnts;
+
+    ClusterTracker clusterTracker;
+    Grid ownedRows;
+
+    /** @brief Local grid row of a global row */
+    int localRow(int y) const { return y - rowBegin + 1; }
+    bool hasPrev() const { return comm.rank() > 0; }
+    bool hasNext() const { return comm.rank() + 1 < comm.size(); }
+
+    /** @brief Send the owned edge rows to the neighbours and receive their halo rows */
+    void exchangeHalo();
+    /** @brief Hand ants that left the owned rows to the neighbouring rank */
+    void migrateAnts();
+    /** @brief Interaction check and cooldown countdown of every owned ant */
+    void interactAnts();
+    /** @brief Pick/drop decision of one ant; its workRng state must be filled */
+    void workAnt(std::size_t i);
+};
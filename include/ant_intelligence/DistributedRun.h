@@ -0,0 +1,49 @@
+#pragma once
+
+/**
+ * @file DistributedRun.h
+ * @brief Step and sample one experiment on a DistributedGround.
+ */
+
+#include "ant_intelligence/ConvergenceDetector.h"
+#include "ant_intelligence/DistributedGround.h"
+#include "ant_intelligence/MetricsStream.h"
+#include "ant_intelligence/ResultsWriter.h"
+#include <ostream>
+#include <vector>
+
+/**
+ * @namespace DistributedRun
+ * @brief The iteration loop of a run split over every rank of a Communicator.
+ *
+ * The sampled metrics are collective, so whether an iteration samples them
+ * depends only on Options, which every rank must pass equal. Rank-local
+ * arguments (metrics, progress) only decide what the root does with the
+ * values.
+ */
+namespace DistributedRun {
+    /** @brief Settings of a run; must be equal on every rank */
+    struct Options {
+        int iterations = 0;
+        /** @brief Iterations between sampled rows */
+        int sampleInterval = 1;
+        /** @brief Iterations between progress lines, or 0 for none */
+        int reportInterval = 0;
+        /** @brief Use DistributedGround::step() instead of the three phases */
+        bool fusedStep = false;
+        /** @brief Window and tolerance of the ConvergenceDetector that stops the run */
+        int convergeWindow = 1;
+        double convergeTolerance = 0.0;
+    };
+
+    /**
+     * @brief Run ground for options.iterations iterations, or until it converges (collective)
+     *
+     * @param tag       Cooldown, threshold and run of the sampled rows
+     * @param metrics   Stream the root publishes samples and the run end to, or null
+     * @param progress  Stream the root prints progress lines to, or null
+     * @return The sampled rows, tagged with the converged iteration, on rank 0; empty elsewhere
+     */
+    std::vector<ResultRow> run(DistributedGround& ground, Communicator& comm, const ResultRow& tag,
+        const Options& options, MetricsStream* metrics, std::ostream* progress);
+}
@@ -0,0 +1,100 @@
+#pragma once
+
+/**
+ * @file FramePipeline.h
+ * @brief Off-thread rasterising and encoding of simulation frames.
+ */
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class Ground;
+
+/**
+ * @struct FrameSnapshot
+ * @brief Compact copy of what a frame shows: the type grid and ant positions.
+ */
+struct FrameSnapshot {
+    int width = 0;
+    int length = 0;
+    /** @brief Row-major ObjectType bytes, as in Grid */
+    std::vector<std::uint8_t> types;
+    std::vector<int> antX;
+    std::vector<int> antY;
+};
+
+/**
+ * @class FramePipeline
+ * @brief Bounded queue of frame snapshots drained by a worker thread.
+ *
+ * The simulation thread only copies the grid and ant positions into a free
+ * queue slot. The worker rasterises each snapshot with direct pixel writes and
+ * hands the BGR image to a sink, typically a video encoder. When the queue is
+ * full, submit() blocks, so a slow encoder throttles the simulation instead
+ * of buffering without bound. Frames reach the sink in submission order.
+ */
+class FramePipeline {
+public:
+    /** @brief Receives a BGR24 image of rows x cols pixels, row-major */
+    using FrameSink = std::function<void(const std::uint8_t* bgr, int rows, int cols)>;
+
+    /**
+     * @brief Start the worker thread
+     *
+     * @param scale       Pixels per grid cell
+     * @param queueDepth  Number of snapshots that may wait for the worker
+     * @param sink        Called on the worker thread for every frame
+     */
+    FramePipeline(int scale, std::size_t queueDepth, FrameSink sink);
+    /** @brief Flushes pending frames and joins the worker */
+    ~FramePipeline();
+
+    FramePipeline(const FramePipeline&) = delete;
+    FramePipeline& operator=(const FramePipeline&) = delete;
+
+    /** @brief Queue a snapshot of the ground, waiting for a free slot if needed */
+    void submit(const Ground& ground);
+    /** @brief Queue the snapshot that capture writes into a free slot, waiting for one if needed */
+    void submit(const std::function<void(FrameSnapshot&)>& capture);
+    /**
+     * @brief Flush pending frames and stop the worker
+     *
+     * Rethrows the first exception raised by the sink, if any.
+     */
+    void close();
+
+    /** @brief Number of frames handed to the sink so far */
+    std::size_t framesWritten() const;
+
+    /**
+     * @brief Draw a snapshot into a BGR24 image
+     *
+     * The image has width * scale rows and length * scale columns: grid x runs
+     * down the rows and y across the columns. Objects and ants are filled
+     * discs of radius scale / 3 on a white background.
+     */
+    static void rasterize(const FrameSnapshot& frame, int scale, std::vector<std::uint8_t>& bgr);
+
+private:
+    int scale;
+    FrameSink sink;
+    std::vector<FrameSnapshot> slots;
+    std::size_t head = 0;
+    std::size_t queued = 0;
+    std::size_t written = 0;
+    bool closing = false;
+    std::exception_ptr error;
+
+    mutable std::mutex mutex;
+    std::condition_variable notEmpty;
+    std::condition_variable notFull;
+    std::thread worker;
+
+    void run();
+};
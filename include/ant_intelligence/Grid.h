@@ -0,0 +1,132 @@
+#pragma once
+
+/**
+ * @file Grid.h
+ * @brief Dense storage of the object type held by every ground cell.
+ */
+
+#include "ant_intelligence/Config.h"
+#include "ant_intelligence/Neighborhood.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @class Grid
+ * @brief Contiguous grid of object type tags.
+ *
+ * Every cell stores a single byte holding an AIConfig::ObjectType value. In
+ * the default GridLayout::RowMajor cell (x, y) lives at index y * width + x,
+ * so neighbour scans along a row are unit-stride loads. GridLayout::Tiled
+ * stores GRID_TILE_SIZE square blocks one after another instead, so that a
+ * neighbourhood spans at most a few kilobytes however wide the grid is; the
+ * last row and column of blocks are padded. index() always gives the
+ * storage position, and the row-major import/export functions convert.
+ */
+class Grid {
+public:
+    /**
+     * @brief Construct an empty grid
+     *
+     * @param width   Number of columns (x range)
+     * @param length  Number of rows (y range)
+     * @param layout  Storage order of the cells
+     */
+    Grid(int width = 0, int length = 0, AIConfig::GridLayout layout = AIConfig::GridLayout::RowMajor);
+
+    /** @name Dimensions */
+    ///@{
+    int getWidth() const { return width; }
+    int getLength() const { return length; }
+    AIConfig::GridLayout getLayout() const { return layout; }
+    /** @brief Total number of cells */
+    std::size_t size() const { return static_cast<std::size_t>(width) * static_cast<std::size_t>(length); }
+    /** @brief Number of storage bytes, i.e. one past the largest index(); includes tile padding */
+    std::size_t storageSize() const { return cells.size(); }
+    /** @brief Whether (x, y) lies on the grid */
+    bool inBounds(int x, int y) const {
+        return x >= 0 && x < width && y >= 0 && y < length;
+    }
+    ///@}
+
+    /** @name Cell access */
+    ///@{
+    /** @brief Storage index of cell (x, y) */
+    std::size_t index(int x, int y) const {
+        if (layout == AIConfig::GridLayout::RowMajor) {
+            return static_cast<std::size_t>(y) * static_cast<std::size_t>(width) + static_cast<std::size_t>(x);
+        }
+        constexpr int mask = AIConfig::GRID_TILE_SIZE - 1;
+        const std::size_t tile = static_cast<std::size_t>(y >> AIConfig::GRID_TILE_SHIFT) * tilesX
+            + static_cast<std::size_t>(x >> AIConfig::GRID_TILE_SHIFT);
+        return (tile << (2 * AIConfig::GRID_TILE_SHIFT))
+            | static_cast<std::size_t>(((y & mask) << AIConfig::GRID_TILE_SHIFT) | (x & mask));
+    }
+    /** @brief Object type stored at (x, y) */
+    AIConfig::ObjectType get(int x, int y) const {
+        return static_cast<AIConfig::ObjectType>(cells[index(x, y)]);
+    }
+    /** @brief Store an object type at (x, y) */
+    void set(int x, int y, AIConfig::ObjectType type) {
+        cells[index(x, y)] = static_cast<std::uint8_t>(type);
+    }
+    /** @brief Whether (x, y) holds any object */
+    bool occupied(int x, int y) const {
+        return cells[index(x, y)] != static_cast<std::uint8_t>(AIConfig::ObjectType::None);
+    }
+    /** @brief Raw type bytes in storage order (see index()) */
+    const std::uint8_t* data() const { return cells.data(); }
+    std::uint8_t* data() { return cells.data(); }
+    ///@}
+
+    /**
+     * @brief Type bytes of the eight neighbours of (x, y), packed as Neighborhood::gather() does
+     *
+     * Neighbours off the grid read as Neighborhood::OFF_GRID.
+     */
+    std::uint64_t neighbors(int x, int y) const {
+        if (layout == AIConfig::GridLayout::RowMajor) {
+            return Neighborhood::gather(cells.data(), x, y, width, length);
+        }
+        constexpr int mask = AIConfig::GRID_TILE_SIZE - 1;
+        const int tx = x & mask;
+        const int ty = y & mask;
+        if (tx > 0 && tx < mask && ty > 0 && ty < mask && x < width - 1 && y < length - 1) {
+            // Inside a block the rows are GRID_TILE_SIZE bytes apart.
+            return Neighborhood::gatherInterior(cells.data() + index(x, y), AIConfig::GRID_TILE_SIZE);
+        }
+        return neighborsAcrossBlocks(x, y);
+    }
+
+    /** @brief Set every cell to the given type */
+    void fill(AIConfig::ObjectType type);
+
+    /** @brief Number of cells holding the given type */
+    std::size_t count(AIConfig::ObjectType type) const;
+
+    /** @brief Copy the size() cell types to out in row-major order */
+    void exportRowMajor(std::uint8_t* out) const;
+    /** @brief Overwrite every cell from size() row-major type bytes */
+    void importRowMajor(const std::uint8_t* in);
+
+private:
+    int width;
+    int length;
+    AIConfig::GridLayout layout;
+    // Blocks per block row (Tiled only)
+    std::size_t tilesX = 0;
+    std::vector<std::uint8_t> cells;
+
+    /** @brief neighbors() for cells whose neighbourhood leaves their block or the grid */
+    std::uint64_t neighborsAcrossBlocks(int x, int y) const;
+
+    /**
+     * @brief Visit the cells as contiguous storage runs in row-major cell order
+     *
+     * Calls visit(y, x, offset, count) for each run of count cells starting
+     * at (x, y), which are stored from index offset on; a row-major
+     * grid has one run per row, a tiled grid one per block it crosses.
+     */
+    template <typename Visit>
+    void forEachRun(Visit visit) const;
+};
@@ -6,8 +6,19 @@
  */
 
 #include "ant_intelligence/Ant.h"
+#include "ant_intelligence/AntColony.h"
+#include "ant_intelligence/CellIndex.h"
+#include "ant_intelligence/ClusterTracker.h"
+#include "ant_intelligence/FramePipeline.h"
 #include "ant_intelligence/Objects.h"
 #include "ant_intelligence/Config.h" // Added to get the default cooldown value
+#include "ant_intelligence/Grid.h"
+#include "ant_intelligence/Rng.h"
+#include <array>
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <random>
 #include <vector>
 #include <unordered_map>
 #include <memory>
@@ -33,6 +44,7 @@ public:
      * @param probRelu            Range used in interaction probability
      * @param similarityThreshold Number of matching memory items needed for interaction
      * @param interactionCooldown Number of steps an ant must wait after an interaction
+     * @param seed                Seed of every random decision made on this ground
      */
     Ground(int width,
         int length,
@@ -40,29 +52,74 @@ public:
         const std::vector<double>& probRelu,
         int similarityThreshold,
         // FIX: Added a default value to the constructor for backward compatibility
-        int interactionCooldown = AIConfig::DEFAULT_INTERACTION_COOLDOWN);
+        int interactionCooldown = AIConfig::DEFAULT_INTERACTION_COOLDOWN,
+        std::uint64_t seed = AIConfig::DEFAULT_SEED);
 
     /** @brief Create an ant and place it randomly on the ground */
     void addAnt(int memorySize = 20);
-    /** @brief Fill the ground with objects according to the distribution */
+    /**
+     * @brief Create count ants at once, exactly as count calls of addAnt(memorySize)
+     *
+     * Colony storage is reserved up front and the kernels are selected once.
+     */
+    void addAnts(int count, int memorySize = 20);
+    /**
+     * @brief Fill the ground with objects according to the type distribution
+     *
+     * Every cell draws from its own stream, so large grounds are filled by
+     * several threads with the same result.
+     */
+    void addObject(const std::unordered_map<AIConfig::ObjectType, double>& typeDict);
+    /** @brief Fill the ground from an Object instance distribution (API adapter) */
     void addObject(const std::unordered_map<std::shared_ptr<Object>, double>& objDict);
     /** @brief Move all ants one step */
     void moveAnts();
-    /** @brief Handle picking up and dropping objects */
+    /**
+     * @brief Advance one full iteration in as few passes over the ants as possible
+     *
+     * Produces exactly the same state as moveAnts(), assignWork() and
+     * handleAntInteractions() called in that order. In StepMode::Serial each
+     * ant moves and works in a single pass; a second pass handles
+     * interactions and cooldowns, since those read the neighbours' post-work
+     * memories. StepMode::Parallel keeps the move and work phases separate.
+     */
+    void step();
+    /**
+     * @brief Handle picking up and dropping objects
+     *
+     * In StepMode::Parallel the ground is cut into PARALLEL_TILE_SIZE tiles
+     * coloured like a 2x2 checkerboard. Tiles of one colour are at least one
+     * tile apart, so their ants never read or write the same cells and are
+     * processed concurrently; inside a tile ants keep their index order. The
+     * outcome depends only on the seed, never on the thread count, but it is
+     * a different (equally valid) ordering than StepMode::Serial.
+     */
     void assignWork();
-    /** @brief Compute the average size of object clusters */
+    /**
+     * @brief Average size of 8-connected same-type object clusters
+     *
+     * Kept up to date incrementally, so it is cheap enough to sample every step.
+     */
     double averageClusterSize();
 
     // Conditionally include visualization-related functions.
 #ifndef IS_TEST_BUILD
-    /** @brief Visualize the ground using OpenCV */
-    void showGround(const std::string& windowName, cv::VideoWriter& video) const;
+    /** @brief Visualize the ground using OpenCV, scale pixels per cell */
+    void showGround(const std::string& windowName, cv::VideoWriter& video,
+        int scale = AIConfig::DEFAULT_VIDEO_SCALE) const;
 #endif
 
+    /** @brief Copy the type grid and ant positions for off-thread rendering */
+    void snapshot(FrameSnapshot& frame) const;
+
     /** @brief Print a count of all objects */
     void countObjects() const;
-    /** @brief Access the underlying ant vector */
-    const std::vector<Ant>& getAgents() const;
+    /** @brief Snapshot of every ant as a standalone Ant object */
+    std::vector<Ant> getAgents() const;
+    /** @brief Snapshot of a single ant as a standalone Ant object */
+    Ant getAnt(size_t index) const;
+    /** @brief Structure-of-arrays state of all ants */
+    const AntColony& getColony() const { return colony; }
     /** @brief Check neighboring ants and update interaction counts */
     void handleAntInteractions(int currentIteration);
 
@@ -70,40 +127,257 @@ public:
     /** @brief Number of interactions detected so far */
     int getInteractionCount() const { return interactionCounter; }
 
+    /**
+     * @brief Count the cells ants move onto
+     *
+     * Off by default. When on, every move increments a shared per-cell visit
+     * counter, so coverage queries are O(1). Switching it on clears earlier
+     * counts. Visit counts are diagnostics and not part of saveState().
+     */
+    void setRecordPath(bool record);
+    bool getRecordPath() const { return recordPath; }
+    /** @brief Moves that ended on (x, y) since recording started */
+    std::uint32_t visitCount(int x, int y) const {
+        return (recordPath && grid.inBounds(x, y)) ? visitCounts[grid.index(x, y)] : 0;
+    }
+    /** @brief Distinct cells entered since recording started */
+    std::size_t coveredCells() const { return covered; }
+
+    /**
+     * @brief Select the cells inspected for pick/drop densities and interactions
+     *
+     * Movement always uses all eight directions, and averageClusterSize()
+     * always measures 8-connected clusters.
+     */
+    void setNeighborhood(AIConfig::NeighborhoodType type);
+    AIConfig::NeighborhoodType getNeighborhood() const { return neighborhood; }
+
+    /**
+     * @brief Allow the compile-time specialised work kernels (on by default)
+     *
+     * Colonies whose ants all have memory size 10, 20 or 32 run a kernel
+     * with the size baked in; other sizes use the generic kernel. Both give
+     * identical results, so switching this off is only useful to validate
+     * or benchmark the specialisations.
+     */
+    void setSpecializedKernels(bool enabled);
+    /** @brief Whether the current colony runs on a specialised work kernel */
+    bool usesSpecializedKernel() const;
+
+    /**
+     * @brief Storage order of the type grid (GridLayout::RowMajor by default)
+     *
+     * Only memory locality changes: every layout gives identical results, and
+     * saved states are row-major either way.
+     */
+    void setGridLayout(AIConfig::GridLayout layout);
+    AIConfig::GridLayout getGridLayout() const { return grid.getLayout(); }
+
+    /**
+     * @brief Reorder the ants by the storage index of their cell
+     *
+     * Each ant keeps its random streams, which are keyed by its permanent id
+     * (AntColony::getId), but ant indices change and the serial passes then
+     * visit ants in a different order. Runs stay reproducible from the seed
+     * but differ from unsorted ones.
+     */
+    void sortAnts();
+    /** @brief Call sortAnts() before every step whose move counter is a multiple of steps (0: never) */
+    void setAntSortInterval(int steps) { antSortInterval = steps > 0 ? steps : 0; }
+    int getAntSortInterval() const { return antSortInterval; }
+
+    /** @brief Select serial or multithreaded stepping */
+    void setStepMode(AIConfig::StepMode mode) { stepMode = mode; }
+    AIConfig::StepMode getStepMode() const { return stepMode; }
+
+    /** @brief Seed this ground draws all of its random numbers from */
+    std::uint64_t getSeed() const { return seed; }
+    /**
+     * @brief Switch to a different random stream from the current state on
+     *
+     * Used to fork independent runs from one saved state.
+     */
+    void setSeed(std::uint64_t newSeed) { seed = newSeed; }
+
+    /**
+     * @brief Write the complete dynamic state in a versioned binary format
+     *
+     * Covers the row-major type grid, every ant (id, position, direction,
+     * load, cooldown, memory ring), the interaction counter, the seed and the
+     * RNG step counters. Configuration given to the constructor (probabilities,
+     * threshold, cooldown length) is not included, so a state can be loaded
+     * into grounds with different parameters. All fields are little-endian
+     * and the grid starts at a fixed 64-byte offset.
+     */
+    void saveState(std::ostream& out) const;
+    /**
+     * @brief Restore a state written by saveState
+     *
+     * Throws std::runtime_error if the data is not a ground state, has an
+     * unsupported version, is truncated, or was saved with other dimensions.
+     */
+    void loadState(std::istream& in);
+
+    /** @brief Dense grid of object types on the ground */
+    const Grid& getGrid() const { return grid; }
+    /** @brief Object type lying at the given position */
+    AIConfig::ObjectType getObjectType(const std::pair<int, int>& pos) const {
+        return grid.get(pos.first, pos.second);
+    }
+
 private:
+    // Share the fill rule, the random streams and the state format.
+    friend class DistributedGround;
+    friend class DeviceGround;
+    friend class ReplicaBatch;
+
     int width;
     int length;
-    std::unordered_map<std::pair<int, int>, std::vector<std::pair<int, int>>, pair_hash> possiblePositions;
-    std::vector<Ant> agents;
-    std::unordered_map<std::pair<int, int>, std::shared_ptr<Object>, pair_hash> obj;
+    // OPTIMIZATION: Ants live in contiguous per-field arrays rather than a
+    // vector of Ant objects with their own heap-allocated containers.
+    AntColony colony;
+    // OPTIMIZATION: Object occupancy is a flat one-byte-per-cell type grid
+    // instead of a hash map of shared_ptrs.
+    Grid grid;
+    // Ants per cell, refreshed before the interaction pass.
+    CellIndex cellIndex;
+    // Connected same-type clusters, updated on every serial pick/drop.
+    ClusterTracker clusterTracker;
     std::vector<double> probabilities;
+    DirectionSampler directionSampler;
     std::vector<double> probRelu;
+    // densityRamp[n][k]: reluRange(k / n) over probRelu for k matching cells
+    // out of n valid neighbours, computed once.
+    using DensityRamp = std::array<std::array<double, AIConfig::NUM_DIRECTIONS + 1>, AIConfig::NUM_DIRECTIONS + 1>;
+    DensityRamp densityRamp{};
     int similarityThreshold;
     int cooldown_duration;
     int interactionCounter = 0;  // Counter for successful interactions
 
-    /** @brief Pre-compute neighbour cells for each grid position */
-    std::unordered_map<std::pair<int, int>, std::vector<std::pair<int, int>>, pair_hash> getPossiblePositions();
+    // Per-cell move counts, allocated only while recording paths.
+    bool recordPath = false;
+    std::vector<std::uint32_t> visitCounts;
+    std::size_t covered = 0;
+
+    // Independent random streams. Every draw is keyed by
+    // (seed, stream | permanent ant id or row-major cell id, call counter), so
+    // no draw depends on the order in which ants or cells are processed.
+    enum class RngStream : std::uint64_t {
+        Placement = 1,
+        Objects = 2,
+        Move = 3,
+        Work = 4
+    };
+    std::uint64_t seed;
+    std::uint64_t objectFills = 0;
+    std::uint64_t moveSteps = 0;
+    std::uint64_t workSteps = 0;
+
+    AIConfig::StepMode stepMode = AIConfig::StepMode::Serial;
+    AIConfig::NeighborhoodType neighborhood = AIConfig::DEFAULT_NEIGHBORHOOD;
+    int antSortInterval = AIConfig::DEFAULT_ANT_SORT_INTERVAL;
+
+    // Per-ant kernels chosen by selectKernels() for the current memory size
+    // and neighbourhood.
+    using AntKernel = void (Ground::*)(size_t);
+    bool specializedKernels = true;
+    AntKernel workKernel = nullptr;
+    AntKernel interactKernel = nullptr;
+
+    // Parallel assignWork schedule: tiles of each checkerboard colour, and a
+    // counting-sort bucketing of ant indices by tile reused across steps.
+    int tilesX = 0;
+    int tilesY = 0;
+    std::vector<std::vector<int>> tilesByColor;
+    std::vector<int> tileStart;
+    std::vector<int> tileCursor;
+    std::vector<int> tileAnts;
+
+    // Per-ant move and work stream states of the current step.
+    CounterRngBlock moveRng;
+    CounterRngBlock workRng;
+
+    /** @brief sortAnts() if the sort interval says so */
+    void sortAntsIfDue();
+
+    /** @brief Stream id of one entity of a stream */
+    static std::uint64_t streamId(RngStream stream, std::uint64_t id) {
+        return (static_cast<std::uint64_t>(stream) << 56) ^ id;
+    }
+    /** @brief Generator for one entity of a stream at a given counter */
+    CounterRng makeRng(RngStream stream, std::uint64_t id, std::uint64_t counter) const {
+        return CounterRng(seed, streamId(stream, id), counter);
+    }
+    /** @brief Size an ant stream block for the current colony at a given counter; fill() it with the ant ids */
+    void prepareRng(CounterRngBlock& block, RngStream stream, std::uint64_t counter) {
+        block.prepare(seed, streamId(stream, 0), counter, colony.size());
+    }
+
+    /** @brief Counters stored in the header of a saved state */
+    struct StateCounters {
+        std::uint64_t seed;
+        std::uint64_t objectFills;
+        std::uint64_t moveSteps;
+        std::uint64_t workSteps;
+        std::int64_t interactions;
+    };
+    /** @brief Write a saveState() stream from its parts; rowMajor holds width * length type bytes */
+    static void writeState(std::ostream& out, int width, int length, const StateCounters& counters,
+        const std::uint8_t* rowMajor, const AntColony& colony);
+
+    /** @brief Append one ant at a random cell, drawn from its own placement stream */
+    void placeAnt(int memorySize);
     /** @brief Pick a random valid grid cell */
-    std::pair<int, int> getRandomPosition();
+    std::pair<int, int> getRandomPosition(CounterRng& gen);
     /**
-     * @brief Pick an object type according to the provided distribution.
+     * @brief Object types with the distribution that picks among them, built once per fill
+     *
+     * Drawing is stateless, so one sampler gives the same types as a fresh
+     * distribution per cell.
      */
-    std::shared_ptr<Object> getRandomObject(
-        const std::vector<std::shared_ptr<Object>>& keys,
-        const std::vector<double>& values);
+    struct ObjectSampler {
+        std::vector<AIConfig::ObjectType> keys;
+        std::discrete_distribution<> distribution;
+
+        explicit ObjectSampler(const std::unordered_map<AIConfig::ObjectType, double>& typeDict);
+        /** @brief Pick an object type according to the distribution */
+        AIConfig::ObjectType operator()(CounterRng& gen) { return keys[distribution(gen)]; }
+    };
 
     /** @brief Simple linear activation used for probabilities */
-    double reluRange(double x, double a, double b);
+    static double reluRange(double x, double a, double b);
+    /** @brief Pick/drop probability table for a probRelu range (all zero if it has fewer than two values) */
+    static DensityRamp buildDensityRamp(const std::vector<double>& probRelu);
+
+    /** @brief Movement of a single ant; its moveRng state must be filled */
+    void moveAnt(size_t antIndex);
+    /** @brief Pick/drop decision for a single ant; its workRng state must be filled */
+    void workAnt(size_t antIndex) { (this->*workKernel)(antIndex); }
+    /** @brief Interaction check of a single ant against the ants around it */
+    void interactAnt(size_t antIndex) { (this->*interactKernel)(antIndex); }
 
     /**
-     * @brief Breadth-first search to compute cluster sizes.
+     * @brief workAnt for a fixed memory capacity (0: read at run time) and neighbourhood
+     *
+     * With both known at compile time the memory ring pushes and the
+     * neighbour scan need no run-time bounds or stride.
      */
-    double bfsCluster(
-        const std::pair<int, int>& startPos,
-        std::shared_ptr<Object> targetObj,
-        std::unordered_set<std::pair<int, int>, pair_hash>& visitedLocations);
+    template <int Capacity, AIConfig::NeighborhoodType N>
+    void workAntKernel(size_t antIndex);
+    template <AIConfig::NeighborhoodType N>
+    void interactAntKernel(size_t antIndex);
+    /** @brief Work kernel of a neighbourhood for a memory capacity, generic if none is specialised */
+    template <AIConfig::NeighborhoodType N>
+    static AntKernel workKernelFor(int capacity);
+    /** @brief Point the per-ant kernels at the best match for the colony */
+    void selectKernels();
+    /** @brief Group ant indices by tile for the parallel schedule */
+    void bucketAntsByTile();
+
+    /** @brief Write a cell and keep the cluster tracker in sync */
+    void setCell(int x, int y, AIConfig::ObjectType type);
 
-    /** @brief Count neighbouring cells that contain the same object type */
-    int countNeighbors(const std::pair<int, int>& pos, std::shared_ptr<Object> objType);
+    /** @brief Count neighbouring cells of neighbourhood N that contain the same object type */
+    template <AIConfig::NeighborhoodType N>
+    int countNeighbors(int x, int y, AIConfig::ObjectType objType) const;
 };
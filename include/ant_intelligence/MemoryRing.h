@@ -0,0 +1,78 @@
+#pragma once
+
+/**
+ * @file MemoryRing.h
+ * @brief Fixed-capacity FIFO of seen object types with running type counts.
+ */
+
+#include "ant_intelligence/Config.h"
+#include <array>
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+/**
+ * @class MemoryRing
+ * @brief An ant's memory: the last N object types it has seen.
+ *
+ * Entries live in a ring buffer whose capacity never changes, and a counter
+ * per ObjectType is kept up to date on every push, so asking how many times a
+ * type is remembered is O(1) instead of a scan over the memory.
+ */
+class MemoryRing {
+public:
+    /** @brief Construct an empty memory with the given capacity */
+    explicit MemoryRing(int capacity = AIConfig::DEFAULT_MEMORY_SIZE);
+
+    /** @brief Remember a type, evicting the oldest entry when full. None is ignored. */
+    void push(AIConfig::ObjectType type) {
+        push(slots.data(), head, used, static_cast<int>(slots.size()), counts.data(),
+            static_cast<std::uint8_t>(type));
+    }
+
+    /** @brief Number of remembered entries of a type */
+    int count(AIConfig::ObjectType type) const { return counts[static_cast<int>(type)]; }
+    /** @brief Number of remembered entries */
+    int size() const { return used; }
+    /** @brief Maximum number of entries */
+    int capacity() const { return static_cast<int>(slots.size()); }
+    /** @brief k-th entry, oldest first */
+    int at(int k) const { return slots[(head + k) % slots.size()]; }
+    /** @brief Entries, oldest first */
+    std::deque<int> toDeque() const;
+
+    /**
+     * @brief Push kernel shared with AntColony's flat memory arrays.
+     *
+     * @param ring      capacity slots of the ring
+     * @param head      Index of the oldest entry
+     * @param used      Number of valid entries
+     * @param capacity  Ring capacity (0 disables the memory)
+     * @param counts    AIConfig::NUM_OBJECT_TYPES running counters
+     * @param type      ObjectType value to push
+     */
+    static void push(std::uint8_t* ring, std::uint16_t& head, std::uint16_t& used, int capacity,
+        std::uint16_t* counts, std::uint8_t type) {
+        if (type == static_cast<std::uint8_t>(AIConfig::ObjectType::None) || capacity == 0) {
+            return;
+        }
+        if (used < capacity) {
+            int slot = head + used;
+            ring[slot >= capacity ? slot - capacity : slot] = type;
+            ++used;
+        }
+        else {
+            // Full: the oldest entry is overwritten and its count retired.
+            --counts[ring[head]];
+            ring[head] = type;
+            head = static_cast<std::uint16_t>(head + 1 == capacity ? 0 : head + 1);
+        }
+        ++counts[type];
+    }
+
+private:
+    std::vector<std::uint8_t> slots;
+    std::uint16_t head = 0;
+    std::uint16_t used = 0;
+    std::array<std::uint16_t, AIConfig::NUM_OBJECT_TYPES> counts{};
+};
@@ -0,0 +1,95 @@
+#pragma once
+
+/**
+ * @file MetricsStream.h
+ * @brief Live NDJSON feed of run progress and sampled metrics.
+ */
+
+#include "ant_intelligence/Config.h"
+#include "ant_intelligence/ResultsWriter.h"
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * @class MetricsStream
+ * @brief Streams events of concurrent runs to a file, one JSON object per line.
+ *
+ * Simulation threads only append a fixed-size event to a bounded buffer
+ * under a short lock; they never format text, touch the file or wake the
+ * writer. A writer thread swaps the buffer out every flush interval, writes
+ * the lines and flushes, so a reader tailing the file (or a named pipe) sees
+ * each batch as a whole. When the buffer is full, further samples are
+ * dropped and counted rather than blocking the simulation; run ends are
+ * always kept, so the buffer grows by at most one event per run.
+ *
+ * Lines, in the order the events were published:
+ *
+ *     {"event": "start", "runs": N, "parameters": {...}}
+ *     {"event": "sample", "cooldown": C, "threshold": T, "run": R, "iteration": I, "cluster": X, "interactions": K}
+ *     {"event": "run_end", "cooldown": C, "threshold": T, "run": R[, "converged": I]}
+ *     {"event": "end", "dropped": D}
+ */
+class MetricsStream {
+public:
+    /**
+     * @brief Open (truncate) the output file, write the start event and start the writer thread
+     *
+     * @param filename    Output path
+     * @param runs        Number of runs the stream will report
+     * @param parameters  JSON object stored in the start event
+     * @param queueDepth  Events that may wait for the writer before new ones are dropped
+     */
+    MetricsStream(const std::string& filename, std::size_t runs, const std::string& parameters = "{}",
+        std::size_t queueDepth = AIConfig::DEFAULT_METRICS_QUEUE_DEPTH);
+    /** @brief Writes everything published so far and closes the file */
+    ~MetricsStream();
+
+    MetricsStream(const MetricsStream&) = delete;
+    MetricsStream& operator=(const MetricsStream&) = delete;
+
+    /** @brief Publish one sampled row; returns false if it was dropped */
+    bool publishSample(const ResultRow& row);
+    /**
+     * @brief Publish the end of a run, even when the buffer is full; returns false after finish()
+     *
+     * @param convergedIteration  Iteration the run converged and stopped at, or -1
+     */
+    bool publishRunEnd(int cooldown, int threshold, int run, int convergedIteration = -1);
+
+    /**
+     * @brief Write the remaining events and the end event, then close the file
+     *
+     * Throws std::runtime_error if a write failed.
+     */
+    void finish();
+
+    /** @brief Number of samples dropped because the buffer was full */
+    std::uint64_t dropped() const;
+
+private:
+    struct Event {
+        bool runEnd;
+        ResultRow row;
+    };
+
+    std::ofstream file;
+    std::size_t capacity;
+    std::vector<Event> pending;
+    std::uint64_t droppedEvents = 0;
+    bool finishing = false;
+    bool failed = false;
+
+    mutable std::mutex mutex;
+    std::condition_variable stop;
+    std::thread writer;
+
+    bool publish(const Event& event);
+    void run();
+    void writeEvents(const std::vector<Event>& events);
+};
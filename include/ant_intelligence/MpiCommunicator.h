@@ -0,0 +1,57 @@
+#pragma once
+
+/**
+ * @file MpiCommunicator.h
+ * @brief Communicator over MPI, compiled only when ANT_WITH_MPI is defined.
+ */
+
+#ifdef ANT_WITH_MPI
+
+#include "ant_intelligence/Communicator.h"
+#include <list>
+#include <mpi.h>
+
+/**
+ * @class MpiCommunicator
+ * @brief Ranks of an MPI communicator.
+ *
+ * send() posts a nonblocking MPI_Isend of a private copy of the message, so
+ * it returns at once; recv() probes for the size first. The collectives map
+ * to MPI_Allreduce, MPI_Gatherv and MPI_Bcast. MPI must be initialised
+ * before construction and finalised only after destruction.
+ */
+class MpiCommunicator : public Communicator {
+public:
+    explicit MpiCommunicator(MPI_Comm comm = MPI_COMM_WORLD);
+    /** @brief Waits for every message still in flight */
+    ~MpiCommunicator() override;
+
+    MpiCommunicator(const MpiCommunicator&) = delete;
+    MpiCommunicator& operator=(const MpiCommunicator&) = delete;
+
+    int rank() const override { return ownRank; }
+    int size() const override { return ranks; }
+    void send(int destination, const Buffer& message) override;
+    void recv(int source, Buffer& message) override;
+
+    void allreduceSum(std::vector<std::int64_t>& values) override;
+    void gather(const Buffer& local, std::vector<Buffer>& all, int root = 0) override;
+    void broadcast(Buffer& data, int root = 0) override;
+
+private:
+    struct Pending {
+        MPI_Request request;
+        Buffer data;
+    };
+
+    MPI_Comm comm;
+    int ownRank = 0;
+    int ranks = 1;
+    // Sends not yet known to be complete; a list keeps their buffers in place.
+    std::list<Pending> pending;
+
+    /** @brief Drop the sends that have completed */
+    void reap();
+};
+
+#endif
@@ -0,0 +1,162 @@
+#pragma once
+
+/**
+ * @file Neighborhood.h
+ * @brief Bounds handling for the Moore and von Neumann neighbourhoods.
+ *
+ * Neighbours are always visited in direction order (AIConfig::DIRECTION_DX/DY).
+ * Interior cells have all eight and need no checks; only the outermost ring
+ * of the grid goes through the valid-direction mask. A von Neumann
+ * neighbourhood is the subset of even (orthogonal) directions.
+ *
+ * gather() and countMatches() count matching neighbours SWAR-style: the
+ * eight neighbour type bytes are packed into one 64-bit word and compared
+ * against a type in a single XOR / zero-byte test, with no per-direction
+ * branches and no target-specific intrinsics.
+ */
+
+#include "ant_intelligence/Config.h"
+#include <cstddef>
+#include <cstdint>
+
+namespace Neighborhood {
+    /** @brief Whether all eight neighbours of (x, y) lie on the grid */
+    inline bool isInterior(int x, int y, int width, int length) {
+        return x > 0 && x < width - 1 && y > 0 && y < length - 1;
+    }
+
+    /** @brief Bit d is set when neighbour d of (x, y) lies on the grid */
+    inline int validMask(int x, int y, int width, int length) {
+        int mask = 0;
+        for (int d = 0; d < AIConfig::NUM_DIRECTIONS; ++d) {
+            int nx = x + AIConfig::DIRECTION_DX[d];
+            int ny = y + AIConfig::DIRECTION_DY[d];
+            if (nx >= 0 && nx < width && ny >= 0 && ny < length) {
+                mask |= 1 << d;
+            }
+        }
+        return mask;
+    }
+
+    /** @brief Number of directions set in a valid-direction mask */
+    inline int countMask(int mask) {
+        int n = 0;
+        for (; mask != 0; mask &= mask - 1) {
+            ++n;
+        }
+        return n;
+    }
+
+    /** @brief Number of neighbours of (x, y) that lie on the grid */
+    inline int count(int x, int y, int width, int length) {
+        if (isInterior(x, y, width, length)) {
+            return AIConfig::NUM_DIRECTIONS;
+        }
+        return countMask(validMask(x, y, width, length));
+    }
+
+    /** @brief Direction bits included in a neighbourhood type */
+    constexpr int stencilMask(AIConfig::NeighborhoodType type) {
+        return type == AIConfig::NeighborhoodType::Moore ? 0xFF : 0x55;
+    }
+
+    /** @brief Number of cells in a full (interior) neighbourhood of a type */
+    constexpr int stencilSize(AIConfig::NeighborhoodType type) {
+        return type == AIConfig::NeighborhoodType::Moore ? AIConfig::NUM_DIRECTIONS : AIConfig::NUM_DIRECTIONS / 2;
+    }
+
+    /** @brief Number of neighbours of (x, y) of a neighbourhood type that lie on the grid */
+    inline int count(int x, int y, int width, int length, AIConfig::NeighborhoodType type) {
+        if (isInterior(x, y, width, length)) {
+            return stencilSize(type);
+        }
+        return countMask(validMask(x, y, width, length) & stencilMask(type));
+    }
+
+    /** @brief Direction of the k-th valid neighbour, in direction order */
+    inline int nthValidDirection(int mask, int k) {
+        for (int d = 0; d < AIConfig::NUM_DIRECTIONS; ++d) {
+            if ((mask & (1 << d)) && k-- == 0) {
+                return d;
+            }
+        }
+        return -1;
+    }
+
+    /**
+     * @name Packed neighbour bytes
+     *
+     * A packed word holds the neighbour types row by row: bytes 0-2 are the
+     * row above (x-1, x, x+1), bytes 3-4 the left and right cells, and bytes
+     * 5-7 the row below. That is, directions 7, 0, 1, 6, 2, 5, 4, 3.
+     */
+    ///@{
+    /** @brief Byte value for neighbours off the grid; never equals an object type */
+    constexpr std::uint8_t OFF_GRID = 0xFF;
+
+    /** @brief Byte of the packed word that holds neighbour direction d */
+    constexpr int packedSlot(int d) {
+        // Direction order N, NE, E, SE, S, SW, W, NW mapped to row order.
+        return d == 7 ? 0 : d == 0 ? 1 : d == 1 ? 2 : d == 6 ? 3
+            : d == 2 ? 4 : d == 5 ? 5 : d == 4 ? 6 : 7;
+    }
+
+    /** @brief High bit of every packed byte belonging to the neighbourhood type */
+    constexpr std::uint64_t laneMask(AIConfig::NeighborhoodType type) {
+        std::uint64_t lanes = 0;
+        for (int d = 0; d < AIConfig::NUM_DIRECTIONS; ++d) {
+            if (stencilMask(type) & (1 << d)) {
+                lanes |= std::uint64_t(0x80) << (8 * packedSlot(d));
+            }
+        }
+        return lanes;
+    }
+
+    /** @brief Pack the eight bytes around center, given the distance between rows */
+    inline std::uint64_t gatherInterior(const std::uint8_t* center, std::ptrdiff_t stride) {
+        const std::uint8_t* up = center - stride;
+        const std::uint8_t* down = center + stride;
+        return std::uint64_t(up[-1]) | std::uint64_t(up[0]) << 8 | std::uint64_t(up[1]) << 16
+            | std::uint64_t(center[-1]) << 24 | std::uint64_t(center[1]) << 32
+            | std::uint64_t(down[-1]) << 40 | std::uint64_t(down[0]) << 48 | std::uint64_t(down[1]) << 56;
+    }
+
+    /** @brief Store the byte of neighbour direction d in a packed word */
+    inline std::uint64_t withSlot(std::uint64_t packed, int d, std::uint8_t value) {
+        const int shift = 8 * packedSlot(d);
+        return (packed & ~(std::uint64_t(0xFF) << shift)) | std::uint64_t(value) << shift;
+    }
+
+    /**
+     * @brief Pack the type bytes around (x, y) of a row-major grid
+     *
+     * Interior cells take three straight row reads; cells on the outer ring
+     * fill missing neighbours with OFF_GRID.
+     */
+    inline std::uint64_t gather(const std::uint8_t* cells, int x, int y, int width, int length) {
+        if (isInterior(x, y, width, length)) {
+            return gatherInterior(cells + static_cast<std::ptrdiff_t>(y) * width + x, width);
+        }
+        std::uint64_t packed = ~std::uint64_t(0);
+        int mask = validMask(x, y, width, length);
+        for (int d = 0; d < AIConfig::NUM_DIRECTIONS; ++d) {
+            if (mask & (1 << d)) {
+                packed = withSlot(packed, d, cells[static_cast<std::ptrdiff_t>(y + AIConfig::DIRECTION_DY[d]) * width
+                    + x + AIConfig::DIRECTION_DX[d]]);
+            }
+        }
+        return packed;
+    }
+
+    /** @brief Number of bytes in the lanes of a packed word equal to type */
+    inline int countMatches(std::uint64_t packed, std::uint8_t type, std::uint64_t lanes) {
+        constexpr std::uint64_t LOW7 = 0x7F7F7F7F7F7F7F7FULL;
+        constexpr std::uint64_t ONES = 0x0101010101010101ULL;
+        // Exact zero-byte test: the high bit is set only in bytes equal to type.
+        std::uint64_t diff = packed ^ (ONES * type);
+        std::uint64_t zero = ~(((diff & LOW7) + LOW7) | diff | LOW7) & lanes;
+        // Each byte now holds 0 or 1; the multiply sums them into the top byte.
+        return static_cast<int>(((zero >> 7) * ONES) >> 56);
+    }
+    ///@}
+}
@@ -1,9 +1,14 @@
 /**
  * @file Objects.h
  * @brief Defines the object types that can exist on the ground.
+ *
+ * The simulation engine itself works with AIConfig::ObjectType tags. This
+ * class hierarchy is kept as an API adapter for callers that prefer object
+ * instances; objectTypeOf() and makeObject() convert between the two.
  */
 #pragma once
 
+#include "ant_intelligence/Config.h"
 #include <memory>
 
  /**
@@ -31,4 +36,28 @@ class Waste : public Object {};
  * @class Egg
  * @brief Represents an egg item.
  */
-class Egg : public Object {};
\ No newline at end of file
+class Egg : public Object {};
+
+/** @brief Type tag of an object instance (None for nullptr or unknown types) */
+inline AIConfig::ObjectType objectTypeOf(const std::shared_ptr<Object>& object) {
+    if (std::dynamic_pointer_cast<Food>(object)) {
+        return AIConfig::ObjectType::Food;
+    }
+    else if (std::dynamic_pointer_cast<Waste>(object)) {
+        return AIConfig::ObjectType::Waste;
+    }
+    else if (std::dynamic_pointer_cast<Egg>(object)) {
+        return AIConfig::ObjectType::Egg;
+    }
+    return AIConfig::ObjectType::None;
+}
+
+/** @brief Create an object instance for a type tag (nullptr for None) */
+inline std::shared_ptr<Object> makeObject(AIConfig::ObjectType type) {
+    switch (type) {
+    case AIConfig::ObjectType::Food:  return std::make_shared<Food>();
+    case AIConfig::ObjectType::Waste: return std::make_shared<Waste>();
+    case AIConfig::ObjectType::Egg:   return std::make_shared<Egg>();
+    default:                          return nullptr;
+    }
+}
@@ -0,0 +1,122 @@
+#pragma once
+
+/**
+ * @file Profiling.h
+ * @brief Optional per-phase timers and event counters for the simulation step.
+ *
+ * Instrumentation is compiled in only when ANT_PROFILING is defined. Without
+ * it ANT_PROFILE_SCOPE and ANT_PROFILE_COUNT expand to nothing, and collect()
+ * returns an empty report, so callers need no #ifdefs of their own.
+ */
+
+#include <array>
+#include <cstdint>
+#include <ostream>
+#include <vector>
+
+#ifdef ANT_PROFILING
+#include <chrono>
+#endif
+
+namespace Profiling {
+
+    /** @brief Timed sections of a simulation step */
+    enum class Phase : int {
+        MoveAnts,
+        AssignWork,
+        Interactions,
+        ClusterSize,
+        Snapshot,
+        ShowGround,
+        Step,
+        Exchange,   // Halo, migration and reduction traffic of DistributedGround
+        Count
+    };
+
+    /** @brief Counted events */
+    enum class Counter : int {
+        Picks,             // Empty-handed ant picked up the object under it
+        Drops,             // Ant dropped its load on an empty cell
+        Swaps,             // Ant dropped its load and took the object lying there
+        InteractionChecks, // Memory similarity comparisons between neighbours
+        Interactions,      // Comparisons that reached the similarity threshold
+        Count
+    };
+
+    constexpr int NUM_PHASES = static_cast<int>(Phase::Count);
+    constexpr int NUM_COUNTERS = static_cast<int>(Counter::Count);
+
+    /** @brief Whether this build records anything */
+#ifdef ANT_PROFILING
+    constexpr bool ENABLED = true;
+#else
+    constexpr bool ENABLED = false;
+#endif
+
+    const char* phaseName(Phase phase);
+    const char* counterName(Counter counter);
+
+    /** @brief Accumulated timers and counters of one thread (or of all of them) */
+    struct ThreadTotals {
+        int thread = -1;
+        std::array<std::uint64_t, NUM_PHASES> phaseNs{};
+        std::array<std::uint64_t, NUM_PHASES> phaseCalls{};
+        std::array<std::uint64_t, NUM_COUNTERS> counters{};
+    };
+
+    /** @brief Snapshot of every thread that has recorded something */
+    struct Report {
+        std::vector<ThreadTotals> threads;
+        /** @brief Sum over all threads; thread is -1 */
+        ThreadTotals total() const;
+    };
+
+    /** @brief Gather the totals of every thread */
+    Report collect();
+    /** @brief Zero every thread's totals */
+    void reset();
+
+    /** @brief {"enabled", "total", "threads": [...]} with ns and call counts per phase */
+    void writeJson(std::ostream& out, const Report& report);
+    /** @brief thread,kind,name,calls,value rows; thread "total" holds the sums */
+    void writeCsv(std::ostream& out, const Report& report);
+    /** @brief Human-readable table of the totals */
+    void writeSummary(std::ostream& out, const Report& report);
+
+#ifdef ANT_PROFILING
+    /** @brief Add elapsed time to the calling thread's phase timer */
+    void addTime(Phase phase, std::uint64_t ns);
+    /** @brief Add to the calling thread's counter */
+    void addCount(Counter counter, std::uint64_t n);
+
+    /** @brief Times the enclosing scope into a phase */
+    class ScopedTimer {
+    public:
+        explicit ScopedTimer(Phase phase) : phase(phase), start(std::chrono::steady_clock::now()) {}
+        ~ScopedTimer() {
+            auto elapsed = std::chrono::steady_clock::now() - start;
+            addTime(phase, static_cast<std::uint64_t>(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()));
+        }
+        ScopedTimer(const ScopedTimer&) = delete;
+        ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+    private:
+        Phase phase;
+        std::chrono::steady_clock::time_point start;
+    };
+#endif
+}
+
+#ifdef ANT_PROFILING
+#define ANT_PROFILE_CONCAT_IMPL(a, b) a##b
+#define ANT_PROFILE_CONCAT(a, b) ANT_PROFILE_CONCAT_IMPL(a, b)
+/** @brief Time the rest of the enclosing scope as Profiling::Phase::phase */
+#define ANT_PROFILE_SCOPE(phase) \
+    ::Profiling::ScopedTimer ANT_PROFILE_CONCAT(antProfileTimer_, __LINE__)(::Profiling::Phase::phase)
+/** @brief Add n to Profiling::Counter::counter */
+#define ANT_PROFILE_COUNT(counter, n) ::Profiling::addCount(::Profiling::Counter::counter, (n))
+#else
+#define ANT_PROFILE_SCOPE(phase) ((void)0)
+#define ANT_PROFILE_COUNT(counter, n) ((void)0)
+#endif
@@ -0,0 +1,118 @@
+#pragma once
+
+/**
+ * @file ReplicaBatch.h
+ * @brief Many small, independent grounds stepped together.
+ */
+
+#include "ant_intelligence/ClusterTracker.h"
+#include "ant_intelligence/Config.h"
+#include "ant_intelligence/Ground.h"
+#include "ant_intelligence/Grid.h"
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <vector>
+
+/**
+ * @class ReplicaBatch
+ * @brief Lockstep engine for a set of equally sized grounds, such as the runs of a sweep.
+ *
+ * Per-ant state is stored replica-interleaved: entry (ant, replica) lives at
+ * ant * size() + replica, so one pass over an ant index touches the same ant
+ * of every replica in consecutive slots, and the random stream states of a
+ * whole row are derived in one vectorisable loop. Each replica keeps its own
+ * type grid, seed, similarity threshold and cooldown.
+ *
+ * Every replica reproduces, byte for byte, a Ground in StepMode::Serial
+ * calling moveAnts(), assignWork() and handleAntInteractions(): replicas
+ * never interact, and inside one the ants are still visited in index order.
+ */
+class ReplicaBatch {
+public:
+    /**
+     * @brief Take over the state of initialised grounds, one replica each
+     *
+     * The grounds must agree on dimensions, movement probabilities,
+     * probRelu, neighbourhood, ant count, a shared memory capacity and the
+     * move and work counters, and must not sort their ants. Seeds,
+     * thresholds, cooldowns and contents may differ. Throws
+     * std::invalid_argument otherwise.
+     */
+    explicit ReplicaBatch(const std::vector<const Ground*>& replicas);
+
+    /** @brief Number of replicas */
+    std::size_t size() const { return replicaCount; }
+    /** @brief Ants per replica */
+    std::size_t antCount() const { return numAnts; }
+
+    /** @brief One full iteration of every replica */
+    void step();
+
+    /** @brief Average size of 8-connected same-type clusters of one replica */
+    double averageClusterSize(std::size_t replica);
+    /** @brief Interactions detected so far in one replica */
+    int getInteractionCount(std::size_t replica) const { return static_cast<int>(interactions[replica]); }
+    /** @brief Type grid of one replica */
+    const Grid& getGrid(std::size_t replica) const { return grids[replica]; }
+
+    /** @brief Write one replica in Ground::saveState format */
+    void saveState(std::size_t replica, std::ostream& out) const;
+
+private:
+    int width;
+    int length;
+    std::size_t replicaCount;
+    std::size_t numAnts;
+    int capacity;
+
+    std::vector<double> acceptance;
+    std::vector<int> alias;
+    Ground::DensityRamp densityRamp;
+    AIConfig::NeighborhoodType neighborhood;
+    std::uint64_t lanes;
+    std::uint64_t moveSteps;
+    std::uint64_t workSteps;
+
+    // Per replica.
+    std::vector<Grid> grids;
+    std::vector<ClusterTracker> clusterTrackers;
+    std::vector<std::uint64_t> seeds;
+    std::vector<std::uint64_t> objectFills;
+    std::vector<int> thresholds;
+    std::vector<int> cooldownDurations;
+    std::vector<std::int64_t> interactions;
+
+    // Per (ant, replica), at ant * replicaCount + replica. Memory rings and
+    // type counters take capacity and AIConfig::NUM_OBJECT_TYPES slots per entry.
+    std::vector<std::uint32_t> ids;
+    std::vector<int> xs;
+    std::vector<int> ys;
+    std::vector<std::uint8_t> directions;
+    std::vector<std::uint8_t> loads;
+    std::vector<int> cooldowns;
+    std::vector<std::uint8_t> memory;
+    std::vector<std::uint16_t> memoryHead;
+    std::vector<std::uint16_t> memoryCount;
+    std::vector<std::uint16_t> typeCounts;
+
+    // Stream states of the current ant row, one per replica.
+    std::vector<std::uint64_t> moveStates;
+    std::vector<std::uint64_t> workStates;
+
+    // Ants per cell: cellHead at replica * cells + cell, so each replica's
+    // lookups stay in its own block, then nextAnt per (ant, replica);
+    // ascending ant order as in CellIndex.
+    std::vector<int> cellHead;
+    std::vector<int> nextAnt;
+    std::vector<int> antSlot;
+
+    /** @brief Ant::moveStep of entry k, drawing from moveStates[replica] */
+    void moveAnt(std::size_t k, std::size_t replica);
+    /** @brief Ground's pick/drop rule for entry k, drawing from workStates[replica] */
+    void workAnt(std::size_t k, std::size_t replica);
+    /** @brief Ground's interaction check and cooldown countdown for entry k */
+    void interactAnt(std::size_t k, std::size_t replica);
+    /** @brief Re-index every ant of every replica at its current cell */
+    void rebuildCells();
+};
@@ -0,0 +1,128 @@
+#pragma once
+
+/**
+ * @file ResultsWriter.h
+ * @brief In-memory collection of per-run results streamed to one output file.
+ */
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * @struct ResultRow
+ * @brief One sampled data point of an experiment run.
+ */
+struct ResultRow {
+    int cooldown = 0;
+    int threshold = 0;
+    int run = 0;
+    int iteration = 0;
+    double clusterSize = 0.0;
+    int interactionCount = 0;
+    /** @brief Iteration at which the run converged and stopped, or -1 if it ran to the end */
+    int convergedIteration = -1;
+};
+
+/**
+ * @class ResultsWriter
+ * @brief Writes the rows of many concurrent runs to a single file in a fixed order.
+ *
+ * Each run fills its own row buffer without any synchronisation and hands
+ * it over once with submit(), tagged with its position in the sweep. A writer
+ * thread appends buffers strictly in position order as soon as the next one
+ * is available, so the file is the same however the runs were scheduled and
+ * no temporary files are needed.
+ *
+ * Format::Binary is a little-endian columnar file meant to be memory mapped:
+ *
+ *     char[8]  magic "ANTCOL1\0"
+ *     uint32   format version (1, or 2 with the convergence column)
+ *     uint32   metadata byte length m
+ *     char[m]  metadata (UTF-8 JSON, e.g. the simulation parameters)
+ *              zero padding to a multiple of 8 bytes
+ *     uint64   row count n
+ *     float64  ClusterSize[n]
+ *     int32    Cooldown[n], Threshold[n], Run[n], Iteration[n], InteractionCount[n]
+ *     int32    ConvergedIteration[n]   (version 2 only)
+ *
+ * Columns are written when the writer finishes, so they are buffered in memory
+ * (28 bytes per row) until then.
+ */
+class ResultsWriter {
+public:
+    /** @brief On-disk layout of the results */
+    enum class Format {
+        Csv,
+        Binary
+    };
+
+    /**
+     * @brief Open (truncate) the output file and start the writer thread
+     *
+     * @param filename  Output path
+     * @param format    CSV text or binary columnar layout
+     * @param metadata  Stored in the binary header; ignored for CSV
+     * @param convergenceColumn  Add a ConvergedIteration column (binary version 2)
+     */
+    explicit ResultsWriter(const std::string& filename, Format format = Format::Csv,
+        const std::string& metadata = "", bool convergenceColumn = false);
+    /** @brief Writes everything submitted so far and closes the file */
+    ~ResultsWriter();
+
+    ResultsWriter(const ResultsWriter&) = delete;
+    ResultsWriter& operator=(const ResultsWriter&) = delete;
+
+    /**
+     * @brief Hand over the complete rows of one run
+     *
+     * @param sequence  Position of the run in the output, starting at 0.
+     *                  Every position up to the last one must be submitted
+     *                  exactly once.
+     */
+    void submit(std::size_t sequence, std::vector<ResultRow> rows);
+
+    /**
+     * @brief Wait until every submitted run is written, then close the file
+     *
+     * Throws std::runtime_error if a write failed or a sequence position
+     * below the highest submitted one never arrived.
+     */
+    void finish();
+
+    /** @brief Parse "csv" or "binary"; throws std::invalid_argument otherwise */
+    static Format parseFormat(const std::string& name);
+
+private:
+    std::ofstream file;
+    Format format;
+    std::string metadata;
+    bool convergenceColumn;
+    // Binary columns, filled in sequence order by the writer thread.
+    std::vector<double> clusterSizes;
+    std::vector<std::int32_t> cooldowns;
+    std::vector<std::int32_t> thresholds;
+    std::vector<std::int32_t> runs;
+    std::vector<std::int32_t> iterations;
+    std::vector<std::int32_t> interactionCounts;
+    std::vector<std::int32_t> convergedIterations;
+    std::map<std::size_t, std::vector<ResultRow>> pending;
+    std::size_t nextSequence = 0;
+    bool finishing = false;
+    bool failed = false;
+
+    std::mutex mutex;
+    std::condition_variable ready;
+    std::thread writer;
+
+    void run();
+    void writeRows(const std::vector<ResultRow>& rows);
+    /** @brief Emit the binary header and columns */
+    void writeColumns();
+};
@@ -0,0 +1,137 @@
+#pragma once
+
+/**
+ * @file Rng.h
+ * @brief Seedable counter-based random number generator.
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @class CounterRng
+ * @brief SplitMix64 stream keyed by (seed, stream, counter).
+ *
+ * The starting state is a pure function of the key, so any ant can derive
+ * its own generator for a given step without shared state or locking, and a
+ * run is reproducible from its seed alone. Satisfies the standard
+ * UniformRandomBitGenerator requirements.
+ *
+ * uniform() and uniformInt() are defined here rather than relying on the
+ * standard distributions, whose algorithms differ between library vendors.
+ */
+class CounterRng {
+public:
+    using result_type = std::uint64_t;
+
+    /**
+     * @brief Construct the stream for a key
+     *
+     * @param seed     Global seed of the simulation
+     * @param stream   Independent stream id (e.g. phase and ant index)
+     * @param counter  Position within the stream family (e.g. step number)
+     */
+    explicit CounterRng(std::uint64_t seed = 0, std::uint64_t stream = 0, std::uint64_t counter = 0)
+        : state(key(seed, stream, counter)) {}
+
+    /** @brief Generator starting from a state returned by key() or CounterRngBlock */
+    static CounterRng fromState(std::uint64_t state) {
+        CounterRng gen;
+        gen.state = state;
+        return gen;
+    }
+
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return ~result_type(0); }
+
+    /** @brief Next 64 random bits */
+    result_type operator()() {
+        state += GAMMA;
+        return mix(state);
+    }
+
+    /** @brief Uniform double in [0, 1) with 53 bits of precision */
+    double uniform() {
+        return static_cast<double>((*this)() >> 11) * (1.0 / 9007199254740992.0);
+    }
+
+    /** @brief Uniform integer in [0, n) for n > 0 */
+    int uniformInt(int n) {
+        // Multiply-shift of the top 32 bits; exact for powers of two.
+        return static_cast<int>((((*this)() >> 32) * static_cast<std::uint64_t>(n)) >> 32);
+    }
+
+    /** @brief SplitMix64 finaliser */
+    static constexpr std::uint64_t mix(std::uint64_t z) {
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+        return z ^ (z >> 31);
+    }
+
+    /** @brief Hash a (seed, stream, counter) key into a 64-bit state */
+    static constexpr std::uint64_t key(std::uint64_t seed, std::uint64_t stream, std::uint64_t counter) {
+        return keyFromCounterHash(seed, stream, counterHash(counter));
+    }
+
+    /** @brief Part of key() that depends only on the counter */
+    static constexpr std::uint64_t counterHash(std::uint64_t counter) {
+        return mix(counter + GAMMA);
+    }
+
+    /** @brief key() given counterHash(counter) */
+    static constexpr std::uint64_t keyFromCounterHash(std::uint64_t seed, std::uint64_t stream, std::uint64_t hashed) {
+        return mix(seed ^ mix(stream ^ hashed));
+    }
+
+private:
+    static constexpr std::uint64_t GAMMA = 0x9e3779b97f4a7c15ULL;
+    std::uint64_t state;
+};
+
+/**
+ * @class CounterRngBlock
+ * @brief Starting states of the CounterRng streams of many entities at one counter.
+ *
+ * Entity i gets the stream (stream ^ i). prepare() hashes the shared counter
+ * once, and fill() derives the states of a range of entities in a single
+ * branch-free loop, so a step's ant loop can derive a block of states and
+ * then consume it. at(i) is exactly CounterRng(seed, stream ^ i, counter).
+ */
+class CounterRngBlock {
+public:
+    /** @brief Size the block for count entities at the given key; states are filled by fill() */
+    void prepare(std::uint64_t seed, std::uint64_t stream, std::uint64_t counter, std::size_t count) {
+        this->seed = seed;
+        this->stream = stream;
+        hashed = CounterRng::counterHash(counter);
+        states.resize(count);
+    }
+
+    /** @brief Derive the states of entities [begin, end) */
+    void fill(std::size_t begin, std::size_t end) {
+        std::uint64_t* out = states.data();
+        for (std::size_t i = begin; i < end; ++i) {
+            out[i] = CounterRng::keyFromCounterHash(seed, stream ^ i, hashed);
+        }
+    }
+    /** @brief Derive the states of slots [begin, end), slot i taking the stream of entity ids[i] */
+    void fill(std::size_t begin, std::size_t end, const std::uint32_t* ids) {
+        std::uint64_t* out = states.data();
+        for (std::size_t i = begin; i < end; ++i) {
+            out[i] = CounterRng::keyFromCounterHash(seed, stream ^ ids[i], hashed);
+        }
+    }
+    /** @brief Derive every state */
+    void fill() { fill(0, states.size()); }
+
+    std::size_t size() const { return states.size(); }
+    /** @brief Generator of entity i */
+    CounterRng at(std::size_t i) const { return CounterRng::fromState(states[i]); }
+
+private:
+    std::uint64_t seed = 0;
+    std::uint64_t stream = 0;
+    std::uint64_t hashed = 0;
+    std::vector<std::uint64_t> states;
+};
@@ -0,0 +1,92 @@
+#pragma once
+
+/**
+ * @file RunCheckpoint.h
+ * @brief Checkpoint files of single sweep runs.
+ */
+
+#include "ant_intelligence/ResultsWriter.h"
+#include <cstdint>
+#include <functional>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+class Ground;
+
+/**
+ * @struct RunIdentity
+ * @brief The seed of a run and every parameter its results depend on, besides its ground state
+ *
+ * Parameters are compared by position, so every writer must list them in
+ * the same order; the names are only used in error messages.
+ */
+struct RunIdentity {
+    std::uint64_t seed = 0;
+    std::vector<std::pair<const char*, double>> parameters;
+};
+
+/**
+ * @namespace RunCheckpoint
+ * @brief A Ground state followed by the progress of the run it belongs to.
+ *
+ * Any checkpoint can also seed other runs, which only read its ground state.
+ * The progress is little-endian:
+ *
+ *     char[8]  magic "ANTRUN2\0"
+ *     uint64   run seed
+ *     uint32   parameter count p, then float64 parameters[p]
+ *     int32    next iteration
+ *     uint64   row count n, then n times (int32 iteration, float64 cluster size, int32 interactions)
+ *
+ * Version 1 files ("ANTRUN1\0") have no seed and parameters; they can still
+ * seed runs but cannot be resumed.
+ *
+ * A finished run leaves a done record instead, so a resumed sweep can reuse
+ * its rows rather than run it again:
+ *
+ *     char[8]  magic "ANTDONE1"
+ *     uint64   run seed
+ *     uint32   parameter count p, then float64 parameters[p]
+ *     int32    converged iteration, or -1
+ *     uint64   row count n, then n times (int32 iteration, float64 cluster size, int32 interactions)
+ */
+namespace RunCheckpoint {
+    /**
+     * @brief Write a checkpoint through a temporary file, so a preempted write
+     *        never replaces the previous checkpoint with a truncated one
+     *
+     * @param writeState  Writes the ground in Ground::saveState() format
+     * Throws std::runtime_error if the file cannot be written.
+     */
+    void save(const std::string& filename, const std::function<void(std::ostream&)>& writeState,
+        const RunIdentity& identity, int nextIteration, const std::vector<ResultRow>& rows);
+
+    /**
+     * @brief Restore ground and progress from a checkpoint
+     *
+     * @param tag       Cooldown, threshold and run of the restored rows
+     * @param expected  Identity the checkpoint must have been written with, or null to accept any
+     * @return false if the file does not exist. Malformed files, and files of
+     *         another run than expected, throw std::runtime_error.
+     */
+    bool load(const std::string& filename, const ResultRow& tag, const RunIdentity* expected,
+        Ground& ground, int& nextIteration, std::vector<ResultRow>& rows);
+
+    /** @brief Write the done record of a finished run, the same way as save() */
+    void saveDone(const std::string& filename, const RunIdentity& identity, int convergedIteration,
+        const std::vector<ResultRow>& rows);
+
+    /**
+     * @brief Read the rows of a finished run, tagged like load() and with their converged iteration
+     *
+     * @return false if the file does not exist. Malformed records, and
+     *         records of another run than expected, throw std::runtime_error.
+     */
+    bool loadDone(const std::string& filename, const ResultRow& tag, const RunIdentity& expected,
+        std::vector<ResultRow>& rows);
+
+    /** @brief 64-bit FNV-1a hash of the ground's saveState() bytes, for identities of seeded runs */
+    std::uint64_t stateHash(const Ground& ground);
+}
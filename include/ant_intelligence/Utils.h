@@ -16,11 +16,12 @@
 struct pair_hash {
     template <class T1, class T2>
     std::size_t operator() (const std::pair<T1, T2>& pair) const {
-        // A simple and effective way to combine the hashes of the two pair elements.
         auto hash1 = std::hash<T1>{}(pair.first);
         auto hash2 = std::hash<T2>{}(pair.second);
 
-        // A common way to combine hashes to reduce collisions.
-        return hash1 ^ (hash2 << 1);
+        // FIX: A plain XOR (or XOR with a shift) maps (x, y) and (y, x) to
+        // nearby or identical buckets. Mix the second hash into the first
+        // boost::hash_combine style so the combination is order-sensitive.
+        return hash1 ^ (hash2 + static_cast<std::size_t>(0x9e3779b97f4a7c15ULL) + (hash1 << 6) + (hash1 >> 2));
     }
 };
@@ -0,0 +1,69 @@
+#pragma once
+
+/**
+ * @file VisitBitmap.h
+ * @brief One bit per grid cell recording which cells have been visited.
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @class VisitBitmap
+ * @brief Packed width x length set of visited cells.
+ *
+ * Replaces a hash set of positions: marking and querying a cell are a shift
+ * and a mask, and the whole grid costs width * length / 8 bytes no matter how
+ * long the path is. Cells are indexed y * width + x like Grid.
+ */
+class VisitBitmap {
+public:
+    /** @brief Construct a bitmap with no cells visited */
+    VisitBitmap(int width = 0, int length = 0);
+
+    int getWidth() const { return width; }
+    int getLength() const { return length; }
+
+    /** @brief Mark (x, y) as visited; returns true if it was not visited before. Off-grid cells are ignored. */
+    bool insert(int x, int y) {
+        if (!inBounds(x, y)) {
+            return false;
+        }
+        std::size_t cell = index(x, y);
+        std::uint64_t bit = std::uint64_t(1) << (cell & 63);
+        std::uint64_t& word = words[cell >> 6];
+        if (word & bit) {
+            return false;
+        }
+        word |= bit;
+        ++visited;
+        return true;
+    }
+    /** @brief Whether (x, y) has been visited */
+    bool contains(int x, int y) const {
+        if (!inBounds(x, y)) {
+            return false;
+        }
+        std::size_t cell = index(x, y);
+        return (words[cell >> 6] >> (cell & 63)) & 1;
+    }
+    /** @brief Number of distinct visited cells (O(1)) */
+    std::size_t size() const { return visited; }
+    bool empty() const { return visited == 0; }
+    /** @brief Forget every visit */
+    void clear();
+
+private:
+    int width;
+    int length;
+    std::vector<std::uint64_t> words;
+    std::size_t visited = 0;
+
+    bool inBounds(int x, int y) const {
+        return x >= 0 && x < width && y >= 0 && y < length;
+    }
+    std::size_t index(int x, int y) const {
+        return static_cast<std::size_t>(y) * static_cast<std::size_t>(width) + static_cast<std::size_t>(x);
+    }
+};
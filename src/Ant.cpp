@@ -1,55 +1,63 @@
 #include "ant_intelligence/Ant.h"
 #include "ant_intelligence/Objects.h"
 #include "ant_intelligence/Config.h"
+#include "ant_intelligence/Neighborhood.h"
 #include <algorithm>
 #include <random>
 #include <chrono>
 #include <cstdlib>
 
-Ant::Ant(std::pair<int, int> position, int width, int length, bool recordPath, int memorySize)
+Ant::Ant(std::pair<int, int> position, int width, int length, bool recordPath, int memorySize, int initialDirection)
     : position(position)
     , width(width)
     , length(length)
-    , prevDirection(0)
-    , load(nullptr)
+    , prevDirection(initialDirection)
+    , load(AIConfig::ObjectType::None)
     , recordPath(recordPath)
+    , visitedPositions(recordPath ? VisitBitmap(width, length) : VisitBitmap())
     , interactionCooldown(0)
     , memorySize(memorySize) // Initialize the memory size
+    , memory(memorySize)
 {
-    // Initialize the movement dictionary
-    updateMovementDict();
-    // Get a random initial direction
-    prevDirection = getRandomDirection();
 }
 
 void Ant::move(
-    const std::unordered_map<std::pair<int, int>, std::vector<std::pair<int, int>>, pair_hash>& possiblePositions,
-    const std::vector<double>& probabilities,
-    std::mt19937& gen // Accept the generator by reference
+    const DirectionSampler& sampler,
+    CounterRng& gen // Accept the generator by reference
 ) {
-    if (possiblePositions.find(position) != possiblePositions.end()) {
-        auto& nextStepsList = possiblePositions.at(position);
-        if (nextStepsList.size() == AIConfig::NUM_DIRECTIONS) {
-            int newDirection = getRandomWeightedDirection(probabilities, prevDirection);
-            auto dx_dy = movementDict[newDirection];
-            position.first += dx_dy.first;
-            position.second += dx_dy.second;
-            prevDirection = newDirection;
+    if (position.first >= 0 && position.first < width && position.second >= 0 && position.second < length) {
+        moveStep(position, prevDirection, width, length, sampler, gen);
+        if (recordPath) {
+            visitedPositions.insert(position.first, position.second);
         }
-        else {
-            auto prevPosition = position;
-            std::uniform_int_distribution<> distrib(0, static_cast<int>(nextStepsList.size() - 1));
-            position = nextStepsList[distrib(gen)];
-
-            auto dx = position.first - prevPosition.first;
-            auto dy = position.second - prevPosition.second;
+    }
+}
 
-            if (invMovementDict.count({ dx, dy })) {
-                prevDirection = invMovementDict.at(std::make_pair(dx, dy));
-            }
-        }
-        if (recordPath) {
-            visitedPositions.insert(position);
+void Ant::moveStep(
+    std::pair<int, int>& position,
+    int& prevDirection,
+    int width,
+    int length,
+    const DirectionSampler& sampler,
+    CounterRng& gen
+) {
+    // OPTIMIZATION: Neighbours come from the constant offset tables; only
+    // cells on the grid border need a bounds mask.
+    if (Neighborhood::isInterior(position.first, position.second, width, length)) {
+        // OPTIMIZATION: O(1) alias-table draw instead of building a
+        // rotated discrete_distribution for every step.
+        int newDirection = sampler.sample(prevDirection, gen);
+        position.first += AIConfig::DIRECTION_DX[newDirection];
+        position.second += AIConfig::DIRECTION_DY[newDirection];
+        prevDirection = newDirection;
+    }
+    else {
+        int mask = Neighborhood::validMask(position.first, position.second, width, length);
+        int direction = Neighborhood::nthValidDirection(mask, gen.uniformInt(Neighborhood::countMask(mask)));
+        if (direction >= 0) {
+            position.first += AIConfig::DIRECTION_DX[direction];
+            position.second += AIConfig::DIRECTION_DY[direction];
+            prevDirection = direction;
         }
     }
 }
@@ -63,24 +71,31 @@ void Ant::setPosition(std::pair<int, int> new_position) {
 }
 
 
-std::shared_ptr<Object> Ant::getLoad() const {
+AIConfig::ObjectType Ant::getLoad() const {
     return load;
 }
 
-void Ant::setLoad(std::shared_ptr<Object> newLoad) {
+void Ant::setLoad(AIConfig::ObjectType newLoad) {
     load = newLoad;
 }
 
-const std::unordered_set<std::pair<int, int>, pair_hash>& Ant::getVisitedPositions() const {
+void Ant::setLoad(const std::shared_ptr<Object>& newLoad) {
+    load = objectTypeOf(newLoad);
+}
+
+const VisitBitmap& Ant::getVisitedPositions() const {
     return visitedPositions;
 }
 
 void Ant::setRecordPath(bool record) {
     recordPath = record;
+    if (record && (visitedPositions.getWidth() != width || visitedPositions.getLength() != length)) {
+        visitedPositions = VisitBitmap(width, length);
+    }
 }
 
-const std::deque<int>& Ant::getMemory() const {
-    return memory;
+std::deque<int> Ant::getMemory() const {
+    return memory.toDeque();
 }
 
 int Ant::getInteractionCooldown() const {
@@ -99,73 +114,27 @@ void Ant::setPrevDirection(int newDir) {
     prevDirection = newDir;
 }
 
-void Ant::updateMovementDict() {
-    movementDict = {
-        {static_cast<int>(AIConfig::Direction::North),      { 0, -1}},
-        {static_cast<int>(AIConfig::Direction::NorthEast),  { 1, -1}},
-        {static_cast<int>(AIConfig::Direction::East),       { 1,  0}},
-        {static_cast<int>(AIConfig::Direction::SouthEast),  { 1,  1}},
-        {static_cast<int>(AIConfig::Direction::South),      { 0,  1}},
-        {static_cast<int>(AIConfig::Direction::SouthWest),  {-1,  1}},
-        {static_cast<int>(AIConfig::Direction::West),       {-1,  0}},
-        {static_cast<int>(AIConfig::Direction::NorthWest),  {-1, -1}}
-    };
-    invMovementDict.clear();
-    for (const auto& kv : movementDict) {
-        invMovementDict[kv.second] = kv.first;
-    }
-}
-
-int Ant::getRandomDirection() {
-    // FIX: Made the random number generator thread-local for safety in parallel execution.
-    thread_local static std::random_device rd;
-    thread_local static std::mt19937 gen(rd());
-    std::uniform_int_distribution<> dis(
-        0,
-        static_cast<int>(AIConfig::Direction::NorthWest));
-    return dis(gen);
-}
-
-int Ant::getRandomWeightedDirection(const std::vector<double>& probabilities, int prevDirection) {
+int Ant::getRandomWeightedDirection(const std::vector<double>& probabilities, int prevDirection, CounterRng& gen) {
     std::vector<double> shifted(probabilities);
     int size = static_cast<int>(probabilities.size());
     int n = prevDirection % size;
     std::rotate(shifted.rbegin(), shifted.rbegin() + n, shifted.rend());
-    // FIX: Made the random number generator thread-local for safety in parallel execution.
-    thread_local static std::random_device rd;
-    thread_local static std::mt19937 gen(rd());
     std::discrete_distribution<> distribution(shifted.begin(), shifted.end());
     return distribution(gen);
 }
 
-void Ant::updateMemory(std::shared_ptr<Object> seenObject) {
-    if (!seenObject) {
-        return;
-    }
-    AIConfig::ObjectType objectType = AIConfig::ObjectType::None;
-    if (std::dynamic_pointer_cast<Food>(seenObject)) {
-        objectType = AIConfig::ObjectType::Food;
-    }
-    else if (std::dynamic_pointer_cast<Waste>(seenObject)) {
-        objectType = AIConfig::ObjectType::Waste;
-    }
-    else if (std::dynamic_pointer_cast<Egg>(seenObject)) {
-        objectType = AIConfig::ObjectType::Egg;
-    }
-    if (objectType != AIConfig::ObjectType::None) {
-        int objectTypeInt = static_cast<int>(objectType);
+void Ant::updateMemory(AIConfig::ObjectType seenType) {
+    memory.push(seenType);
+}
 
-        if (memory.size() >= memorySize) {
-            memory.pop_front();
-        }
-        memory.push_back(objectTypeInt);
-    }
+void Ant::updateMemory(const std::shared_ptr<Object>& seenObject) {
+    updateMemory(objectTypeOf(seenObject));
 }
 
 std::string Ant::getMemoryString() const {
     std::stringstream ss;
-    for (int mem : memory) {
-        ss << mem << ",";
+    for (int k = 0; k < memory.size(); ++k) {
+        ss << memory.at(k) << ",";
     }
     return ss.str();
 }
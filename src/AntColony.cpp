@@ -0,0 +1,245 @@
+#include "ant_intelligence/AntColony.h"
+#include "ant_intelligence/BinaryIO.h"
+#include <algorithm>
+#include <stdexcept>
+
+void AntColony::reserve(std::size_t count) {
+    ids.reserve(count);
+    xs.reserve(count);
+    ys.reserve(count);
+    prevDirections.reserve(count);
+    loads.reserve(count);
+    cooldowns.reserve(count);
+    memory.reserve(count * static_cast<std::size_t>(stride));
+    memoryHead.reserve(count);
+    memoryCount.reserve(count);
+    memoryCapacity.reserve(count);
+    memoryTypeCounts.reserve(count * AIConfig::NUM_OBJECT_TYPES);
+}
+
+std::size_t AntColony::add(int x, int y, int prevDirection, int memorySize) {
+    if (memorySize < 0 || memorySize > UINT16_MAX) {
+        throw std::invalid_argument("Invalid ant memory size");
+    }
+    if (memorySize > stride) {
+        restride(memorySize);
+    }
+    uniformCapacity = uniformCapacity && memorySize == stride;
+
+    // Ids stay a permutation of the indices, so the next free id is the size.
+    ids.push_back(static_cast<std::uint32_t>(xs.size()));
+    xs.push_back(x);
+    ys.push_back(y);
+    prevDirections.push_back(static_cast<std::uint8_t>(prevDirection));
+    loads.push_back(static_cast<std::uint8_t>(AIConfig::ObjectType::None));
+    cooldowns.push_back(0);
+    memory.resize(memory.size() + stride, static_cast<std::uint8_t>(AIConfig::ObjectType::None));
+    memoryHead.push_back(0);
+    memoryCount.push_back(0);
+    memoryCapacity.push_back(static_cast<std::uint16_t>(memorySize));
+    memoryTypeCounts.resize(memoryTypeCounts.size() + AIConfig::NUM_OBJECT_TYPES, 0);
+    return xs.size() - 1;
+}
+
+std::deque<int> AntColony::getMemory(std::size_t i) const {
+    std::deque<int> result;
+    const std::uint8_t* ring = &memory[i * stride];
+    int capacity = memoryCapacity[i];
+    for (int k = 0; k < memoryCount[i]; ++k) {
+        result.push_back(ring[(memoryHead[i] + k) % capacity]);
+    }
+    return result;
+}
+
+void AntColony::restride(int newStride) {
+    std::vector<std::uint8_t> grown(xs.size() * static_cast<std::size_t>(newStride),
+        static_cast<std::uint8_t>(AIConfig::ObjectType::None));
+    for (std::size_t i = 0; i < xs.size(); ++i) {
+        std::copy(memory.begin() + i * stride, memory.begin() + (i + 1) * stride,
+            grown.begin() + i * newStride);
+    }
+    memory.swap(grown);
+    stride = newStride;
+    // Ants already present keep their smaller capacity.
+    uniformCapacity = xs.empty();
+}
+
+namespace {
+    // Rows order[0], order[1], ... of values, width entries per row
+    template <typename T>
+    void selectRows(std::vector<T>& values, const std::vector<std::uint32_t>& order, std::size_t width) {
+        std::vector<T> selected(order.size() * width);
+        for (std::size_t k = 0; k < order.size(); ++k) {
+            std::copy(values.begin() + order[k] * width, values.begin() + (order[k] + 1) * width,
+                selected.begin() + k * width);
+        }
+        values.swap(selected);
+    }
+}
+
+void AntColony::select(const std::vector<std::uint32_t>& order) {
+    selectRows(ids, order, 1);
+    selectRows(xs, order, 1);
+    selectRows(ys, order, 1);
+    selectRows(prevDirections, order, 1);
+    selectRows(loads, order, 1);
+    selectRows(cooldowns, order, 1);
+    selectRows(memory, order, static_cast<std::size_t>(stride));
+    selectRows(memoryHead, order, 1);
+    selectRows(memoryCount, order, 1);
+    selectRows(memoryCapacity, order, 1);
+    selectRows(memoryTypeCounts, order, AIConfig::NUM_OBJECT_TYPES);
+}
+
+void AntColony::permute(const std::vector<std::uint32_t>& order) {
+    if (order.size() != xs.size()) {
+        throw std::invalid_argument("Permutation does not match the colony size");
+    }
+    select(order);
+}
+
+void AntColony::remove(const std::vector<bool>& gone) {
+    std::vector<std::uint32_t> kept;
+    kept.reserve(xs.size());
+    for (std::size_t i = 0; i < xs.size(); ++i) {
+        if (!gone[i]) {
+            kept.push_back(static_cast<std::uint32_t>(i));
+        }
+    }
+    if (kept.size() == xs.size()) {
+        return;
+    }
+    select(kept);
+    uniformCapacity = std::all_of(memoryCapacity.begin(), memoryCapacity.end(),
+        [&](std::uint16_t capacity) { return capacity == stride; });
+}
+
+void AntColony::saveAnt(std::size_t i, std::ostream& out) const {
+    const int capacity = memoryCapacity[i];
+    BinaryIO::write<std::uint32_t>(out, ids[i]);
+    BinaryIO::write<std::int32_t>(out, xs[i]);
+    BinaryIO::write<std::int32_t>(out, ys[i]);
+    BinaryIO::write<std::uint8_t>(out, prevDirections[i]);
+    BinaryIO::write<std::uint8_t>(out, loads[i]);
+    BinaryIO::write<std::int32_t>(out, cooldowns[i]);
+    BinaryIO::write<std::uint16_t>(out, memoryHead[i]);
+    BinaryIO::write<std::uint16_t>(out, memoryCount[i]);
+    BinaryIO::write<std::uint16_t>(out, memoryCapacity[i]);
+    for (int t = 0; t < AIConfig::NUM_OBJECT_TYPES; ++t) {
+        BinaryIO::write<std::uint16_t>(out, memoryTypeCounts[i * AIConfig::NUM_OBJECT_TYPES + t]);
+    }
+    out.write(reinterpret_cast<const char*>(&memory[i * stride]), capacity);
+}
+
+std::size_t AntColony::loadAnt(std::istream& in) {
+    std::uint32_t id = BinaryIO::read<std::uint32_t>(in);
+    int x = BinaryIO::read<std::int32_t>(in);
+    int y = BinaryIO::read<std::int32_t>(in);
+    std::uint8_t prevDirection = BinaryIO::read<std::uint8_t>(in);
+    std::uint8_t load = BinaryIO::read<std::uint8_t>(in);
+    int cooldown = BinaryIO::read<std::int32_t>(in);
+    std::uint16_t head = BinaryIO::read<std::uint16_t>(in);
+    std::uint16_t count = BinaryIO::read<std::uint16_t>(in);
+    std::uint16_t capacity = BinaryIO::read<std::uint16_t>(in);
+    std::uint16_t typeCounts[AIConfig::NUM_OBJECT_TYPES];
+    for (auto& c : typeCounts) {
+        c = BinaryIO::read<std::uint16_t>(in);
+    }
+    // The stored counters are only read past; recountMemory() rebuilds them.
+    std::vector<char> ring(capacity);
+    BinaryIO::readBytes(in, ring.data(), ring.size());
+    const bool ringValid = std::all_of(ring.begin(), ring.end(),
+        [](char type) { return static_cast<std::uint8_t>(type) < AIConfig::NUM_OBJECT_TYPES; });
+    if (prevDirection >= AIConfig::NUM_DIRECTIONS || load >= AIConfig::NUM_OBJECT_TYPES
+        || count > capacity || (capacity > 0 && head >= capacity) || !ringValid) {
+        throw std::runtime_error("Corrupt ant data");
+    }
+
+    std::size_t i = add(x, y, prevDirection, capacity);
+    ids[i] = id;
+    loads[i] = load;
+    cooldowns[i] = cooldown;
+    memoryHead[i] = head;
+    memoryCount[i] = count;
+    std::copy(ring.begin(), ring.end(), &memory[i * stride]);
+    recountMemory(i);
+    return i;
+}
+
+void AntColony::recountMemory(std::size_t i) {
+    std::uint16_t* counts = &memoryTypeCounts[i * AIConfig::NUM_OBJECT_TYPES];
+    std::fill(counts, counts + AIConfig::NUM_OBJECT_TYPES, 0);
+    const std::uint8_t* ring = &memory[i * stride];
+    const int capacity = memoryCapacity[i];
+    for (int k = 0; k < memoryCount[i]; ++k) {
+        ++counts[ring[(memoryHead[i] + k) % capacity]];
+    }
+}
+
+void AntColony::save(std::ostream& out) const {
+    BinaryIO::write<std::uint64_t>(out, xs.size());
+    BinaryIO::write<std::uint32_t>(out, static_cast<std::uint32_t>(stride));
+    BinaryIO::writeArray(out, xs);
+    BinaryIO::writeArray(out, ys);
+    BinaryIO::writeArray(out, prevDirections);
+    BinaryIO::writeArray(out, loads);
+    BinaryIO::writeArray(out, cooldowns);
+    BinaryIO::writeArray(out, memoryHead);
+    BinaryIO::writeArray(out, memoryCount);
+    BinaryIO::writeArray(out, memoryCapacity);
+    BinaryIO::writeArray(out, memoryTypeCounts);
+    BinaryIO::writeArray(out, memory);
+    BinaryIO::writeArray(out, ids);
+}
+
+void AntColony::load(std::istream& in, bool withIds) {
+    std::uint64_t count = BinaryIO::read<std::uint64_t>(in);
+    std::uint32_t newStride = BinaryIO::read<std::uint32_t>(in);
+    if (newStride > UINT16_MAX || count > (1ULL << 32)) {
+        throw std::runtime_error("Corrupt ant colony data");
+    }
+    const std::size_t n = static_cast<std::size_t>(count);
+    BinaryIO::readArray(in, n, xs);
+    BinaryIO::readArray(in, n, ys);
+    BinaryIO::readArray(in, n, prevDirections);
+    BinaryIO::readArray(in, n, loads);
+    BinaryIO::readArray(in, n, cooldowns);
+    BinaryIO::readArray(in, n, memoryHead);
+    BinaryIO::readArray(in, n, memoryCount);
+    BinaryIO::readArray(in, n, memoryCapacity);
+    BinaryIO::readArray(in, n * AIConfig::NUM_OBJECT_TYPES, memoryTypeCounts);
+    BinaryIO::readArray(in, n * newStride, memory);
+    if (withIds) {
+        BinaryIO::readArray(in, n, ids);
+    }
+    else {
+        ids.resize(n);
+        for (std::size_t i = 0; i < n; ++i) {
+            ids[i] = static_cast<std::uint32_t>(i);
+        }
+    }
+    stride = static_cast<int>(newStride);
+    uniformCapacity = true;
+
+    for (std::size_t i = 0; i < n; ++i) {
+        uniformCapacity = uniformCapacity && memoryCapacity[i] == stride;
+        if (memoryCapacity[i] > stride || memoryCount[i] > memoryCapacity[i]
+            || (memoryCapacity[i] > 0 && memoryHead[i] >= memoryCapacity[i])
+            || prevDirections[i] >= AIConfig::NUM_DIRECTIONS || loads[i] >= AIConfig::NUM_OBJECT_TYPES) {
+            throw std::runtime_error("Corrupt ant colony data");
+        }
+        const std::uint8_t* ring = &memory[i * stride];
+        if (!std::all_of(ring, ring + memoryCapacity[i],
+            [](std::uint8_t type) { return type < AIConfig::NUM_OBJECT_TYPES; })) {
+            throw std::runtime_error("Corrupt ant colony data");
+        }
+        recountMemory(i);
+    }
+    std::vector<bool> seen(n, false);
+    for (std::uint32_t id : ids) {
+        if (id >= n || seen[id]) {
+            throw std::runtime_error("Corrupt ant colony data");
+        }
+        seen[id] = true;
+    }
+}
@@ -0,0 +1,33 @@
+#include "ant_intelligence/CellIndex.h"
+
+CellIndex::CellIndex(int width, int length)
+    : width(width > 0 ? width : 0)
+    , length(length > 0 ? length : 0)
+    , head(static_cast<std::size_t>(this->width) * static_cast<std::size_t>(this->length), -1)
+{
+}
+
+void CellIndex::rebuild(const AntColony& colony) {
+    for (int cell : antCell) {
+        head[cell] = -1;
+    }
+
+    const int count = static_cast<int>(colony.size());
+    nextAnt.resize(count);
+    antCell.resize(count);
+    // Prepending in descending order leaves every list sorted ascending.
+    for (int i = count - 1; i >= 0; --i) {
+        int cell = colony.getY(i) * width + colony.getX(i);
+        antCell[i] = cell;
+        nextAnt[i] = head[cell];
+        head[cell] = i;
+    }
+}
+
+int CellIndex::countAt(int x, int y) const {
+    int count = 0;
+    for (int j = first(x, y); j != -1; j = nextAnt[j]) {
+        ++count;
+    }
+    return count;
+}
@@ -0,0 +1,207 @@
+#include "ant_intelligence/ClusterTracker.h"
+#include <array>
+#include <cstdint>
+#include <utility>
+
+namespace {
+    // Number of 8-connected groups formed by the occupied cells of the ring of
+    // eight neighbours around a cell, indexed by a bitmask in direction order.
+    // Edge neighbours touch the ring cells one and two steps away, corner
+    // neighbours only the adjacent ones.
+    std::array<std::uint8_t, 256> buildRingGroups() {
+        std::array<std::uint8_t, 256> table{};
+        for (int mask = 0; mask < 256; ++mask) {
+            int seen = 0;
+            int groups = 0;
+            for (int start = 0; start < AIConfig::NUM_DIRECTIONS; ++start) {
+                if (!(mask & (1 << start)) || (seen & (1 << start))) {
+                    continue;
+                }
+                ++groups;
+                int stack[AIConfig::NUM_DIRECTIONS];
+                int top = 0;
+                stack[top++] = start;
+                seen |= 1 << start;
+                while (top > 0) {
+                    int d = stack[--top];
+                    for (int step = 1; step <= 7; ++step) {
+                        int e = (d + step) % AIConfig::NUM_DIRECTIONS;
+                        int ex = AIConfig::DIRECTION_DX[e] - AIConfig::DIRECTION_DX[d];
+                        int ey = AIConfig::DIRECTION_DY[e] - AIConfig::DIRECTION_DY[d];
+                        bool adjacent = ex >= -1 && ex <= 1 && ey >= -1 && ey <= 1;
+                        if (adjacent && (mask & (1 << e)) && !(seen & (1 << e))) {
+                            seen |= 1 << e;
+                            stack[top++] = e;
+                        }
+                    }
+                }
+            }
+            table[mask] = static_cast<std::uint8_t>(groups);
+        }
+        return table;
+    }
+
+    const std::array<std::uint8_t, 256> RING_GROUPS = buildRingGroups();
+}
+
+ClusterTracker::ClusterTracker(int width, int length)
+    : width(width > 0 ? width : 0)
+    , length(length > 0 ? length : 0)
+{
+}
+
+int ClusterTracker::find(int node) {
+    while (parent[node] != node) {
+        parent[node] = parent[parent[node]];
+        node = parent[node];
+    }
+    return node;
+}
+
+bool ClusterTracker::unite(int a, int b) {
+    a = find(a);
+    b = find(b);
+    if (a == b) {
+        return false;
+    }
+    if (clusterSize[a] < clusterSize[b]) {
+        std::swap(a, b);
+    }
+    parent[b] = a;
+    clusterSize[a] += clusterSize[b];
+    return true;
+}
+
+int ClusterTracker::makeNode(std::size_t cell) {
+    int node = static_cast<int>(parent.size());
+    parent.push_back(node);
+    clusterSize.push_back(1);
+    cellNode[cell] = node;
+    return node;
+}
+
+void ClusterTracker::rebuild(const Grid& grid) {
+    const std::size_t cells = static_cast<std::size_t>(width) * length;
+    cellNode.assign(cells, -1);
+    parent.clear();
+    clusterSize.clear();
+    parent.reserve(cells);
+    clusterSize.reserve(cells);
+    objects = 0;
+    clusters = 0;
+
+    const std::uint8_t* types = grid.data();
+    if (grid.getLayout() != AIConfig::GridLayout::RowMajor) {
+        rowMajor.resize(cells);
+        grid.exportRowMajor(rowMajor.data());
+        types = rowMajor.data();
+    }
+    const std::uint8_t none = static_cast<std::uint8_t>(AIConfig::ObjectType::None);
+    // Scanline labelling: join each object with its W, NW, N and NE neighbours,
+    // the ones already visited in row-major order.
+    const int dx[4] = { -1, -1, 0, 1 };
+    const int dy[4] = { 0, -1, -1, -1 };
+    for (int y = 0; y < length; ++y) {
+        for (int x = 0; x < width; ++x) {
+            std::size_t cell = static_cast<std::size_t>(y) * width + x;
+            std::uint8_t type = types[cell];
+            if (type == none) {
+                continue;
+            }
+            int node = makeNode(cell);
+            ++objects;
+            ++clusters;
+            for (int k = 0; k < 4; ++k) {
+                int nx = x + dx[k];
+                int ny = y + dy[k];
+                if (nx < 0 || nx >= width || ny < 0) {
+                    continue;
+                }
+                std::size_t neighbor = static_cast<std::size_t>(ny) * width + nx;
+                if (types[neighbor] == type && unite(node, cellNode[neighbor])) {
+                    --clusters;
+                }
+            }
+        }
+    }
+    dirty = false;
+}
+
+void ClusterTracker::update(const Grid& grid, int x, int y, AIConfig::ObjectType oldType) {
+    AIConfig::ObjectType newType = grid.get(x, y);
+    if (dirty || newType == oldType) {
+        return;
+    }
+
+    const std::size_t cell = cellId(x, y);
+    if (oldType != AIConfig::ObjectType::None) {
+        int ring = 0;
+        for (int d = 0; d < AIConfig::NUM_DIRECTIONS; ++d) {
+            int nx = x + AIConfig::DIRECTION_DX[d];
+            int ny = y + AIConfig::DIRECTION_DY[d];
+            if (grid.inBounds(nx, ny) && grid.get(nx, ny) == oldType) {
+                ring |= 1 << d;
+            }
+        }
+        int groups = RING_GROUPS[ring];
+        if (groups > 1) {
+            // The neighbours may only have been connected through this cell.
+            dirty = true;
+            return;
+        }
+        --objects;
+        if (groups == 0) {
+            --clusters;
+        }
+        --clusterSize[find(cellNode[cell])];
+        cellNode[cell] = -1;
+    }
+
+    if (newType != AIConfig::ObjectType::None) {
+        // Abandoned nodes pile up on busy grids; compact once they dominate.
+        if (parent.size() >= 2 * cellNode.size() + 64) {
+            dirty = true;
+            return;
+        }
+        int node = makeNode(cell);
+        ++objects;
+        ++clusters;
+        for (int d = 0; d < AIConfig::NUM_DIRECTIONS; ++d) {
+            int nx = x + AIConfig::DIRECTION_DX[d];
+            int ny = y + AIConfig::DIRECTION_DY[d];
+            if (grid.inBounds(nx, ny) && grid.get(nx, ny) == newType
+                && unite(node, cellNode[cellId(nx, ny)])) {
+                --clusters;
+            }
+        }
+    }
+}
+
+double ClusterTracker::averageSize(const Grid& grid) {
+    if (dirty) {
+        rebuild(grid);
+    }
+    return clusters == 0 ? 0.0 : static_cast<double>(objects) / clusters;
+}
+
+std::size_t ClusterTracker::clusterCount(const Grid& grid) {
+    if (dirty) {
+        rebuild(grid);
+    }
+    return clusters;
+}
+
+std::size_t ClusterTracker::objectCount(const Grid& grid) {
+    if (dirty) {
+        rebuild(grid);
+    }
+    return objects;
+}
+
+int ClusterTracker::clusterOf(const Grid& grid, int x, int y) {
+    if (dirty) {
+        rebuild(grid);
+    }
+    int node = cellNode[cellId(x, y)];
+    return node < 0 ? -1 : find(node);
+}
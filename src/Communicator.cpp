@@ -0,0 +1,127 @@
+#include "ant_intelligence/Communicator.h"
+#include "ant_intelligence/BinaryIO.h"
+#include <stdexcept>
+
+void Communicator::exchangeNeighbors(const Buffer& toPrev, const Buffer& toNext, Buffer& fromPrev, Buffer& fromNext) {
+    // Sends never block, so posting both before receiving cannot deadlock.
+    const int prev = rank() - 1;
+    const int next = rank() + 1;
+    if (prev >= 0) {
+        send(prev, toPrev);
+    }
+    if (next < size()) {
+        send(next, toNext);
+    }
+    fromPrev.clear();
+    fromNext.clear();
+    if (prev >= 0) {
+        recv(prev, fromPrev);
+    }
+    if (next < size()) {
+        recv(next, fromNext);
+    }
+}
+
+void Communicator::allreduceSum(std::vector<std::int64_t>& values) {
+    Buffer local(values.size() * sizeof(std::int64_t));
+    BinaryIO::encode(values.data(), values.size(), reinterpret_cast<char*>(local.data()));
+    std::vector<Buffer> all;
+    gather(local, all, 0);
+    Buffer total;
+    if (rank() == 0) {
+        std::vector<std::int64_t> sum(values.size(), 0);
+        std::vector<std::int64_t> part(values.size());
+        for (const Buffer& buffer : all) {
+            if (buffer.size() != local.size()) {
+                throw std::runtime_error("Mismatched allreduce sizes");
+            }
+            BinaryIO::decode(reinterpret_cast<const char*>(buffer.data()), part.size(), part.data());
+            for (std::size_t k = 0; k < sum.size(); ++k) {
+                sum[k] += part[k];
+            }
+        }
+        total.resize(local.size());
+        BinaryIO::encode(sum.data(), sum.size(), reinterpret_cast<char*>(total.data()));
+    }
+    broadcast(total, 0);
+    BinaryIO::decode(reinterpret_cast<const char*>(total.data()), values.size(), values.data());
+}
+
+void Communicator::gather(const Buffer& local, std::vector<Buffer>& all, int root) {
+    all.clear();
+    if (rank() != root) {
+        send(root, local);
+        return;
+    }
+    all.resize(size());
+    for (int r = 0; r < size(); ++r) {
+        if (r == root) {
+            all[r] = local;
+        }
+        else {
+            recv(r, all[r]);
+        }
+    }
+}
+
+void Communicator::broadcast(Buffer& data, int root) {
+    if (rank() == root) {
+        for (int r = 0; r < size(); ++r) {
+            if (r != root) {
+                send(r, data);
+            }
+        }
+    }
+    else {
+        recv(root, data);
+    }
+}
+
+void SelfCommunicator::send(int destination, const Buffer& message) {
+    if (destination != 0) {
+        throw std::out_of_range("SelfCommunicator has only rank 0");
+    }
+    queue.push_back(message);
+}
+
+void SelfCommunicator::recv(int source, Buffer& message) {
+    if (source != 0 || queue.empty()) {
+        throw std::runtime_error("SelfCommunicator has no message to receive");
+    }
+    message = std::move(queue.front());
+    queue.pop_front();
+}
+
+InProcessWorld::InProcessWorld(int ranks)
+    : ranks(ranks)
+{
+    if (ranks <= 0) {
+        throw std::invalid_argument("An in-process world needs at least one rank");
+    }
+    for (int r = 0; r < ranks; ++r) {
+        members.push_back(std::make_unique<InProcessCommunicator>(*this, r));
+    }
+}
+
+InProcessCommunicator& InProcessWorld::communicator(int rank) {
+    return *members.at(static_cast<std::size_t>(rank));
+}
+
+void InProcessCommunicator::send(int destination, const Buffer& message) {
+    if (destination < 0 || destination >= world.size()) {
+        throw std::out_of_range("No such rank");
+    }
+    {
+        std::lock_guard<std::mutex> lock(world.mutex);
+        world.mailboxes[{ ownRank, destination }].push_back(message);
+    }
+    world.arrived.notify_all();
+}
+
+void InProcessCommunicator::recv(int source, Buffer& message) {
+    std::unique_lock<std::mutex> lock(world.mutex);
+    auto& box = world.mailboxes[{ source, ownRank }];
+    world.arrived.wait(lock, [&]() { return !box.empty(); });
+    message = std::move(box.front());
+    box.pop_front();
+}
@@ -14,22 +14,39 @@
 #define NOMINMAX
 
 #include "ant_intelligence/Ant.h"
+#include "ant_intelligence/BinaryIO.h"
+#include "ant_intelligence/Communicator.h"
 #include "ant_intelligence/Config.h"
+#include "ant_intelligence/ConvergenceDetector.h"
+#include "ant_intelligence/DeviceGround.h"
+#include "ant_intelligence/DistributedGround.h"
+#include "ant_intelligence/DistributedRun.h"
+#include "ant_intelligence/FramePipeline.h"
 #include "ant_intelligence/Ground.h"
+#include "ant_intelligence/MetricsStream.h"
+#include "ant_intelligence/MpiCommunicator.h"
 #include "ant_intelligence/Objects.h"
+#include "ant_intelligence/Profiling.h"
+#include "ant_intelligence/ReplicaBatch.h"
+#include "ant_intelligence/ResultsWriter.h"
+#include "ant_intelligence/Rng.h"
+#include "ant_intelligence/RunCheckpoint.h"
 #include <iostream>
 #include <fstream>
 #include <vector>
 #include <string>
 #include <chrono>
 #include <numeric>
+#include <algorithm>
+#include <cmath>
 #include <cstdlib>
+#include <functional>
 #include <memory>
 #include <map>
 #include <stdexcept>
 #include <omp.h>
 #include <sstream>
-#include <cstdio> // Added for the remove() function
+#include <cstdio>
 
 #ifdef _WIN32
 #include <windows.h>
@@ -48,6 +65,7 @@ struct SimParameters {
     int num_experiments = AIConfig::DEFAULT_NUM_EXPERIMENTS;
     int num_iterations = AIConfig::DEFAULT_ITERATIONS;
     int memory_size = AIConfig::DEFAULT_MEMORY_SIZE;
+    int sample_interval = AIConfig::DEFAULT_SAMPLE_INTERVAL;
     int threshold_start = AIConfig::DEFAULT_THRESHOLD_START;
     int threshold_end = AIConfig::DEFAULT_THRESHOLD_END;
     int threshold_interval = AIConfig::DEFAULT_THRESHOLD_INTERVAL;
@@ -56,9 +74,55 @@ struct SimParameters {
     int cooldown_interval = AIConfig::DEFAULT_COOLDOWN_INTERVAL;
     std::vector<double> prob_relu = { AIConfig::DEFAULT_PROB_RELU[0], AIConfig::DEFAULT_PROB_RELU[1] };
     bool enable_visual = AIConfig::DEFAULT_VIDEO_ENABLED;
+    bool video_window = AIConfig::DEFAULT_VIDEO_WINDOW;
+    int video_stride = AIConfig::DEFAULT_VIDEO_STRIDE;
+    double video_duration = 0.0; // Target length in seconds; 0 keeps video_stride
+    int video_scale = AIConfig::DEFAULT_VIDEO_SCALE;
     std::string csv_filename = "ground_data.csv";
+    ResultsWriter::Format output_format = ResultsWriter::Format::Csv;
+    unsigned long long seed = AIConfig::DEFAULT_SEED;
+    bool parallel_step = AIConfig::DEFAULT_PARALLEL_STEP;
+    bool fused_step = AIConfig::DEFAULT_FUSED_STEP;
+    bool record_path = AIConfig::DEFAULT_RECORD_PATH;
+    AIConfig::NeighborhoodType neighborhood = AIConfig::DEFAULT_NEIGHBORHOOD;
+    AIConfig::GridLayout grid_layout = AIConfig::DEFAULT_GRID_LAYOUT;
+    int sort_interval = AIConfig::DEFAULT_ANT_SORT_INTERVAL; // Steps between ant re-sorts; 0 disables them
+    int checkpoint_every = 0;       // Iterations between run checkpoints; 0 disables them
+    bool resume = false;            // Continue runs from their checkpoint files
+    std::string checkpoint_dir;     // Directory of the run checkpoints; empty for the working directory
+    std::string initial_state;      // Checkpoint every run starts from instead of a fresh ground
+    std::uint64_t initial_state_hash = 0; // RunCheckpoint::stateHash of that ground, set by main; 0 without one
+    std::string profile_output;     // Profile dump (.csv or JSON) of an ANT_PROFILING build
+    std::string metrics_output;     // NDJSON live metrics stream; replaces the console progress lines
+    bool distributed = false;       // Split every ground over the MPI ranks
+    bool device = false;            // Step every ground in DeviceGround's offload kernels
+    int batch = 1;                  // Sweep runs stepped together by one ReplicaBatch
+    int converge_window = AIConfig::DEFAULT_CONVERGENCE_WINDOW;            // Samples the metric must stay flat over
+    double converge_tolerance = AIConfig::DEFAULT_CONVERGENCE_TOLERANCE;   // Relative spread that stops a run; 0 disables
 };
 
+// "moore" or "von_neumann"
+AIConfig::NeighborhoodType parse_neighborhood(const std::string& name) {
+    if (name == "moore") return AIConfig::NeighborhoodType::Moore;
+    if (name == "von_neumann") return AIConfig::NeighborhoodType::VonNeumann;
+    throw std::invalid_argument("--neighborhood must be moore or von_neumann");
+}
+
+const char* neighborhood_name(AIConfig::NeighborhoodType type) {
+    return type == AIConfig::NeighborhoodType::Moore ? "moore" : "von_neumann";
+}
+
+// "row_major" or "tiled"
+AIConfig::GridLayout parse_grid_layout(const std::string& name) {
+    if (name == "row_major") return AIConfig::GridLayout::RowMajor;
+    if (name == "tiled") return AIConfig::GridLayout::Tiled;
+    throw std::invalid_argument("--grid_layout must be row_major or tiled");
+}
+
+const char* grid_layout_name(AIConfig::GridLayout layout) {
+    return layout == AIConfig::GridLayout::RowMajor ? "row_major" : "tiled";
+}
+
 // Function to parse command-line arguments into the parameters struct.
 void parse_arguments(int argc, char* argv[], SimParameters& params) {
     std::map<std::string, std::string> args;
@@ -75,6 +139,7 @@ void parse_arguments(int argc, char* argv[], SimParameters& params) {
         if (args.count("--experiments")) params.num_experiments = std::stoi(args["--experiments"]);
         if (args.count("--iterations")) params.num_iterations = std::stoi(args["--iterations"]);
         if (args.count("--memory_size")) params.memory_size = std::stoi(args["--memory_size"]);
+        if (args.count("--sample_interval")) params.sample_interval = std::stoi(args["--sample_interval"]);
         if (args.count("--threshold_start")) params.threshold_start = std::stoi(args["--threshold_start"]);
         if (args.count("--threshold_end")) params.threshold_end = std::stoi(args["--threshold_end"]);
         if (args.count("--threshold_interval")) params.threshold_interval = std::stoi(args["--threshold_interval"]);
@@ -84,10 +149,72 @@ void parse_arguments(int argc, char* argv[], SimParameters& params) {
         if (args.count("--prob_relu_low")) params.prob_relu[0] = std::stod(args["--prob_relu_low"]);
         if (args.count("--prob_relu_high")) params.prob_relu[1] = std::stod(args["--prob_relu_high"]);
         if (args.count("--csv_filename")) params.csv_filename = args["--csv_filename"];
+        if (args.count("--output_format")) params.output_format = ResultsWriter::parseFormat(args["--output_format"]);
+        if (args.count("--seed")) params.seed = std::stoull(args["--seed"]);
         if (args.count("--video")) {
             std::string val = args["--video"];
             params.enable_visual = (val == "true" || val == "1");
         }
+        if (args.count("--checkpoint_every")) params.checkpoint_every = std::stoi(args["--checkpoint_every"]);
+        if (args.count("--checkpoint_dir")) params.checkpoint_dir = args["--checkpoint_dir"];
+        if (args.count("--initial_state")) params.initial_state = args["--initial_state"];
+        if (args.count("--profile_output")) params.profile_output = args["--profile_output"];
+        if (args.count("--metrics_output")) params.metrics_output = args["--metrics_output"];
+        if (args.count("--resume")) {
+            std::string val = args["--resume"];
+            params.resume = (val == "true" || val == "1");
+        }
+        if (args.count("--video_stride")) params.video_stride = std::stoi(args["--video_stride"]);
+        if (args.count("--video_duration")) params.video_duration = std::stod(args["--video_duration"]);
+        if (args.count("--video_scale")) params.video_scale = std::stoi(args["--video_scale"]);
+        if (args.count("--video_window")) {
+            std::string val = args["--video_window"];
+            params.video_window = (val == "true" || val == "1");
+        }
+        if (args.count("--parallel_step")) {
+            std::string val = args["--parallel_step"];
+            params.parallel_step = (val == "true" || val == "1");
+        }
+        if (args.count("--fused_step")) {
+            std::string val = args["--fused_step"];
+            params.fused_step = (val == "true" || val == "1");
+        }
+        if (args.count("--neighborhood")) params.neighborhood = parse_neighborhood(args["--neighborhood"]);
+        if (args.count("--grid_layout")) params.grid_layout = parse_grid_layout(args["--grid_layout"]);
+        if (args.count("--sort_interval")) params.sort_interval = std::stoi(args["--sort_interval"]);
+        if (args.count("--distributed")) {
+            std::string val = args["--distributed"];
+            params.distributed = (val == "true" || val == "1");
+        }
+        if (args.count("--device")) {
+            std::string val = args["--device"];
+            params.device = (val == "true" || val == "1");
+        }
+        if (args.count("--batch")) params.batch = std::stoi(args["--batch"]);
+        if (args.count("--converge_window")) params.converge_window = std::stoi(args["--converge_window"]);
+        if (args.count("--converge_tolerance")) params.converge_tolerance = std::stod(args["--converge_tolerance"]);
+        if (args.count("--record_path")) {
+            std::string val = args["--record_path"];
+            params.record_path = (val == "true" || val == "1");
+        }
+        if (params.sample_interval <= 0) {
+            throw std::invalid_argument("--sample_interval must be positive");
+        }
+        if (params.checkpoint_every < 0) {
+            throw std::invalid_argument("--checkpoint_every must not be negative");
+        }
+        if (params.batch <= 0) {
+            throw std::invalid_argument("--batch must be positive");
+        }
+        if (params.converge_window <= 0 || params.converge_tolerance < 0.0) {
+            throw std::invalid_argument("--converge_window must be positive, --converge_tolerance non-negative");
+        }
+        if (params.sort_interval < 0) {
+            throw std::invalid_argument("--sort_interval must not be negative");
+        }
+        if (params.video_stride <= 0 || params.video_scale <= 0 || params.video_duration < 0.0) {
+            throw std::invalid_argument("--video_stride and --video_scale must be positive, --video_duration non-negative");
+        }
     }
     catch (const std::invalid_argument& e) {
         std::cerr << "Error: Invalid argument type provided. " << e.what() << std::endl;
@@ -107,166 +234,841 @@ void print_parameters(const SimParameters& params) {
     std::cout << "  Number of Experiments: " << params.num_experiments << std::endl;
     std::cout << "  Iterations per Experiment: " << params.num_iterations << std::endl;
     std::cout << "  Ant Memory Size: " << params.memory_size << std::endl;
+    std::cout << "  Sample Interval: " << params.sample_interval << std::endl;
     std::cout << "  Threshold Sweep: " << params.threshold_start << " to " << params.threshold_end
         << " (step " << params.threshold_interval << ")" << std::endl;
     std::cout << "  Cooldown Sweep: " << params.cooldown_start << " to " << params.cooldown_end
         << " (step " << params.cooldown_interval << ")" << std::endl;
     std::cout << "  Pick/Drop Probability Range: [" << params.prob_relu[0] << ", " << params.prob_relu[1] << "]" << std::endl;
     std::cout << "  Video Enabled: " << (params.enable_visual ? "Yes" : "No") << std::endl;
-    std::cout << "  Output CSV: " << params.csv_filename << std::endl;
+    std::cout << "  Video Window: " << (params.video_window ? "Yes" : "No") << std::endl;
+    std::cout << "  Video Stride: " << params.video_stride;
+    if (params.video_duration > 0.0) {
+        std::cout << " (auto for " << params.video_duration << " s)";
+    }
+    std::cout << ", Scale: " << params.video_scale << std::endl;
+    if (!params.metrics_output.empty()) {
+        std::cout << "  Metrics Stream: " << params.metrics_output << std::endl;
+    }
+    std::cout << "  Output File: " << params.csv_filename
+        << (params.output_format == ResultsWriter::Format::Binary ? " (binary columnar)" : " (CSV)") << std::endl;
+    std::cout << "  Seed: " << params.seed << std::endl;
+    std::cout << "  Parallel Step: " << (params.parallel_step ? "Yes" : "No") << std::endl;
+    std::cout << "  Fused Step: " << (params.fused_step ? "Yes" : "No") << std::endl;
+    std::cout << "  Record Path Coverage: " << (params.record_path ? "Yes" : "No") << std::endl;
+    std::cout << "  Neighborhood: " << neighborhood_name(params.neighborhood) << std::endl;
+    std::cout << "  Grid Layout: " << grid_layout_name(params.grid_layout) << std::endl;
+    std::cout << "  Distributed: " << (params.distributed ? "Yes" : "No") << std::endl;
+    std::cout << "  Device: " << (params.device ? "Yes" : "No") << std::endl;
+    std::cout << "  Batch: " << (params.batch > 1 ? std::to_string(params.batch) + " runs" : "off") << std::endl;
+    std::cout << "  Convergence: ";
+    if (params.converge_tolerance > 0.0) {
+        std::cout << "tolerance " << params.converge_tolerance << " over " << params.converge_window << " samples";
+    }
+    else {
+        std::cout << "off";
+    }
+    std::cout << std::endl;
+    std::cout << "  Ant Sort Interval: " << (params.sort_interval > 0 ? std::to_string(params.sort_interval) : "off") << std::endl;
+    std::cout << "  Checkpoint Every: " << (params.checkpoint_every > 0 ? std::to_string(params.checkpoint_every) : "off")
+        << (params.resume ? " (resuming)" : "") << std::endl;
+    if (!params.checkpoint_dir.empty()) {
+        std::cout << "  Checkpoint Directory: " << params.checkpoint_dir << std::endl;
+    }
+    if (!params.initial_state.empty()) {
+        std::cout << "  Initial State: " << params.initial_state << std::endl;
+    }
     std::cout << "-----------------------------" << std::endl;
 }
 
-// Function to write the header of the CSV data file.
-void write_csv_header(std::ofstream& file) {
-    file << "Cooldown,Threshold,Run,Iteration,ClusterSize,InteractionCount\n";
+// Simulation parameters as a flat JSON object, stored in binary result headers.
+std::string parameters_json(const SimParameters& params) {
+    std::ostringstream json;
+    json.precision(17);
+    json << "{\"width\": " << params.width
+        << ", \"length\": " << params.length
+        << ", \"ants\": " << params.num_ants
+        << ", \"experiments\": " << params.num_experiments
+        << ", \"iterations\": " << params.num_iterations
+        << ", \"memory_size\": " << params.memory_size
+        << ", \"sample_interval\": " << params.sample_interval
+        << ", \"threshold_start\": " << params.threshold_start
+        << ", \"threshold_end\": " << params.threshold_end
+        << ", \"threshold_interval\": " << params.threshold_interval
+        << ", \"cooldown_start\": " << params.cooldown_start
+        << ", \"cooldown_end\": " << params.cooldown_end
+        << ", \"cooldown_interval\": " << params.cooldown_interval
+        << ", \"prob_relu_low\": " << params.prob_relu[0]
+        << ", \"prob_relu_high\": " << params.prob_relu[1]
+        << ", \"seed\": " << params.seed
+        << ", \"parallel_step\": " << (params.parallel_step ? "true" : "false")
+        << ", \"fused_step\": " << (params.fused_step ? "true" : "false")
+        << ", \"record_path\": " << (params.record_path ? "true" : "false")
+        << ", \"neighborhood\": \"" << neighborhood_name(params.neighborhood) << "\""
+        << ", \"grid_layout\": \"" << grid_layout_name(params.grid_layout) << "\""
+        << ", \"sort_interval\": " << params.sort_interval
+        << ", \"distributed\": " << (params.distributed ? "true" : "false")
+        << ", \"device\": " << (params.device ? "true" : "false")
+        << ", \"batch\": " << params.batch
+        << ", \"converge_window\": " << params.converge_window
+        << ", \"converge_tolerance\": " << params.converge_tolerance
+        << "}";
+    return json.str();
+}
+
+// Iterations per video frame. A target duration overrides --video_stride with
+// the smallest stride whose frame count fits the duration at the video fps.
+void resolve_video_stride(SimParameters& params) {
+    if (params.video_duration > 0.0) {
+        double max_frames = params.video_duration * AIConfig::DEFAULT_VIDEO_FPS;
+        int stride = static_cast<int>(std::ceil(params.num_iterations / std::max(max_frames, 1.0)));
+        params.video_stride = std::max(stride, 1);
+    }
 }
 
 
-int main(int argc, char* argv[]) {
-    SimParameters params;
-    parse_arguments(argc, argv, params);
-    print_parameters(params);
+// One (cooldown, threshold, run) cell of the parameter sweep.
+struct SweepTask {
+    int cooldown;
+    int threshold;
+    int run;
+    // Position of the run's rows in the output file.
+    std::size_t sequence;
+    // Relative amount of work, used to start long tasks first.
+    double cost;
+};
 
-    // Normalize probability distribution for ant movement
-    std::vector<double> prob = { 12, 5, 2, 1, 0.1, 1, 2, 5 };
-    double prob_sum = std::accumulate(prob.begin(), prob.end(), 0.0);
-    for (auto& p : prob) {
-        p /= prob_sum;
+// Flatten the cooldown x threshold x run product into one task list, ordered
+// longest-first. Every run currently does the same number of ant-steps, so
+// the stable sort keeps sweep order; the cost is where a future estimate of
+// uneven configurations plugs in.
+std::vector<SweepTask> build_sweep_tasks(const SimParameters& params) {
+    std::vector<SweepTask> tasks;
+    std::size_t sequence = 0;
+    for (int cooldown = params.cooldown_start; cooldown <= params.cooldown_end; cooldown += params.cooldown_interval) {
+        for (int threshold = params.threshold_start; threshold <= params.threshold_end; threshold += params.threshold_interval) {
+            for (int run = 1; run <= params.num_experiments; ++run) {
+                double cost = static_cast<double>(params.num_iterations) * params.num_ants;
+                tasks.push_back({ cooldown, threshold, run, sequence++, cost });
+            }
+        }
     }
+    std::stable_sort(tasks.begin(), tasks.end(),
+        [](const SweepTask& a, const SweepTask& b) { return a.cost > b.cost; });
+    return tasks;
+}
 
-    // Probability distribution for objects
-    std::unordered_map<std::shared_ptr<Object>, double> obj_dict = {
-        {std::make_shared<Food>(),  0.05},
-        {std::make_shared<Egg>(),   0.05},
-        {std::make_shared<Waste>(), 0.05},
-        {nullptr,                  0.85}
+// Each (cooldown, threshold, run) gets its own reproducible seed.
+std::uint64_t run_seed_for(const SimParameters& params, const SweepTask& task) {
+    return CounterRng::key(params.seed,
+        (static_cast<std::uint64_t>(task.cooldown) << 32) | static_cast<std::uint32_t>(task.threshold),
+        static_cast<std::uint64_t>(task.run));
+}
+
+// What --resume requires a run's checkpoint to match. Any checkpoint can
+// still seed other runs through --initial_state. Append new parameters at
+// the end; their position is their place in the file.
+RunIdentity run_identity(const SimParameters& params, const SweepTask& task) {
+    RunIdentity identity;
+    identity.seed = run_seed_for(params, task);
+    identity.parameters = {
+        { "cooldown", task.cooldown },
+        { "threshold", task.threshold },
+        { "run", task.run },
+        { "--width", params.width },
+        { "--length", params.length },
+        { "--ants", params.num_ants },
+        { "--memory_size", params.memory_size },
+        { "--iterations", params.num_iterations },
+        { "--sample_interval", params.sample_interval },
+        { "--prob_relu_low", params.prob_relu[0] },
+        { "--prob_relu_high", params.prob_relu[1] },
+        { "--neighborhood", static_cast<int>(params.neighborhood) },
+        { "--parallel_step/--device", params.device ? 2 : params.parallel_step ? 1 : 0 },
+        { "--converge_window", params.converge_window },
+        { "--converge_tolerance", params.converge_tolerance },
+        { "--sort_interval", params.sort_interval },
+        // The 64-bit hash in two exactly representable halves.
+        { "--initial_state", static_cast<double>(params.initial_state_hash >> 32) },
+        { "--initial_state", static_cast<double>(params.initial_state_hash & 0xFFFFFFFFULL) },
     };
+    return identity;
+}
 
-    // Robust File Handling Step 1: Write header and close immediately.
-    std::ofstream header_writer(params.csv_filename, std::ios_base::trunc);
-    if (!header_writer.is_open()) {
-        std::cerr << "Error: Could not open the output file '" << params.csv_filename << "' for writing header." << std::endl;
-        return -1;
+// Checkpoint (".antsnap") or done record (".antdone") of one run, in
+// --checkpoint_dir when given.
+std::string checkpoint_filename(const SimParameters& params, const SweepTask& task, const char* extension) {
+    std::string prefix = params.checkpoint_dir;
+    if (!prefix.empty() && prefix.back() != '/' && prefix.back() != '\\') {
+        prefix += '/';
     }
-    write_csv_header(header_writer);
-    header_writer.close();
+    return prefix + "checkpoint_C" + std::to_string(task.cooldown)
+        + "_T" + std::to_string(task.threshold)
+        + "_R" + std::to_string(task.run) + extension;
+}
 
-    auto total_start_time = std::chrono::high_resolution_clock::now();
-    std::cout << "\nStarting simulation with " << omp_get_max_threads() << " threads." << std::endl;
+// Cooldown, threshold and run of the rows restored from a checkpoint.
+ResultRow task_tag(const SweepTask& task) {
+    return { task.cooldown, task.threshold, task.run, 0, 0.0, 0 };
+}
 
-    // Main simulation loop: sweep through cooldown and threshold values
-    for (int cooldown = params.cooldown_start; cooldown <= params.cooldown_end; cooldown += params.cooldown_interval) {
-        for (int threshold = params.threshold_start; threshold <= params.threshold_end; threshold += params.threshold_interval) {
+// Load --initial_state once before any run starts, so a missing or
+// mismatched file is reported up front, and return the hash of its ground
+// for the run identities; throws std::runtime_error.
+std::uint64_t check_initial_state(const SimParameters& params, const std::vector<double>& prob) {
+    Ground ground(params.width, params.length, prob, params.prob_relu, params.threshold_start, params.cooldown_start, params.seed);
+    const SweepTask task{ params.cooldown_start, params.threshold_start, 1, 0, 0.0 };
+    int start_iteration = 0;
+    std::vector<ResultRow> rows;
+    if (!RunCheckpoint::load(params.initial_state, task_tag(task), nullptr, ground, start_iteration, rows)) {
+        throw std::runtime_error("Could not open initial state " + params.initial_state);
+    }
+    return RunCheckpoint::stateHash(ground);
+}
+
+// Exceptions must not leave an OpenMP loop body. A failing task records the
+// first error in error instead; tasks that start after it are skipped.
+void run_sweep_task(std::string& error, const std::function<void()>& body) {
+    bool failed;
+#pragma omp critical(sweep_error)
+    failed = !error.empty();
+    if (failed) {
+        return;
+    }
+    try {
+        body();
+    }
+    catch (const std::exception& e) {
+#pragma omp critical(sweep_error)
+        {
+            if (error.empty()) {
+                error = e.what();
+            }
+        }
+    }
+}
 
-            std::cout << "Running experiments for Cooldown = " << cooldown << ", Threshold = " << threshold << "..." << std::endl;
+// Stops a run once its sampled cluster size has settled; disabled unless
+// --converge_tolerance is positive.
+ConvergenceDetector make_convergence_detector(const SimParameters& params) {
+    return ConvergenceDetector(static_cast<std::size_t>(params.converge_window), params.converge_tolerance);
+}
 
-            // Parallelize the experimental runs for the current parameter combination
-#pragma omp parallel for schedule(dynamic, 1)
-            for (int j = 0; j < params.num_experiments; ++j) {
-                // Create a unique temporary filename for each experiment run.
-                std::string temp_filename = "temp_data_C" + std::to_string(cooldown)
-                    + "_T" + std::to_string(threshold)
-                    + "_R" + std::to_string(j + 1) + ".csv";
-
-                std::ofstream temp_file(temp_filename);
-
-                // Initialize the simulation environment
-                Ground ground(params.width, params.length, prob, params.prob_relu, threshold, cooldown);
-                ground.addObject(obj_dict);
-                for (int i = 0; i < params.num_ants; ++i) {
-                    ground.addAnt(params.memory_size);
-                }
+// Tag every row of a finished run with the iteration it converged at (-1 if none).
+void mark_convergence(std::vector<ResultRow>& rows, int converged_iteration) {
+    for (auto& row : rows) {
+        row.convergedIteration = converged_iteration;
+    }
+}
+
+// Run a single experiment and return its sampled rows. Samples also go to
+// metrics, when given, instead of the console progress lines.
+std::vector<ResultRow> run_experiment(const SimParameters& params, const SweepTask& task,
+    const std::vector<double>& prob, const std::unordered_map<AIConfig::ObjectType, double>& obj_dict,
+    MetricsStream* metrics) {
+    std::vector<ResultRow> rows;
+
+    const int cooldown = task.cooldown;
+    const int threshold = task.threshold;
+    const int run = task.run;
+
+    const std::uint64_t run_seed = run_seed_for(params, task);
+    const RunIdentity identity = run_identity(params, task);
+
+    // A run that finished before the sweep was interrupted is not run again.
+    const std::string done_file = checkpoint_filename(params, task, ".antdone");
+    if (params.resume && RunCheckpoint::loadDone(done_file, task_tag(task), identity, rows)) {
+#pragma omp critical
+        {
+            std::cout << "Skipping C: " << cooldown << ", T: " << threshold << ", Exp: " << run
+                << "; it finished before the interruption" << std::endl;
+        }
+        if (metrics) {
+            metrics->publishRunEnd(cooldown, threshold, run, rows.empty() ? -1 : rows.front().convergedIteration);
+        }
+        return rows;
+    }
+
+    // Initialize the simulation environment
+    Ground ground(params.width, params.length, prob, params.prob_relu, threshold, cooldown, run_seed);
+    ground.setStepMode(params.parallel_step ? AIConfig::StepMode::Parallel : AIConfig::StepMode::Serial);
+    ground.setNeighborhood(params.neighborhood);
+    ground.setGridLayout(params.grid_layout);
+    ground.setAntSortInterval(params.sort_interval);
+
+    // Start from this run's own checkpoint, from a shared warmed-up state
+    // (on the run's own random stream), or from a freshly populated ground.
+    const std::string checkpoint_file = checkpoint_filename(params, task, ".antsnap");
+    int start_iteration = 0;
+    if (params.resume && RunCheckpoint::load(checkpoint_file, task_tag(task), &identity, ground, start_iteration, rows)) {
+#pragma omp critical
+        {
+            std::cout << "Resuming C: " << cooldown << ", T: " << threshold << ", Exp: " << run
+                << " at iteration " << start_iteration << std::endl;
+        }
+    }
+    else if (!params.initial_state.empty()) {
+        std::vector<ResultRow> prefix_rows;
+        if (!RunCheckpoint::load(params.initial_state, task_tag(task), nullptr, ground, start_iteration, prefix_rows)) {
+            throw std::runtime_error("Could not open initial state " + params.initial_state);
+        }
+        ground.setSeed(run_seed);
+    }
+    else {
+        ground.addObject(obj_dict);
+        ground.addAnts(params.num_ants, params.memory_size);
+    }
+
+    // A resumed run's detector continues from the samples it already took.
+    ConvergenceDetector convergence = make_convergence_detector(params);
+    for (const auto& row : rows) {
+        convergence.add(row.clusterSize);
+    }
+    int converged_iteration = -1;
+
+    ground.setRecordPath(params.record_path && !params.device);
+    // With --device the run continues on the offload device from here on;
+    // ground keeps its initial state.
+    std::unique_ptr<DeviceGround> device;
+    if (params.device) {
+        device = std::make_unique<DeviceGround>(ground);
+    }
 
-                // === VIDEO WRITER SETUP (START) ===
+    // === VIDEO WRITER SETUP (START) ===
 #ifndef IS_TEST_BUILD
-                cv::VideoWriter video;
-                if (params.enable_visual) {
-                    // Create a unique video filename for the experiment
-                    std::string video_filename = "simulation_C" + std::to_string(cooldown)
-                        + "_T" + std::to_string(threshold)
-                        + "_R" + std::to_string(j + 1) + ".mp4";
-                    int scale = 6; // Must match the scale used in showGround()
-                    cv::Size frame_size(params.length * scale, params.width * scale);
-                    // Use 'm', 'p', '4', 'v' for MP4 file format
-                    video.open(video_filename, cv::VideoWriter::fourcc('m', 'p', '4', 'v'), 120, frame_size, true);
-                    if (!video.isOpened()) {
+    // Frames are rasterised and encoded on a worker thread; the
+    // pipeline is declared after the writer so it is joined first.
+    cv::VideoWriter video;
+    std::unique_ptr<FramePipeline> frames;
+    if (params.enable_visual) {
+        // Create a unique video filename for the experiment
+        std::string video_filename = "simulation_C" + std::to_string(cooldown)
+            + "_T" + std::to_string(threshold)
+            + "_R" + std::to_string(run) + ".mp4";
+        const int scale = params.video_scale;
+        cv::Size frame_size(params.length * scale, params.width * scale);
+        // Use 'm', 'p', '4', 'v' for MP4 file format
+        video.open(video_filename, cv::VideoWriter::fourcc('m', 'p', '4', 'v'), AIConfig::DEFAULT_VIDEO_FPS, frame_size, true);
+        if (!video.isOpened()) {
 #pragma omp critical
-                        {
-                            std::cerr << "Error: Could not open video file for writing: " << video_filename << std::endl;
-                        }
+            {
+                std::cerr << "Error: Could not open video file for writing: " << video_filename << std::endl;
+            }
+        }
+        else {
+            const bool show_window = params.video_window;
+            frames = std::make_unique<FramePipeline>(scale, AIConfig::DEFAULT_VIDEO_QUEUE_DEPTH,
+                [&video, show_window](const std::uint8_t* bgr, int rows, int cols) {
+                    cv::Mat image(rows, cols, CV_8UC3, const_cast<std::uint8_t*>(bgr));
+                    if (show_window) {
+                        cv::imshow("Ant Simulation", image);
+                        cv::waitKey(1);
                     }
-                }
+                    video.write(image);
+                });
+        }
+    }
 #endif
-                // === VIDEO WRITER SETUP (END) ===
+    // === VIDEO WRITER SETUP (END) ===
 
 
-                // Run the simulation
-                for (int i = 0; i < params.num_iterations; ++i) {
-                    ground.moveAnts();
-                    ground.assignWork();
-                    ground.handleAntInteractions(i);
+    // Run the simulation
+    for (int i = start_iteration; i < params.num_iterations; ++i) {
+        if (device) {
+            device->step();
+        }
+        else if (params.fused_step) {
+            ground.step();
+        }
+        else {
+            ground.moveAnts();
+            ground.assignWork();
+            ground.handleAntInteractions(i);
+        }
 
-                    // === SHOW/SAVE FRAME (START) ===
+        // === SHOW/SAVE FRAME (START) ===
 #ifndef IS_TEST_BUILD
-                    if (params.enable_visual && video.isOpened()) {
-                        // The window name is provided, and the video writer is passed
-                        ground.showGround("Ant Simulation", video);
-                    }
+        if (frames && i % params.video_stride == 0) {
+            // Skipped iterations take no snapshot at all. Only a snapshot is
+            // taken here; drawing and encoding overlap the next steps.
+            if (device) {
+                frames->submit([&device](FrameSnapshot& frame) { device->snapshot(frame); });
+            }
+            else {
+                frames->submit(ground);
+            }
+        }
 #endif
-                    // === SHOW/SAVE FRAME (END) ===
+        // === SHOW/SAVE FRAME (END) ===
 
 
-                    if (i % 10000 == 0) {
-                        double avg_cluster_size = ground.averageClusterSize();
-                        int interaction_count = ground.getInteractionCount();
+        // The cluster metric is incremental, so it can be sampled densely;
+        // console progress stays at every 10000 iterations.
+        bool record = (i % params.sample_interval == 0);
+        bool report = !metrics && (i % 10000 == 0);
+        if (record || report) {
+            double avg_cluster_size = device ? device->averageClusterSize() : ground.averageClusterSize();
+            int interaction_count = device ? device->getInteractionCount() : ground.getInteractionCount();
 
-                        temp_file << cooldown << "," << threshold << "," << j + 1 << "," << i << ","
-                            << avg_cluster_size << "," << interaction_count << "\n";
+            if (record) {
+                rows.push_back({ cooldown, threshold, run, i, avg_cluster_size, interaction_count });
+                if (metrics) {
+                    metrics->publishSample(rows.back());
+                }
+                if (convergence.add(avg_cluster_size)) {
+                    converged_iteration = i;
+                }
+            }
 
+            if (report) {
 #pragma omp critical
-                        {
-                            std::cout << "C: " << cooldown << ", T: " << threshold
-                                << ", Exp: " << j + 1
-                                << ", Iter: " << i << "/" << params.num_iterations
-                                << ", Cluster: " << avg_cluster_size
-                                << ", Interact: " << interaction_count << std::endl;
-                        }
-                    }
+                {
+                    std::cout << "C: " << cooldown << ", T: " << threshold
+                        << ", Exp: " << run
+                        << ", Iter: " << i << "/" << params.num_iterations
+                        << ", Cluster: " << avg_cluster_size
+                        << ", Interact: " << interaction_count << std::endl;
+                }
+            }
+        }
+
+        if (params.checkpoint_every > 0 && (i + 1) % params.checkpoint_every == 0 && i + 1 < params.num_iterations) {
+            RunCheckpoint::save(checkpoint_file, [&](std::ostream& out) {
+                if (device) {
+                    device->saveState(out);
+                }
+                else {
+                    ground.saveState(out);
                 }
-                temp_file.close();
-                // VideoWriter is automatically released by its destructor when it goes out of scope.
+            }, identity, i + 1, rows);
+        }
+        // The thread goes back to the task pool as soon as the run settles.
+        if (converged_iteration >= 0) {
+            break;
+        }
+    }
+    mark_convergence(rows, converged_iteration);
+    if (metrics) {
+        metrics->publishRunEnd(cooldown, threshold, run, converged_iteration);
+    }
+    if (params.record_path && !device) {
+        const double cells = static_cast<double>(params.width) * params.length;
+#pragma omp critical
+        {
+            std::cout << "C: " << cooldown << ", T: " << threshold << ", Exp: " << run
+                << ", Coverage: " << ground.coveredCells() << " cells ("
+                << (cells > 0 ? 100.0 * ground.coveredCells() / cells : 0.0) << "%)" << std::endl;
+        }
+    }
+    if (params.checkpoint_every > 0 || params.resume) {
+        // The results file is rewritten by every sweep, so the rows wait in a
+        // done record until it is complete; the checkpoint is obsolete.
+        RunCheckpoint::saveDone(done_file, identity, converged_iteration, rows);
+        std::remove(checkpoint_file.c_str());
+    }
+#ifndef IS_TEST_BUILD
+    if (frames) {
+        frames->close();
+    }
+#endif
+    // VideoWriter is automatically released by its destructor when it goes out of scope.
+    return rows;
+}
+
+// Run count consecutive sweep tasks as the replicas of one ReplicaBatch and
+// return each task's sampled rows. The rows equal those of run_experiment.
+std::vector<std::vector<ResultRow>> run_batched_experiments(const SimParameters& params, const SweepTask* tasks,
+    std::size_t count, const std::vector<double>& prob, const std::unordered_map<AIConfig::ObjectType, double>& obj_dict,
+    MetricsStream* metrics) {
+    int start_iteration = 0;
+    std::vector<std::unique_ptr<Ground>> grounds;
+    std::vector<const Ground*> replicas;
+    for (std::size_t r = 0; r < count; ++r) {
+        const SweepTask& task = tasks[r];
+        const std::uint64_t run_seed = run_seed_for(params, task);
+        grounds.push_back(std::make_unique<Ground>(params.width, params.length, prob, params.prob_relu,
+            task.threshold, task.cooldown, run_seed));
+        Ground& ground = *grounds.back();
+        ground.setNeighborhood(params.neighborhood);
+        if (!params.initial_state.empty()) {
+            std::vector<ResultRow> prefix_rows;
+            if (!RunCheckpoint::load(params.initial_state, task_tag(task), nullptr, ground, start_iteration, prefix_rows)) {
+                throw std::runtime_error("Could not open initial state " + params.initial_state);
             }
+            ground.setSeed(run_seed);
+        }
+        else {
+            ground.addObject(obj_dict);
+            ground.addAnts(params.num_ants, params.memory_size);
+        }
+        replicas.push_back(&ground);
+    }
+    ReplicaBatch batch(replicas);
+    grounds.clear();
+
+    // Converged replicas keep stepping with the batch but stop sampling;
+    // the batch ends once every replica has converged.
+    std::vector<std::vector<ResultRow>> rows(count);
+    std::vector<ConvergenceDetector> convergence(count, make_convergence_detector(params));
+    std::vector<int> converged_iteration(count, -1);
+    std::size_t running = count;
+    for (int i = start_iteration; i < params.num_iterations && running > 0; ++i) {
+        batch.step();
 
-            // Robust File Handling Step 2: Open in append mode, aggregate data, and close immediately.
-            std::ofstream aggregator(params.csv_filename, std::ios_base::app);
-            if (!aggregator.is_open()) {
-                std::cerr << "Error: Could not open the output file '" << params.csv_filename << "' for appending results." << std::endl;
-                continue; // Skip to the next loop iteration
+        bool record = (i % params.sample_interval == 0);
+        bool report = !metrics && (i % 10000 == 0);
+        if (!record && !report) {
+            continue;
+        }
+        for (std::size_t r = 0; r < count; ++r) {
+            const SweepTask& task = tasks[r];
+            if (converged_iteration[r] >= 0) {
+                continue;
             }
+            double avg_cluster_size = batch.averageClusterSize(r);
+            int interaction_count = batch.getInteractionCount(r);
+            if (record) {
+                rows[r].push_back({ task.cooldown, task.threshold, task.run, i, avg_cluster_size, interaction_count });
+                if (metrics) {
+                    metrics->publishSample(rows[r].back());
+                }
+                if (convergence[r].add(avg_cluster_size)) {
+                    converged_iteration[r] = i;
+                    --running;
+                }
+            }
+            if (report) {
+#pragma omp critical
+                {
+                    std::cout << "C: " << task.cooldown << ", T: " << task.threshold
+                        << ", Exp: " << task.run
+                        << ", Iter: " << i << "/" << params.num_iterations
+                        << ", Cluster: " << avg_cluster_size
+                        << ", Interact: " << interaction_count << std::endl;
+                }
+            }
+        }
+    }
+    for (std::size_t r = 0; r < count; ++r) {
+        mark_convergence(rows[r], converged_iteration[r]);
+        if (metrics) {
+            metrics->publishRunEnd(tasks[r].cooldown, tasks[r].threshold, tasks[r].run, converged_iteration[r]);
+        }
+    }
+    return rows;
+}
 
-            // The aggregation loop now reconstructs the unique filenames to read and append them.
-            for (int run = 1; run <= params.num_experiments; ++run) {
-                std::string temp_filename = "temp_data_C" + std::to_string(cooldown)
-                    + "_T" + std::to_string(threshold)
-                    + "_R" + std::to_string(run) + ".csv";
-
-                std::ifstream temp_file(temp_filename);
-                if (temp_file.is_open()) {
-                    if (temp_file.peek() != std::ifstream::traits_type::eof()) {
-                        aggregator << temp_file.rdbuf();
-                    }
-                    temp_file.close();
-                    remove(temp_filename.c_str());
+// Run a single experiment on a ground split over every rank of comm. All
+// ranks run it in lockstep; only rank 0 returns the sampled rows and
+// publishes to metrics, which is null on the other ranks.
+std::vector<ResultRow> run_distributed_experiment(const SimParameters& params, const SweepTask& task,
+    const std::vector<double>& prob, const std::unordered_map<AIConfig::ObjectType, double>& obj_dict,
+    Communicator& comm, MetricsStream* metrics) {
+    const std::uint64_t run_seed = run_seed_for(params, task);
+    DistributedGround ground(comm, params.width, params.length, prob, params.prob_relu, task.threshold, task.cooldown, run_seed);
+    ground.setNeighborhood(params.neighborhood);
+    ground.addObject(obj_dict);
+    for (int i = 0; i < params.num_ants; ++i) {
+        ground.addAnt(params.memory_size);
+    }
+
+    // The progress cadence must be equal on every rank, so it follows
+    // --metrics_output rather than whether this rank holds the stream.
+    DistributedRun::Options options;
+    options.iterations = params.num_iterations;
+    options.sampleInterval = params.sample_interval;
+    options.reportInterval = params.metrics_output.empty() ? 10000 : 0;
+    options.fusedStep = params.fused_step;
+    options.convergeWindow = params.converge_window;
+    options.convergeTolerance = params.converge_tolerance;
+    return DistributedRun::run(ground, comm, task_tag(task), options, metrics, &std::cout);
+}
+
+// Options a distributed run cannot honour, reported once by rank 0.
+void warn_distributed_limits(const SimParameters& params) {
+    std::vector<std::string> ignored;
+    if (params.enable_visual) ignored.push_back("--video");
+    if (params.record_path) ignored.push_back("--record_path");
+    if (params.checkpoint_every > 0 || params.resume) ignored.push_back("--checkpoint_every/--resume");
+    if (!params.initial_state.empty()) ignored.push_back("--initial_state");
+    if (params.grid_layout != AIConfig::GridLayout::RowMajor) ignored.push_back("--grid_layout");
+    if (params.sort_interval > 0) ignored.push_back("--sort_interval");
+    for (const auto& option : ignored) {
+        std::cerr << "Warning: " << option << " is not supported with --distributed and is ignored." << std::endl;
+    }
+#ifndef ANT_WITH_MPI
+    std::cerr << "Warning: built without ANT_WITH_MPI; --distributed runs on a single rank." << std::endl;
+#endif
+}
+
+// Options a --device run cannot honour, reported once.
+void warn_device_limits(const SimParameters& params) {
+    if (params.distributed) {
+        std::cerr << "Warning: --device is not supported with --distributed and is ignored." << std::endl;
+        return;
+    }
+    std::vector<std::string> ignored;
+    if (params.record_path) ignored.push_back("--record_path");
+    if (params.parallel_step) ignored.push_back("--parallel_step");
+    if (params.grid_layout != AIConfig::GridLayout::RowMajor) ignored.push_back("--grid_layout");
+    if (params.sort_interval > 0) ignored.push_back("--sort_interval");
+    for (const auto& option : ignored) {
+        std::cerr << "Warning: " << option << " is not supported with --device and is ignored." << std::endl;
+    }
+    if (!DeviceGround::deviceAvailable()) {
+        std::cerr << "Warning: no offload device found; --device kernels run on the host threads." << std::endl;
+    }
+}
+
+// Options a --batch run cannot honour, reported once.
+void warn_batch_limits(const SimParameters& params) {
+    if (params.distributed || params.device) {
+        std::cerr << "Warning: --batch is not supported with --distributed or --device and is ignored." << std::endl;
+        return;
+    }
+    std::vector<std::string> ignored;
+    if (params.enable_visual) ignored.push_back("--video");
+    if (params.record_path) ignored.push_back("--record_path");
+    if (params.checkpoint_every > 0 || params.resume) ignored.push_back("--checkpoint_every/--resume");
+    if (params.parallel_step) ignored.push_back("--parallel_step");
+    if (params.grid_layout != AIConfig::GridLayout::RowMajor) ignored.push_back("--grid_layout");
+    if (params.sort_interval > 0) ignored.push_back("--sort_interval");
+    for (const auto& option : ignored) {
+        std::cerr << "Warning: " << option << " is not supported with --batch and is ignored." << std::endl;
+    }
+}
+
+// A full window holds converge_window + 1 samples, the last one taken at
+// iteration converge_window * sample_interval. Reported once when no run is
+// long enough to get there.
+void warn_convergence_limits(const SimParameters& params) {
+    const long long span = static_cast<long long>(params.converge_window) * params.sample_interval;
+    if (span >= params.num_iterations) {
+        std::cerr << "Warning: --converge_window " << params.converge_window << " at --sample_interval "
+            << params.sample_interval << " needs " << span + 1 << " iterations, but runs have "
+            << params.num_iterations << "; no run can converge. Lower --sample_interval or --converge_window." << std::endl;
+    }
+}
+
+#ifdef ANT_WITH_MPI
+// Initialises MPI for the lifetime of main.
+struct MpiSession {
+    MpiSession(int& argc, char**& argv) { MPI_Init(&argc, &argv); }
+    ~MpiSession() { MPI_Finalize(); }
+};
+#endif
+
+// Print the per-phase profile and write it to --profile_output when the
+// build was compiled with ANT_PROFILING.
+void report_profile(const SimParameters& params) {
+    if (!Profiling::ENABLED) {
+        if (!params.profile_output.empty()) {
+            std::cerr << "Warning: --profile_output ignored; this build was compiled without ANT_PROFILING." << std::endl;
+        }
+        return;
+    }
+    const Profiling::Report report = Profiling::collect();
+    std::cout << std::endl;
+    Profiling::writeSummary(std::cout, report);
+    if (params.profile_output.empty()) {
+        return;
+    }
+    std::ofstream out(params.profile_output);
+    if (!out) {
+        std::cerr << "Warning: Could not write profile to " << params.profile_output << std::endl;
+        return;
+    }
+    const std::string& name = params.profile_output;
+    if (name.size() >= 4 && name.compare(name.size() - 4, 4, ".csv") == 0) {
+        Profiling::writeCsv(out, report);
+    }
+    else {
+        Profiling::writeJson(out, report);
+    }
+    std::cout << "Profile written to " << params.profile_output << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+#ifdef ANT_WITH_MPI
+    MpiSession mpi(argc, argv);
+#endif
+    SimParameters params;
+    parse_arguments(argc, argv, params);
+    resolve_video_stride(params);
+
+    // With --distributed every rank runs main; rank 0 alone prints and writes results.
+    std::unique_ptr<Communicator> comm;
+    if (params.distributed) {
+#ifdef ANT_WITH_MPI
+        comm = std::make_unique<MpiCommunicator>();
+#else
+        comm = std::make_unique<SelfCommunicator>();
+#endif
+    }
+    const bool root = !comm || comm->rank() == 0;
+    if (root) {
+        print_parameters(params);
+        if (params.distributed) {
+            warn_distributed_limits(params);
+        }
+        if (params.device) {
+            warn_device_limits(params);
+        }
+        if (params.batch > 1) {
+            warn_batch_limits(params);
+        }
+        if (params.converge_tolerance > 0.0) {
+            warn_convergence_limits(params);
+        }
+    }
+
+    // Normalize probability distribution for ant movement
+    std::vector<double> prob = { 12, 5, 2, 1, 0.1, 1, 2, 5 };
+    double prob_sum = std::accumulate(prob.begin(), prob.end(), 0.0);
+    for (auto& p : prob) {
+        p /= prob_sum;
+    }
+
+    // Probability distribution for objects
+    std::unordered_map<AIConfig::ObjectType, double> obj_dict = {
+        {AIConfig::ObjectType::Food,  0.05},
+        {AIConfig::ObjectType::Egg,   0.05},
+        {AIConfig::ObjectType::Waste, 0.05},
+        {AIConfig::ObjectType::None,  0.85}
+    };
+
+    if (root && !params.distributed && !params.initial_state.empty()) {
+        try {
+            params.initial_state_hash = check_initial_state(params, prob);
+        }
+        catch (const std::runtime_error& e) {
+            std::cerr << "Error: " << e.what() << std::endl;
+            return -1;
+        }
+    }
+
+    // Runs buffer their rows in memory; one writer thread streams them to the
+    // CSV in sweep order, so no temporary files are created.
+    std::unique_ptr<ResultsWriter> results;
+    if (root) {
+        try {
+            results = std::make_unique<ResultsWriter>(params.csv_filename, params.output_format, parameters_json(params),
+                params.converge_tolerance > 0.0);
+        }
+        catch (const std::runtime_error& e) {
+            std::cerr << "Error: " << e.what() << std::endl;
+            return -1;
+        }
+    }
+
+    auto total_start_time = std::chrono::high_resolution_clock::now();
+    if (root) {
+        std::cout << "\nStarting simulation with " << omp_get_max_threads() << " threads";
+        if (comm) {
+            std::cout << " on each of " << comm->size() << " ranks";
+        }
+        std::cout << "." << std::endl;
+    }
+
+    // Every (cooldown, threshold, run) is an independent task in one pool, so
+    // threads never wait at the end of a parameter pair. With --parallel_step
+    // or --device the threads go to each ground instead and tasks run one
+    // after another.
+    const std::vector<SweepTask> tasks = build_sweep_tasks(params);
+    const long long num_tasks = static_cast<long long>(tasks.size());
+    if (root) {
+        std::cout << "Scheduling " << num_tasks << " experiment runs." << std::endl;
+    }
+    // Threads publish samples without waiting for I/O; rank 0 alone streams.
+    std::unique_ptr<MetricsStream> metrics;
+    if (root && !params.metrics_output.empty()) {
+        try {
+            metrics = std::make_unique<MetricsStream>(params.metrics_output, tasks.size(), parameters_json(params));
+        }
+        catch (const std::runtime_error& e) {
+            std::cerr << "Error: " << e.what() << std::endl;
+            return -1;
+        }
+    }
+    std::string sweep_error;
+    const bool checkpointed = !comm && !(params.batch > 1 && !params.device)
+        && (params.checkpoint_every > 0 || params.resume);
+    if (comm) {
+        // Every rank holds a slab of the same run, so runs go one at a time.
+        for (const SweepTask& task : tasks) {
+            std::vector<ResultRow> rows = run_distributed_experiment(params, task, prob, obj_dict, *comm, metrics.get());
+            if (root) {
+                results->submit(task.sequence, std::move(rows));
+            }
+        }
+    }
+    else if (params.batch > 1 && !params.device) {
+        // Consecutive tasks form one batch, and batches share the pool.
+        const std::size_t batch_size = static_cast<std::size_t>(params.batch);
+        const long long num_batches = static_cast<long long>((tasks.size() + batch_size - 1) / batch_size);
+#pragma omp parallel for schedule(dynamic, 1)
+        for (long long b = 0; b < num_batches; ++b) {
+            run_sweep_task(sweep_error, [&] {
+                const std::size_t begin = static_cast<std::size_t>(b) * batch_size;
+                const std::size_t count = std::min(batch_size, tasks.size() - begin);
+                std::vector<std::vector<ResultRow>> rows = run_batched_experiments(params, &tasks[begin], count, prob, obj_dict, metrics.get());
+                for (std::size_t r = 0; r < count; ++r) {
+                    results->submit(tasks[begin + r].sequence, std::move(rows[r]));
                 }
+            });
+        }
+    }
+    else {
+#pragma omp parallel for schedule(dynamic, 1) if(!params.parallel_step && !params.device)
+        for (long long t = 0; t < num_tasks; ++t) {
+            run_sweep_task(sweep_error, [&] {
+                const SweepTask& task = tasks[t];
+                results->submit(task.sequence, run_experiment(params, task, prob, obj_dict, metrics.get()));
+            });
+        }
+    }
+
+    if (!root) {
+        return 0;
+    }
+    if (!sweep_error.empty()) {
+        // The results of the skipped runs are missing, so finish() reports a gap.
+        try {
+            results->finish();
+            if (metrics) {
+                metrics->finish();
+            }
+        }
+        catch (const std::runtime_error&) {
+        }
+        std::cerr << "Error: " << sweep_error << std::endl;
+        return -1;
+    }
+    try {
+        results->finish();
+        if (metrics) {
+            metrics->finish();
+            if (metrics->dropped() > 0) {
+                std::cerr << "Warning: " << metrics->dropped() << " metrics samples were dropped; "
+                    << "raise --sample_interval for a complete stream." << std::endl;
             }
-            aggregator.close();
+        }
+    }
+    catch (const std::runtime_error& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return -1;
+    }
+    if (checkpointed) {
+        // Every row is in the results file now, so a later --resume starts over.
+        for (const SweepTask& task : tasks) {
+            std::remove(checkpoint_filename(params, task, ".antdone").c_str());
         }
     }
 
     auto total_end_time = std::chrono::high_resolution_clock::now();
     auto total_duration = std::chrono::duration_cast<std::chrono::seconds>(total_end_time - total_start_time);
     std::cout << "\nTotal execution time: " << total_duration.count() << " seconds" << std::endl;
+    report_profile(params);
 
     std::cout << "Simulation complete. Data written to " << params.csv_filename << std::endl;
 
@@ -0,0 +1,34 @@
+#include "ant_intelligence/ConvergenceDetector.h"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+ConvergenceDetector::ConvergenceDetector(std::size_t window, double tolerance)
+    : window(window)
+    , tolerance(tolerance)
+{
+    if (enabled() && window == 0) {
+        throw std::invalid_argument("A convergence window needs at least one sample interval");
+    }
+}
+
+bool ConvergenceDetector::add(double value) {
+    if (!enabled() || settled) {
+        return settled;
+    }
+    samples.push_back(value);
+    if (samples.size() > window + 1) {
+        samples.pop_front();
+    }
+    if (samples.size() < window + 1) {
+        return false;
+    }
+    const auto range = std::minmax_element(samples.begin(), samples.end());
+    double level = 0.0;
+    for (double sample : samples) {
+        level += std::abs(sample);
+    }
+    level /= static_cast<double>(samples.size());
+    settled = *range.second - *range.first <= tolerance * level;
+    return settled;
+}
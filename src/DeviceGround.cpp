@@ -0,0 +1,431 @@
+// The inline helpers of these headers are called inside target regions, so
+// they are included first and compiled for the device as well. Their
+// standard headers come before the declare target block.
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <vector>
+#pragma omp declare target
+#include "ant_intelligence/Config.h"
+#include "ant_intelligence/MemoryRing.h"
+#include "ant_intelligence/Neighborhood.h"
+#include "ant_intelligence/Rng.h"
+#pragma omp end declare target
+
+#include "ant_intelligence/DeviceGround.h"
+#include "ant_intelligence/Profiling.h"
+#include <stdexcept>
+#include <utility>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace {
+    /** @brief Copy n values to the device, where it stays until releaseOnDevice() */
+    template <typename T>
+    void mapToDevice(T* data, std::size_t n) {
+#pragma omp target enter data map(to: data[0:n])
+    }
+
+    /** @brief Reserve device storage for n values without copying them */
+    template <typename T>
+    void allocOnDevice(T* data, std::size_t n) {
+#pragma omp target enter data map(alloc: data[0:n])
+    }
+
+    /** @brief Free the device copy of n values */
+    template <typename T>
+    void releaseOnDevice(T* data, std::size_t n) {
+#pragma omp target exit data map(delete: data[0:n])
+    }
+
+    /** @brief Refresh n host values from their device copy */
+    template <typename T>
+    void copyFromDevice(T* data, std::size_t n) {
+#pragma omp target update from(data[0:n])
+    }
+
+    // Proposal of an ant that leaves its cell as it is.
+    constexpr std::uint8_t NO_WRITE = 0xFF;
+    constexpr std::uint8_t NONE = static_cast<std::uint8_t>(AIConfig::ObjectType::None);
+}
+
+DeviceGround::DeviceGround(const Ground& initial)
+    : width(initial.width)
+    , length(initial.length)
+    , grid(initial.width, initial.length)
+    , colony(initial.colony)
+    , densityRamp(initial.densityRamp)
+    , similarityThreshold(initial.similarityThreshold)
+    , cooldownDuration(initial.cooldown_duration)
+    , neighborhood(initial.neighborhood)
+    , lanes(Neighborhood::laneMask(initial.neighborhood))
+    , seed(initial.seed)
+    , objectFills(initial.objectFills)
+    , moveSteps(initial.moveSteps)
+    , workSteps(initial.workSteps)
+    , interactions(initial.interactionCounter)
+{
+    const DirectionSampler& sampler = initial.directionSampler;
+    if (sampler.size() != AIConfig::NUM_DIRECTIONS) {
+        throw std::invalid_argument("DeviceGround needs one movement probability per direction");
+    }
+    const std::size_t tableSize = static_cast<std::size_t>(AIConfig::NUM_DIRECTIONS) * AIConfig::NUM_DIRECTIONS;
+    acceptance.assign(sampler.acceptanceTable(), sampler.acceptanceTable() + tableSize);
+    alias.assign(sampler.aliasTable(), sampler.aliasTable() + tableSize);
+    initial.grid.exportRowMajor(grid.data());
+
+    // Device ant i is the ant with id i, which makes its id implicit.
+    std::vector<std::uint32_t> order(colony.size());
+    for (std::size_t i = 0; i < colony.size(); ++i) {
+        order[colony.getId(i)] = static_cast<std::uint32_t>(i);
+    }
+    colony.permute(order);
+
+    const std::size_t n = colony.size();
+    const std::size_t numCells = grid.size();
+    cellHead.assign(numCells, -1);
+    antNext.assign(n, -1);
+    proposals.assign(n, NO_WRITE);
+    directionSnapshot.assign(n, 0);
+    labels.assign(numCells, -1);
+    nextLabels.assign(numCells, -1);
+
+    forEachState([](auto* data, std::size_t count) { mapToDevice(data, count); });
+    forEachScratch([](auto* data, std::size_t count) { allocOnDevice(data, count); });
+    indexCells();
+}
+
+DeviceGround::~DeviceGround() {
+    forEachState([](auto* data, std::size_t count) { releaseOnDevice(data, count); });
+    forEachScratch([](auto* data, std::size_t count) { releaseOnDevice(data, count); });
+}
+
+template <typename F>
+void DeviceGround::forEachState(F&& apply) {
+    apply(grid.data(), grid.size());
+    apply(colony.xs.data(), colony.xs.size());
+    apply(colony.ys.data(), colony.ys.size());
+    apply(colony.prevDirections.data(), colony.prevDirections.size());
+    apply(colony.loads.data(), colony.loads.size());
+    apply(colony.cooldowns.data(), colony.cooldowns.size());
+    apply(colony.memory.data(), colony.memory.size());
+    apply(colony.memoryHead.data(), colony.memoryHead.size());
+    apply(colony.memoryCount.data(), colony.memoryCount.size());
+    apply(colony.memoryCapacity.data(), colony.memoryCapacity.size());
+    apply(colony.memoryTypeCounts.data(), colony.memoryTypeCounts.size());
+    apply(acceptance.data(), acceptance.size());
+    apply(alias.data(), alias.size());
+    apply(densityRamp[0].data(), densityRamp.size() * densityRamp[0].size());
+    apply(cellHead.data(), cellHead.size());
+}
+
+template <typename F>
+void DeviceGround::forEachScratch(F&& apply) {
+    apply(antNext.data(), antNext.size());
+    apply(proposals.data(), proposals.size());
+    apply(directionSnapshot.data(), directionSnapshot.size());
+    apply(labels.data(), labels.size());
+    apply(nextLabels.data(), nextLabels.size());
+}
+
+bool DeviceGround::deviceAvailable() {
+#ifdef _OPENMP
+    return omp_get_num_devices() > 0;
+#else
+    return false;
+#endif
+}
+
+void DeviceGround::moveAnts() {
+    ANT_PROFILE_SCOPE(MoveAnts);
+    const int n = static_cast<int>(colony.size());
+    const int w = width;
+    const int l = length;
+    int* xs = colony.xs.data();
+    int* ys = colony.ys.data();
+    std::uint8_t* directions = colony.prevDirections.data();
+    int* heads = cellHead.data();
+    const double* accept = acceptance.data();
+    const int* aliases = alias.data();
+    const std::uint64_t key = seed;
+    const std::uint64_t stream = Ground::streamId(Ground::RngStream::Move, 0);
+    const std::uint64_t hashed = CounterRng::counterHash(moveSteps);
+#pragma omp target teams distribute parallel for
+    for (int i = 0; i < n; ++i) {
+        int x = xs[i];
+        int y = ys[i];
+        // Empty the list of the cell being left; indexCells() refills the lists.
+#pragma omp atomic write
+        heads[y * w + x] = -1;
+
+        // Ant::moveStep with the DirectionSampler draw spelled out.
+        CounterRng gen = CounterRng::fromState(CounterRng::keyFromCounterHash(key, stream ^ static_cast<std::uint64_t>(i), hashed));
+        int direction;
+        if (Neighborhood::isInterior(x, y, w, l)) {
+            const int column = gen.uniformInt(AIConfig::NUM_DIRECTIONS);
+            const double coin = gen.uniform();
+            const int slot = directions[i] * AIConfig::NUM_DIRECTIONS + column;
+            direction = coin < accept[slot] ? column : aliases[slot];
+        }
+        else {
+            const int mask = Neighborhood::validMask(x, y, w, l);
+            direction = Neighborhood::nthValidDirection(mask, gen.uniformInt(Neighborhood::countMask(mask)));
+        }
+        if (direction >= 0) {
+            xs[i] = x + AIConfig::DIRECTION_DX[direction];
+            ys[i] = y + AIConfig::DIRECTION_DY[direction];
+            directions[i] = static_cast<std::uint8_t>(direction);
+        }
+    }
+    ++moveSteps;
+    indexCells();
+}
+
+void DeviceGround::indexCells() {
+    const int n = static_cast<int>(colony.size());
+    const int w = width;
+    const int* xs = colony.xs.data();
+    const int* ys = colony.ys.data();
+    int* heads = cellHead.data();
+    int* next = antNext.data();
+#pragma omp target teams distribute parallel for
+    for (int i = 0; i < n; ++i) {
+        const int cell = ys[i] * w + xs[i];
+        int previous;
+#pragma omp atomic capture
+        { previous = heads[cell]; heads[cell] = i; }
+        next[i] = previous;
+    }
+}
+
+void DeviceGround::assignWork() {
+    ANT_PROFILE_SCOPE(AssignWork);
+    const int n = static_cast<int>(colony.size());
+    const int w = width;
+    const int l = length;
+    const AIConfig::NeighborhoodType type = neighborhood;
+    const std::uint64_t laneBits = lanes;
+    const int stride = colony.stride;
+    std::uint8_t* cells = grid.data();
+    const int* xs = colony.xs.data();
+    const int* ys = colony.ys.data();
+    std::uint8_t* loads = colony.loads.data();
+    std::uint8_t* memory = colony.memory.data();
+    std::uint16_t* memoryHead = colony.memoryHead.data();
+    std::uint16_t* memoryCount = colony.memoryCount.data();
+    const std::uint16_t* memoryCapacity = colony.memoryCapacity.data();
+    std::uint16_t* typeCounts = colony.memoryTypeCounts.data();
+    const double* ramp = densityRamp[0].data();
+    const int rampRow = static_cast<int>(densityRamp[0].size());
+    const int* heads = cellHead.data();
+    const int* next = antNext.data();
+    std::uint8_t* proposed = proposals.data();
+    const std::uint64_t key = seed;
+    const std::uint64_t stream = Ground::streamId(Ground::RngStream::Work, 0);
+    const std::uint64_t hashed = CounterRng::counterHash(workSteps);
+
+    // Propose: every decision reads the grid as it was before the pass, so
+    // the grid is left alone until all ants have decided.
+#pragma omp target teams distribute parallel for
+    for (int i = 0; i < n; ++i) {
+        const int x = xs[i];
+        const int y = ys[i];
+        const int cell = y * w + x;
+        // Only the lowest id on a cell may change it.
+        bool owner = true;
+        for (int j = heads[cell]; j != -1; j = next[j]) {
+            if (j < i) {
+                owner = false;
+                break;
+            }
+        }
+
+        CounterRng gen = CounterRng::fromState(CounterRng::keyFromCounterHash(key, stream ^ static_cast<std::uint64_t>(i), hashed));
+        std::uint8_t* ring = memory + static_cast<std::size_t>(i) * stride;
+        std::uint16_t* counts = typeCounts + static_cast<std::size_t>(i) * AIConfig::NUM_OBJECT_TYPES;
+        const int capacity = memoryCapacity[i];
+        const std::uint8_t groundType = cells[cell];
+        const std::uint8_t carried = loads[i];
+        const double* densities = ramp + Neighborhood::count(x, y, w, l, type) * rampRow;
+        std::uint8_t proposal = NO_WRITE;
+
+        MemoryRing::push(ring, memoryHead[i], memoryCount[i], capacity, counts, groundType);
+        if (carried == NONE) {
+            if (groundType != NONE) {
+                const int matches = Neighborhood::countMatches(Neighborhood::gather(cells, x, y, w, l), groundType, laneBits);
+                if (gen.uniform() > densities[matches] && owner) {
+                    loads[i] = groundType;
+                    proposal = NONE;
+                    MemoryRing::push(ring, memoryHead[i], memoryCount[i], capacity, counts, groundType);
+                }
+            }
+        }
+        else {
+            MemoryRing::push(ring, memoryHead[i], memoryCount[i], capacity, counts, carried);
+            const int matches = Neighborhood::countMatches(Neighborhood::gather(cells, x, y, w, l), carried, laneBits);
+            if (gen.uniform() <= densities[matches] && owner) {
+                loads[i] = groundType;
+                proposal = carried;
+                MemoryRing::push(ring, memoryHead[i], memoryCount[i], capacity, counts, carried);
+                MemoryRing::push(ring, memoryHead[i], memoryCount[i], capacity, counts, groundType);
+            }
+        }
+        proposed[i] = proposal;
+    }
+
+    // Commit: at most one proposal per cell.
+#pragma omp target teams distribute parallel for
+    for (int i = 0; i < n; ++i) {
+        if (proposed[i] != NO_WRITE) {
+            cells[ys[i] * w + xs[i]] = proposed[i];
+        }
+    }
+    ++workSteps;
+}
+
+void DeviceGround::handleAntInteractions(int /*currentIteration*/) {
+    ANT_PROFILE_SCOPE(Interactions);
+    const int n = static_cast<int>(colony.size());
+    const int w = width;
+    const int l = length;
+    const int stencil = Neighborhood::stencilMask(neighborhood);
+    const int threshold = similarityThreshold;
+    const int cooldown = cooldownDuration;
+    const int* xs = colony.xs.data();
+    const int* ys = colony.ys.data();
+    std::uint8_t* directions = colony.prevDirections.data();
+    const std::uint8_t* loads = colony.loads.data();
+    int* cooldowns = colony.cooldowns.data();
+    const std::uint16_t* typeCounts = colony.memoryTypeCounts.data();
+    const int* heads = cellHead.data();
+    const int* next = antNext.data();
+    std::uint8_t* previous = directionSnapshot.data();
+
+#pragma omp target teams distribute parallel for
+    for (int i = 0; i < n; ++i) {
+        previous[i] = directions[i];
+    }
+
+    long long found = 0;
+#pragma omp target teams distribute parallel for reduction(+:found) map(tofrom: found)
+    for (int i = 0; i < n; ++i) {
+        if (cooldowns[i] == 0 && loads[i] != NONE) {
+            const int x = xs[i];
+            const int y = ys[i];
+            const int type = loads[i];
+            // First direction with a similar ant; the lowest id within its cell.
+            int partner = -1;
+            for (int d = 0; d < AIConfig::NUM_DIRECTIONS && partner < 0; ++d) {
+                const int nx = x + AIConfig::DIRECTION_DX[d];
+                const int ny = y + AIConfig::DIRECTION_DY[d];
+                if (!(stencil & (1 << d)) || nx < 0 || nx >= w || ny < 0 || ny >= l) {
+                    continue;
+                }
+                for (int j = heads[ny * w + nx]; j != -1; j = next[j]) {
+                    if (typeCounts[static_cast<std::size_t>(j) * AIConfig::NUM_OBJECT_TYPES + type] >= threshold
+                        && (partner < 0 || j < partner)) {
+                        partner = j;
+                    }
+                }
+            }
+            if (partner >= 0) {
+                directions[i] = static_cast<std::uint8_t>((previous[partner] + 4) % AIConfig::NUM_DIRECTIONS);
+                cooldowns[i] = cooldown;
+                ++found;
+            }
+        }
+        if (cooldowns[i] > 0) {
+            --cooldowns[i];
+        }
+    }
+    interactions += found;
+}
+
+void DeviceGround::step() {
+    ANT_PROFILE_SCOPE(Step);
+    moveAnts();
+    assignWork();
+    handleAntInteractions(0);
+}
+
+double DeviceGround::averageClusterSize() {
+    ANT_PROFILE_SCOPE(ClusterSize);
+    const int numCells = static_cast<int>(grid.size());
+    const int w = width;
+    const int l = length;
+    const std::uint8_t* cells = grid.data();
+    int* current = labels.data();
+    int* updated = nextLabels.data();
+
+    // Every object starts as its own cluster, labelled by its cell index.
+#pragma omp target teams distribute parallel for
+    for (int c = 0; c < numCells; ++c) {
+        current[c] = cells[c] != NONE ? c : -1;
+    }
+
+    // Each sweep takes the smallest label among a cell, its same-type
+    // neighbours and the cell its label points to, which also shortcuts long
+    // chains. At the fixed point every cluster carries the index of its
+    // smallest cell.
+    int changed = 1;
+    while (changed) {
+        changed = 0;
+#pragma omp target teams distribute parallel for reduction(max:changed) map(tofrom: changed)
+        for (int c = 0; c < numCells; ++c) {
+            const int own = current[c];
+            if (own < 0) {
+                updated[c] = -1;
+                continue;
+            }
+            const int x = c % w;
+            const int y = c / w;
+            int best = current[own];
+            for (int d = 0; d < AIConfig::NUM_DIRECTIONS; ++d) {
+                const int nx = x + AIConfig::DIRECTION_DX[d];
+                const int ny = y + AIConfig::DIRECTION_DY[d];
+                if (nx >= 0 && nx < w && ny >= 0 && ny < l && cells[ny * w + nx] == cells[c]) {
+                    best = current[ny * w + nx] < best ? current[ny * w + nx] : best;
+                }
+            }
+            updated[c] = best;
+            if (best != own) {
+                changed = 1;
+            }
+        }
+        std::swap(current, updated);
+    }
+
+    long long objects = 0;
+    long long clusters = 0;
+#pragma omp target teams distribute parallel for reduction(+:objects, clusters) map(tofrom: objects, clusters)
+    for (int c = 0; c < numCells; ++c) {
+        if (current[c] >= 0) {
+            ++objects;
+            if (current[c] == c) {
+                ++clusters;
+            }
+        }
+    }
+    return clusters == 0 ? 0.0 : static_cast<double>(objects) / static_cast<double>(clusters);
+}
+
+void DeviceGround::snapshot(FrameSnapshot& frame) {
+    ANT_PROFILE_SCOPE(Snapshot);
+    copyFromDevice(grid.data(), grid.size());
+    copyFromDevice(colony.xs.data(), colony.xs.size());
+    copyFromDevice(colony.ys.data(), colony.ys.size());
+    frame.width = width;
+    frame.length = length;
+    frame.types.assign(grid.data(), grid.data() + grid.size());
+    frame.antX = colony.xs;
+    frame.antY = colony.ys;
+}
+
+void DeviceGround::saveState(std::ostream& out) {
+    forEachState([](auto* data, std::size_t count) { copyFromDevice(data, count); });
+    const Ground::StateCounters counters{ seed, objectFills, moveSteps, workSteps, interactions };
+    Ground::writeState(out, width, length, counters, grid.data(), colony);
+}
@@ -0,0 +1,96 @@
+#include "ant_intelligence/DirectionSampler.h"
+#include <cstddef>
+#include <numeric>
+
+DirectionSampler::DirectionSampler(const std::vector<double>& probabilities)
+    : numDirections(static_cast<int>(probabilities.size()))
+    , acceptance(probabilities.size() * probabilities.size(), 1.0)
+    , alias(probabilities.size() * probabilities.size(), 0)
+    , weights(probabilities)
+{
+    if (numDirections == 0) {
+        return;
+    }
+
+    double sum = std::accumulate(weights.begin(), weights.end(), 0.0);
+    for (auto& w : weights) {
+        // Degenerate input falls back to a uniform choice.
+        w = (sum > 0.0) ? w / sum : 1.0 / numDirections;
+    }
+
+    std::vector<double> rotated(numDirections);
+    for (int prev = 0; prev < numDirections; ++prev) {
+        // Same rotation as Ant::getRandomWeightedDirection: entry d holds the
+        // weight of turning (d - prev) steps.
+        for (int d = 0; d < numDirections; ++d) {
+            rotated[d] = weights[((d - prev) % numDirections + numDirections) % numDirections];
+        }
+        buildTable(prev, rotated);
+    }
+}
+
+void DirectionSampler::buildTable(int row, const std::vector<double>& distribution) {
+    const int n = numDirections;
+    double* rowAcceptance = &acceptance[static_cast<std::size_t>(row) * n];
+    int* rowAlias = &alias[static_cast<std::size_t>(row) * n];
+
+    // Vose's alias method: split columns into under- and over-full worklists.
+    std::vector<double> scaled(n);
+    std::vector<int> small;
+    std::vector<int> large;
+    for (int i = 0; i < n; ++i) {
+        scaled[i] = distribution[i] * n;
+        rowAlias[i] = i;
+        if (scaled[i] < 1.0) {
+            small.push_back(i);
+        }
+        else {
+            large.push_back(i);
+        }
+    }
+
+    while (!small.empty() && !large.empty()) {
+        int s = small.back();
+        small.pop_back();
+        int l = large.back();
+        large.pop_back();
+
+        rowAcceptance[s] = scaled[s];
+        rowAlias[s] = l;
+        scaled[l] = (scaled[l] + scaled[s]) - 1.0;
+        if (scaled[l] < 1.0) {
+            small.push_back(l);
+        }
+        else {
+            large.push_back(l);
+        }
+    }
+
+    // Leftovers are full columns up to rounding error.
+    for (int i : large) {
+        rowAcceptance[i] = 1.0;
+    }
+    for (int i : small) {
+        rowAcceptance[i] = 1.0;
+    }
+}
+
+int DirectionSampler::sample(int prevDirection, CounterRng& gen) const {
+    if (numDirections == 0) {
+        return 0;
+    }
+    int row = ((prevDirection % numDirections) + numDirections) % numDirections;
+    int column = gen.uniformInt(numDirections);
+    double coin = gen.uniform();
+
+    std::size_t idx = static_cast<std::size_t>(row) * numDirections + column;
+    return (coin < acceptance[idx]) ? column : alias[idx];
+}
+
+double DirectionSampler::probability(int prevDirection, int newDirection) const {
+    if (numDirections == 0) {
+        return 0.0;
+    }
+    int turn = ((newDirection - prevDirection) % numDirections + numDirections) % numDirections;
+    return weights[turn];
+}
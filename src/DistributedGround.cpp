@@ -0,0 +1,585 @@
+#include "ant_intelligence/DistributedGround.h"
+#include "ant_intelligence/Ant.h"
+#include "ant_intelligence/BinaryIO.h"
+#include "ant_intelligence/Neighborhood.h"
+#include "ant_intelligence/Profiling.h"
+#include <algorithm>
+#include <numeric>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+namespace {
+    Communicator::Buffer toBuffer(const std::ostringstream& out) {
+        const std::string bytes = out.str();
+        return Communicator::Buffer(bytes.begin(), bytes.end());
+    }
+
+    std::istringstream fromBuffer(const Communicator::Buffer& buffer) {
+        return std::istringstream(std::string(buffer.begin(), buffer.end()), std::ios_base::binary);
+    }
+
+    // Reorder a colony so that index order is ascending id order.
+    void sortById(AntColony& colony) {
+        std::vector<std::uint32_t> order(colony.size());
+        std::iota(order.begin(), order.end(), 0u);
+        std::sort(order.begin(), order.end(),
+            [&](std::uint32_t a, std::uint32_t b) { return colony.getId(a) < colony.getId(b); });
+        colony.permute(order);
+    }
+
+    // Cluster labels of one owned edge row, as sent to the root for merging
+    struct EdgeRow {
+        std::vector<std::uint8_t> types;
+        std::vector<std::int32_t> labels;
+    };
+
+    void writeEdgeRow(std::ostream& out, ClusterTracker& tracker, const Grid& rows, int y) {
+        for (int x = 0; x < rows.getWidth(); ++x) {
+            BinaryIO::write<std::uint8_t>(out, static_cast<std::uint8_t>(rows.get(x, y)));
+            BinaryIO::write<std::int32_t>(out, tracker.clusterOf(rows, x, y));
+        }
+    }
+
+    EdgeRow readEdgeRow(std::istream& in, int width) {
+        EdgeRow row;
+        row.types.resize(width);
+        row.labels.resize(width);
+        for (int x = 0; x < width; ++x) {
+            row.types[x] = BinaryIO::read<std::uint8_t>(in);
+            row.labels[x] = BinaryIO::read<std::int32_t>(in);
+        }
+        return row;
+    }
+}
+
+DistributedGround::DistributedGround(Communicator& comm,
+    int width,
+    int length,
+    const std::vector<double>& probabilities,
+    const std::vector<double>& probRelu,
+    int similarityThreshold,
+    int interactionCooldown,
+    std::uint64_t seed)
+    : comm(comm)
+    , width(width)
+    , length(length)
+    , directionSampler(probabilities)
+    , densityRamp(Ground::buildDensityRamp(probRelu))
+    , similarityThreshold(similarityThreshold)
+    , cooldownDuration(interactionCooldown)
+    , lanes(Neighborhood::laneMask(AIConfig::DEFAULT_NEIGHBORHOOD))
+    , seed(seed)
+{
+    if (width <= 0 || length <= 0) {
+        throw std::invalid_argument("Invalid grid dimensions");
+    }
+    const auto rows = slabRows(length, comm.size(), comm.rank());
+    rowBegin = rows.first;
+    rowEnd = rows.second;
+    const int owned = rowEnd - rowBegin;
+
+    grid = Grid(width, owned + 2);
+    // Halo rows beyond the edge of the ground read as off the grid, so the
+    // packed neighbour counts need no special case there.
+    if (!hasPrev()) {
+        std::fill(grid.data(), grid.data() + width, Neighborhood::OFF_GRID);
+    }
+    if (!hasNext()) {
+        std::fill(grid.data() + static_cast<std::size_t>(owned + 1) * width,
+            grid.data() + static_cast<std::size_t>(owned + 2) * width, Neighborhood::OFF_GRID);
+    }
+    ownedRows = Grid(width, owned);
+    clusterTracker = ClusterTracker(width, owned);
+    cellStart.assign(static_cast<std::size_t>(width) * (owned + 2) + 1, 0);
+
+    tilesX = (width + AIConfig::PARALLEL_TILE_SIZE - 1) / AIConfig::PARALLEL_TILE_SIZE;
+    firstTileRow = rowBegin / AIConfig::PARALLEL_TILE_SIZE;
+    const int tileRows = (owned + AIConfig::PARALLEL_TILE_SIZE - 1) / AIConfig::PARALLEL_TILE_SIZE;
+    tilesByColor.assign(4, {});
+    for (int ty = 0; ty < tileRows; ++ty) {
+        // Colours follow the global tile row, as on Ground.
+        const int globalRow = firstTileRow + ty;
+        for (int tx = 0; tx < tilesX; ++tx) {
+            tilesByColor[(tx & 1) | ((globalRow & 1) << 1)].push_back(ty * tilesX + tx);
+        }
+    }
+    tileStart.assign(static_cast<std::size_t>(tilesX) * tileRows + 1, 0);
+}
+
+std::pair<int, int> DistributedGround::slabRows(int length, int ranks, int rank) {
+    if (ranks <= 0 || rank < 0 || rank >= ranks) {
+        throw std::invalid_argument("Invalid rank");
+    }
+    const int tileRows = (length + AIConfig::PARALLEL_TILE_SIZE - 1) / AIConfig::PARALLEL_TILE_SIZE;
+    if (ranks > tileRows) {
+        throw std::invalid_argument("More ranks than rows of parallel tiles");
+    }
+    const long long first = static_cast<long long>(rank) * tileRows / ranks;
+    const long long end = static_cast<long long>(rank + 1) * tileRows / ranks;
+    return { static_cast<int>(first) * AIConfig::PARALLEL_TILE_SIZE,
+        std::min(static_cast<int>(end) * AIConfig::PARALLEL_TILE_SIZE, length) };
+}
+
+void DistributedGround::addAnt(int memorySize) {
+    if (memorySize < 0 || memorySize > UINT16_MAX) {
+        throw std::invalid_argument("Invalid ant memory size");
+    }
+    // Every rank draws every placement, so no rank needs to be told about
+    // ants it does not own.
+    CounterRng gen(seed, Ground::streamId(Ground::RngStream::Placement, totalAnts), 0);
+    const int index = gen.uniformInt(width * length);
+    const int x = index % width;
+    const int y = index / width;
+    const int direction = gen.uniformInt(AIConfig::NUM_DIRECTIONS);
+    if (y >= rowBegin && y < rowEnd) {
+        std::size_t i = colony.add(x, y, direction, memorySize);
+        colony.setId(i, static_cast<std::uint32_t>(totalAnts));
+    }
+    ++totalAnts;
+}
+
+void DistributedGround::addObject(const std::unordered_map<AIConfig::ObjectType, double>& typeDict) {
+    Ground::ObjectSampler sampler(typeDict);
+
+    // Cells are keyed by their global row-major id, so the halo rows can be
+    // drawn here as well instead of being exchanged.
+    const int yBegin = std::max(rowBegin - 1, 0);
+    const int yEnd = std::min(rowEnd + 1, length);
+    for (int y = yBegin; y < yEnd; ++y) {
+        for (int x = 0; x < width; ++x) {
+            CounterRng gen(seed, Ground::streamId(Ground::RngStream::Objects,
+                static_cast<std::uint64_t>(y) * width + x), objectFills);
+            auto type = sampler(gen);
+            if (type != AIConfig::ObjectType::None) {
+                grid.set(x, localRow(y), type);
+            }
+        }
+    }
+    ++objectFills;
+}
+
+void DistributedGround::moveAnts() {
+    {
+        ANT_PROFILE_SCOPE(MoveAnts);
+        moveRng.prepare(seed, Ground::streamId(Ground::RngStream::Move, 0), moveSteps, colony.size());
+        const std::uint32_t* ids = colony.idData();
+        const long long numBlocks = static_cast<long long>(
+            (colony.size() + AIConfig::RNG_BLOCK_SIZE - 1) / AIConfig::RNG_BLOCK_SIZE);
+#pragma omp parallel for schedule(static)
+        for (long long b = 0; b < numBlocks; ++b) {
+            const std::size_t begin = static_cast<std::size_t>(b) * AIConfig::RNG_BLOCK_SIZE;
+            const std::size_t end = std::min(begin + AIConfig::RNG_BLOCK_SIZE, colony.size());
+            moveRng.fill(begin, end, ids);
+            for (std::size_t i = begin; i < end; ++i) {
+                auto gen = moveRng.at(i);
+                std::pair<int, int> position{ colony.getX(i), colony.getY(i) };
+                int prevDirection = colony.getPrevDirection(i);
+                Ant::moveStep(position, prevDirection, width, length, directionSampler, gen);
+                colony.setPosition(i, position.first, position.second);
+                colony.setPrevDirection(i, prevDirection);
+            }
+        }
+        ++moveSteps;
+    }
+    migrateAnts();
+}
+
+void DistributedGround::migrateAnts() {
+    ANT_PROFILE_SCOPE(Exchange);
+    // A move is a single cell, so ants only ever leave for the adjacent slabs.
+    std::ostringstream toPrev(std::ios_base::binary);
+    std::ostringstream toNext(std::ios_base::binary);
+    std::vector<bool> gone(colony.size(), false);
+    for (std::size_t i = 0; i < colony.size(); ++i) {
+        if (colony.getY(i) < rowBegin) {
+            colony.saveAnt(i, toPrev);
+            gone[i] = true;
+        }
+        else if (colony.getY(i) >= rowEnd) {
+            colony.saveAnt(i, toNext);
+            gone[i] = true;
+        }
+    }
+    colony.remove(gone);
+
+    Communicator::Buffer fromPrev;
+    Communicator::Buffer fromNext;
+    comm.exchangeNeighbors(toBuffer(toPrev), toBuffer(toNext), fromPrev, fromNext);
+    bool arrived = false;
+    for (const Communicator::Buffer* buffer : { &fromPrev, &fromNext }) {
+        std::istringstream in = fromBuffer(*buffer);
+        while (in.peek() != std::char_traits<char>::eof()) {
+            std::size_t i = colony.loadAnt(in);
+            if (colony.getY(i) < rowBegin || colony.getY(i) >= rowEnd) {
+                throw std::runtime_error("Migrated ant does not belong to this slab");
+            }
+            arrived = true;
+        }
+    }
+    if (arrived) {
+        sortById(colony);
+    }
+}
+
+void DistributedGround::exchangeHalo() {
+    ANT_PROFILE_SCOPE(Exchange);
+    const std::size_t rowBytes = static_cast<std::size_t>(width);
+    const std::size_t owned = static_cast<std::size_t>(rowEnd - rowBegin);
+    const std::uint8_t* cells = grid.data();
+    Communicator::Buffer first(cells + rowBytes, cells + 2 * rowBytes);
+    Communicator::Buffer last(cells + owned * rowBytes, cells + (owned + 1) * rowBytes);
+    Communicator::Buffer fromPrev;
+    Communicator::Buffer fromNext;
+    comm.exchangeNeighbors(first, last, fromPrev, fromNext);
+    if ((hasPrev() && fromPrev.size() != rowBytes) || (hasNext() && fromNext.size() != rowBytes)) {
+        throw std::runtime_error("Halo row does not match the ground width");
+    }
+    std::copy(fromPrev.begin(), fromPrev.end(), grid.data());
+    std::copy(fromNext.begin(), fromNext.end(), grid.data() + (owned + 1) * rowBytes);
+}
+
+void DistributedGround::assignWork() {
+    ANT_PROFILE_SCOPE(AssignWork);
+    workRng.prepare(seed, Ground::streamId(Ground::RngStream::Work, 0), workSteps, colony.size());
+    const std::uint32_t* ids = colony.idData();
+    const long long numAgents = static_cast<long long>(colony.size());
+#pragma omp parallel for schedule(static)
+    for (long long b = 0; b < numAgents; b += AIConfig::RNG_BLOCK_SIZE) {
+        workRng.fill(static_cast<std::size_t>(b), std::min(static_cast<std::size_t>(b) + AIConfig::RNG_BLOCK_SIZE, colony.size()), ids);
+    }
+
+    // Counting sort by tile keeps the id order within each tile.
+    auto tileOf = [&](std::size_t i) {
+        return (colony.getY(i) / AIConfig::PARALLEL_TILE_SIZE - firstTileRow) * tilesX
+            + colony.getX(i) / AIConfig::PARALLEL_TILE_SIZE;
+    };
+    std::fill(tileStart.begin(), tileStart.end(), 0);
+    for (std::size_t i = 0; i < colony.size(); ++i) {
+        ++tileStart[tileOf(i) + 1];
+    }
+    std::partial_sum(tileStart.begin(), tileStart.end(), tileStart.begin());
+    std::vector<int> cursor(tileStart.begin(), tileStart.end() - 1);
+    tileAnts.resize(colony.size());
+    for (std::size_t i = 0; i < colony.size(); ++i) {
+        tileAnts[cursor[tileOf(i)]++] = static_cast<int>(i);
+    }
+
+    for (int color = 0; color < 4; ++color) {
+        const std::vector<int>& tiles = tilesByColor[color];
+        const int numTiles = static_cast<int>(tiles.size());
+#pragma omp parallel for schedule(dynamic, 1)
+        for (int t = 0; t < numTiles; ++t) {
+            const int tile = tiles[t];
+            for (int k = tileStart[tile]; k < tileStart[tile + 1]; ++k) {
+                workAnt(static_cast<std::size_t>(tileAnts[k]));
+            }
+        }
+        // The edge rows of adjacent slabs lie in tile rows of opposite parity,
+        // so colours 0-1 and 2-3 each change only one side of every slab
+        // boundary; the halos need refreshing once after each pair.
+        if (color & 1) {
+            exchangeHalo();
+        }
+    }
+    ++workSteps;
+}
+
+void DistributedGround::workAnt(std::size_t i) {
+    auto gen = workRng.at(i);
+    const int x = colony.getX(i);
+    const int y = colony.getY(i);
+    const int row = localRow(y);
+    auto groundType = grid.get(x, row);
+    auto carried = colony.getLoad(i);
+
+    colony.updateMemory(i, groundType);
+
+    if (carried == AIConfig::ObjectType::None) {
+        if (groundType != AIConfig::ObjectType::None) {
+            int neighborCount = Neighborhood::countMatches(grid.neighbors(x, row), static_cast<std::uint8_t>(groundType), lanes);
+            double pickProb = densityRamp[Neighborhood::count(x, y, width, length, neighborhood)][neighborCount];
+            if (gen.uniform() > pickProb) {
+                colony.setLoad(i, groundType);
+                grid.set(x, row, AIConfig::ObjectType::None);
+                colony.updateMemory(i, groundType);
+                ANT_PROFILE_COUNT(Picks, 1);
+            }
+        }
+    }
+    else {
+        colony.updateMemory(i, carried);
+
+        int neighborCount = Neighborhood::countMatches(grid.neighbors(x, row), static_cast<std::uint8_t>(carried), lanes);
+        double dropProb = densityRamp[Neighborhood::count(x, y, width, length, neighborhood)][neighborCount];
+        if (gen.uniform() <= dropProb) {
+            grid.set(x, row, carried);
+            colony.setLoad(i, groundType);
+            colony.updateMemory(i, carried);
+            colony.updateMemory(i, groundType);
+            if (groundType == AIConfig::ObjectType::None) {
+                ANT_PROFILE_COUNT(Drops, 1);
+            }
+            else {
+                ANT_PROFILE_COUNT(Swaps, 1);
+            }
+        }
+    }
+}
+
+void DistributedGround::handleAntInteractions(int currentIteration) {
+    (void)currentIteration;
+    interactAnts();
+}
+
+void DistributedGround::step() {
+    moveAnts();
+    assignWork();
+    interactAnts();
+}
+
+void DistributedGround::interactAnts() {
+    ANT_PROFILE_SCOPE(Interactions);
+    const std::size_t owned = colony.size();
+    candidateDirection.resize(owned);
+    candidateCounts.resize(owned * AIConfig::NUM_OBJECT_TYPES);
+    candidateCell.resize(owned);
+
+    // Ants on an edge row are candidates for the neighbouring slab as well.
+    std::ostringstream toPrev(std::ios_base::binary);
+    std::ostringstream toNext(std::ios_base::binary);
+    for (std::size_t i = 0; i < owned; ++i) {
+        const int y = colony.getY(i);
+        candidateDirection[i] = static_cast<std::uint8_t>(colony.getPrevDirection(i));
+        for (int t = 0; t < AIConfig::NUM_OBJECT_TYPES; ++t) {
+            candidateCounts[i * AIConfig::NUM_OBJECT_TYPES + t] =
+                static_cast<std::uint16_t>(colony.countMemory(i, static_cast<AIConfig::ObjectType>(t)));
+        }
+        candidateCell[i] = localRow(y) * width + colony.getX(i);
+        for (std::ostringstream* out : { y == rowBegin ? &toPrev : nullptr, y == rowEnd - 1 ? &toNext : nullptr }) {
+            if (out == nullptr) {
+                continue;
+            }
+            BinaryIO::write<std::int32_t>(*out, colony.getX(i));
+            BinaryIO::write<std::int32_t>(*out, y);
+            BinaryIO::write<std::uint8_t>(*out, candidateDirection[i]);
+            for (int t = 0; t < AIConfig::NUM_OBJECT_TYPES; ++t) {
+                BinaryIO::write<std::uint16_t>(*out, candidateCounts[i * AIConfig::NUM_OBJECT_TYPES + t]);
+            }
+        }
+    }
+    {
+        ANT_PROFILE_SCOPE(Exchange);
+        Communicator::Buffer fromPrev;
+        Communicator::Buffer fromNext;
+        comm.exchangeNeighbors(toBuffer(toPrev), toBuffer(toNext), fromPrev, fromNext);
+        for (const Communicator::Buffer* buffer : { &fromPrev, &fromNext }) {
+            std::istringstream in = fromBuffer(*buffer);
+            while (in.peek() != std::char_traits<char>::eof()) {
+                const int x = BinaryIO::read<std::int32_t>(in);
+                const int y = BinaryIO::read<std::int32_t>(in);
+                if (x < 0 || x >= width || (y != rowBegin - 1 && y != rowEnd)) {
+                    throw std::runtime_error("Neighbouring ant is not on a halo row");
+                }
+                candidateCell.push_back(localRow(y) * width + x);
+                candidateDirection.push_back(BinaryIO::read<std::uint8_t>(in));
+                for (int t = 0; t < AIConfig::NUM_OBJECT_TYPES; ++t) {
+                    candidateCounts.push_back(BinaryIO::read<std::uint16_t>(in));
+                }
+            }
+        }
+    }
+
+    // Every cell holds ants from one source only, each sent in id order, so
+    // a stable bucketing lists the ants of a cell by ascending id as on Ground.
+    std::fill(cellStart.begin(), cellStart.end(), 0);
+    for (int cell : candidateCell) {
+        ++cellStart[cell + 1];
+    }
+    std::partial_sum(cellStart.begin(), cellStart.end(), cellStart.begin());
+    cellAnts.resize(candidateCell.size());
+    {
+        std::vector<int> cursor(cellStart.begin(), cellStart.end() - 1);
+        for (std::size_t c = 0; c < candidateCell.size(); ++c) {
+            cellAnts[cursor[candidateCell[c]]++] = static_cast<int>(c);
+        }
+    }
+
+    // Decisions read only the snapshot above, so ants are independent.
+    const int stencil = Neighborhood::stencilMask(neighborhood);
+    const long long numAgents = static_cast<long long>(owned);
+    long long found = 0;
+#pragma omp parallel for schedule(static) reduction(+:found)
+    for (long long a = 0; a < numAgents; ++a) {
+        const std::size_t i = static_cast<std::size_t>(a);
+        if (colony.getCooldown(i) != 0 || colony.getLoad(i) == AIConfig::ObjectType::None) {
+            continue;
+        }
+        const int load = static_cast<int>(colony.getLoad(i));
+        const int x = colony.getX(i);
+        const int y = colony.getY(i);
+        bool matched = false;
+        for (int d = 0; d < AIConfig::NUM_DIRECTIONS && !matched; ++d) {
+            const int nx = x + AIConfig::DIRECTION_DX[d];
+            const int ny = y + AIConfig::DIRECTION_DY[d];
+            if (!(stencil & (1 << d)) || nx < 0 || nx >= width || ny < 0 || ny >= length) {
+                continue;
+            }
+            const int cell = localRow(ny) * width + nx;
+            for (int k = cellStart[cell]; k < cellStart[cell + 1]; ++k) {
+                const int c = cellAnts[k];
+                ANT_PROFILE_COUNT(InteractionChecks, 1);
+                if (candidateCounts[static_cast<std::size_t>(c) * AIConfig::NUM_OBJECT_TYPES + load] >= similarityThreshold) {
+                    ANT_PROFILE_COUNT(Interactions, 1);
+                    ++found;
+                    colony.setPrevDirection(i, (candidateDirection[c] + 4) % AIConfig::NUM_DIRECTIONS);
+                    colony.setCooldown(i, cooldownDuration);
+                    matched = true;
+                    break;
+                }
+            }
+        }
+    }
+    interactions += found;
+
+    for (std::size_t i = 0; i < owned; ++i) {
+        if (colony.getCooldown(i) > 0)
+            colony.setCooldown(i, colony.getCooldown(i) - 1);
+    }
+}
+
+double DistributedGround::averageClusterSize() {
+    ANT_PROFILE_SCOPE(ClusterSize);
+    // Each rank labels its own rows; the root then joins clusters that touch
+    // across the slab boundaries, which needs only the edge rows' labels.
+    const int owned = rowEnd - rowBegin;
+    std::copy(grid.data() + width, grid.data() + static_cast<std::size_t>(owned + 1) * width, ownedRows.data());
+    clusterTracker.invalidate();
+    std::ostringstream local(std::ios_base::binary);
+    BinaryIO::write<std::uint64_t>(local, clusterTracker.objectCount(ownedRows));
+    BinaryIO::write<std::uint64_t>(local, clusterTracker.clusterCount(ownedRows));
+    writeEdgeRow(local, clusterTracker, ownedRows, 0);
+    writeEdgeRow(local, clusterTracker, ownedRows, owned - 1);
+
+    std::vector<Communicator::Buffer> all;
+    Communicator::Buffer result;
+    {
+        ANT_PROFILE_SCOPE(Exchange);
+        comm.gather(toBuffer(local), all, 0);
+    }
+    if (comm.rank() == 0) {
+        std::uint64_t objects = 0;
+        std::uint64_t clusters = 0;
+        std::vector<EdgeRow> firstRows;
+        std::vector<EdgeRow> lastRows;
+        for (const Communicator::Buffer& buffer : all) {
+            std::istringstream in = fromBuffer(buffer);
+            objects += BinaryIO::read<std::uint64_t>(in);
+            clusters += BinaryIO::read<std::uint64_t>(in);
+            firstRows.push_back(readEdgeRow(in, width));
+            lastRows.push_back(readEdgeRow(in, width));
+        }
+
+        // Union-find over the (rank, label) pairs seen on the boundaries
+        std::unordered_map<std::uint64_t, int> nodes;
+        std::vector<int> parent;
+        auto nodeOf = [&](int rank, std::int32_t label) {
+            const std::uint64_t key = (static_cast<std::uint64_t>(rank) << 32) | static_cast<std::uint32_t>(label);
+            auto inserted = nodes.emplace(key, static_cast<int>(parent.size()));
+            if (inserted.second) {
+                parent.push_back(static_cast<int>(parent.size()));
+            }
+            return inserted.first->second;
+        };
+        auto find = [&](int node) {
+            while (parent[node] != node) {
+                parent[node] = parent[parent[node]];
+                node = parent[node];
+            }
+            return node;
+        };
+        const std::uint8_t none = static_cast<std::uint8_t>(AIConfig::ObjectType::None);
+        for (int r = 0; r + 1 < comm.size(); ++r) {
+            const EdgeRow& above = lastRows[r];
+            const EdgeRow& below = firstRows[r + 1];
+            for (int x = 0; x < width; ++x) {
+                if (above.types[x] == none) {
+                    continue;
+                }
+                for (int nx = std::max(x - 1, 0); nx <= std::min(x + 1, width - 1); ++nx) {
+                    if (below.types[nx] != above.types[x]) {
+                        continue;
+                    }
+                    int a = find(nodeOf(r, above.labels[x]));
+                    int b = find(nodeOf(r + 1, below.labels[nx]));
+                    if (a != b) {
+                        parent[b] = a;
+                        --clusters;
+                    }
+                }
+            }
+        }
+        const double average = clusters == 0 ? 0.0 : static_cast<double>(objects) / clusters;
+        result.resize(sizeof(double));
+        BinaryIO::encode(&average, 1, reinterpret_cast<char*>(result.data()));
+    }
+    {
+        ANT_PROFILE_SCOPE(Exchange);
+        comm.broadcast(result, 0);
+    }
+    double average = 0.0;
+    BinaryIO::decode(reinterpret_cast<const char*>(result.data()), 1, &average);
+    return average;
+}
+
+int DistributedGround::getInteractionCount() {
+    std::vector<std::int64_t> total{ interactions };
+    comm.allreduceSum(total);
+    return static_cast<int>(total[0]);
+}
+
+void DistributedGround::setNeighborhood(AIConfig::NeighborhoodType type) {
+    neighborhood = type;
+    lanes = Neighborhood::laneMask(type);
+}
+
+void DistributedGround::gatherState(std::ostream& out, int root) {
+    std::vector<std::int64_t> total{ interactions };
+    comm.allreduceSum(total);
+
+    const std::size_t rowBytes = static_cast<std::size_t>(width);
+    std::ostringstream local(std::ios_base::binary);
+    BinaryIO::write<std::int32_t>(local, rowBegin);
+    BinaryIO::write<std::int32_t>(local, rowEnd);
+    local.write(reinterpret_cast<const char*>(grid.data() + rowBytes),
+        static_cast<std::streamsize>(rowBytes * (rowEnd - rowBegin)));
+    BinaryIO::write<std::uint64_t>(local, colony.size());
+    for (std::size_t i = 0; i < colony.size(); ++i) {
+        colony.saveAnt(i, local);
+    }
+    std::vector<Communicator::Buffer> all;
+    comm.gather(toBuffer(local), all, root);
+    if (comm.rank() != root) {
+        return;
+    }
+
+    std::vector<std::uint8_t> rowMajor(rowBytes * length);
+    AntColony everyone;
+    everyone.reserve(totalAnts);
+    for (const Communicator::Buffer& buffer : all) {
+        std::istringstream in = fromBuffer(buffer);
+        const int first = BinaryIO::read<std::int32_t>(in);
+        const int end = BinaryIO::read<std::int32_t>(in);
+        if (first < 0 || end > length || first > end) {
+            throw std::runtime_error("Corrupt slab state");
+        }
+        BinaryIO::readBytes(in, reinterpret_cast<char*>(rowMajor.data() + first * rowBytes), (end - first) * rowBytes);
+        const std::uint64_t count = BinaryIO::read<std::uint64_t>(in);
+        for (std::uint64_t k = 0; k < count; ++k) {
+            everyone.loadAnt(in);
+        }
+    }
+    sortById(everyone);
+    const Ground::StateCounters counters{ seed, objectFills, moveSteps, workSteps, total[0] };
+    Ground::writeState(out, width, length, counters, rowMajor.data(), everyone);
+}
@@ -0,0 +1,54 @@
+#include "ant_intelligence/DistributedRun.h"
+#include <cstddef>
+
+std::vector<ResultRow> DistributedRun::run(DistributedGround& ground, Communicator& comm, const ResultRow& tag,
+    const Options& options, MetricsStream* metrics, std::ostream* progress) {
+    std::vector<ResultRow> rows;
+    const bool root = comm.rank() == 0;
+    ConvergenceDetector convergence(static_cast<std::size_t>(options.convergeWindow), options.convergeTolerance);
+    int convergedIteration = -1;
+    for (int i = 0; i < options.iterations && convergedIteration < 0; ++i) {
+        if (options.fusedStep) {
+            ground.step();
+        }
+        else {
+            ground.moveAnts();
+            ground.assignWork();
+            ground.handleAntInteractions(i);
+        }
+
+        // Both conditions come from options, so every rank enters the
+        // collective metrics at the same iterations.
+        const bool record = i % options.sampleInterval == 0;
+        const bool report = options.reportInterval > 0 && i % options.reportInterval == 0;
+        if (!record && !report) {
+            continue;
+        }
+        const double clusterSize = ground.averageClusterSize();
+        const int interactionCount = ground.getInteractionCount();
+        if (root && record) {
+            rows.push_back({ tag.cooldown, tag.threshold, tag.run, i, clusterSize, interactionCount });
+            if (metrics) {
+                metrics->publishSample(rows.back());
+            }
+        }
+        // Every rank sees the same combined value, so all stop together.
+        if (record && convergence.add(clusterSize)) {
+            convergedIteration = i;
+        }
+        if (root && report && progress) {
+            *progress << "C: " << tag.cooldown << ", T: " << tag.threshold
+                << ", Exp: " << tag.run
+                << ", Iter: " << i << "/" << options.iterations
+                << ", Cluster: " << clusterSize
+                << ", Interact: " << interactionCount << std::endl;
+        }
+    }
+    for (auto& row : rows) {
+        row.convergedIteration = convergedIteration;
+    }
+    if (root && metrics) {
+        metrics->publishRunEnd(tag.cooldown, tag.threshold, tag.run, convergedIteration);
+    }
+    return rows;
+}
@@ -0,0 +1,176 @@
+#include "ant_intelligence/FramePipeline.h"
+#include "ant_intelligence/Config.h"
+#include "ant_intelligence/Ground.h"
+#include "ant_intelligence/Profiling.h"
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+
+namespace {
+    struct Bgr {
+        std::uint8_t b, g, r;
+    };
+
+    Bgr colorOf(std::uint8_t type) {
+        switch (static_cast<AIConfig::ObjectType>(type)) {
+        case AIConfig::ObjectType::Food:  return { 0, 255, 0 };    // Green
+        case AIConfig::ObjectType::Egg:   return { 0, 255, 255 };  // Yellow
+        case AIConfig::ObjectType::Waste: return { 255, 0, 255 };  // Magenta
+        default:                          return { 128, 128, 128 };
+        }
+    }
+
+    // Paint the disc of one cell using a precomputed per-row span table.
+    void paintCell(std::vector<std::uint8_t>& bgr, int cols, int scale, int row, int col,
+        const std::vector<int>& halfSpan, Bgr color) {
+        const int center = scale / 2;
+        const int radius = scale / 3;
+        for (int dy = -radius; dy <= radius; ++dy) {
+            int py = row * scale + center + dy;
+            int span = halfSpan[dy + radius];
+            std::uint8_t* pixel = &bgr[(static_cast<std::size_t>(py) * cols + col * scale + center - span) * 3];
+            for (int dx = -span; dx <= span; ++dx) {
+                *pixel++ = color.b;
+                *pixel++ = color.g;
+                *pixel++ = color.r;
+            }
+        }
+    }
+}
+
+FramePipeline::FramePipeline(int scale, std::size_t queueDepth, FrameSink sink)
+    : scale(scale)
+    , sink(std::move(sink))
+    , slots(queueDepth > 0 ? queueDepth : 1)
+{
+    if (scale <= 0) {
+        throw std::invalid_argument("Frame scale must be positive");
+    }
+    worker = std::thread(&FramePipeline::run, this);
+}
+
+FramePipeline::~FramePipeline() {
+    try {
+        close();
+    }
+    catch (...) {
+        // Destructors must not throw; call close() to observe sink errors.
+    }
+}
+
+void FramePipeline::submit(const Ground& ground) {
+    submit([&ground](FrameSnapshot& frame) { ground.snapshot(frame); });
+}
+
+void FramePipeline::submit(const std::function<void(FrameSnapshot&)>& capture) {
+    std::size_t slot;
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        notFull.wait(lock, [this] { return queued < slots.size() || closing; });
+        if (closing) {
+            throw std::runtime_error("FramePipeline::submit called after close");
+        }
+        slot = (head + queued) % slots.size();
+    }
+
+    // The worker never touches a slot until it is counted as queued.
+    capture(slots[slot]);
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        ++queued;
+    }
+    notEmpty.notify_one();
+}
+
+void FramePipeline::close() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        closing = true;
+    }
+    notEmpty.notify_all();
+    notFull.notify_all();
+    if (worker.joinable()) {
+        worker.join();
+    }
+    if (error) {
+        std::exception_ptr pending = error;
+        error = nullptr;
+        std::rethrow_exception(pending);
+    }
+}
+
+std::size_t FramePipeline::framesWritten() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return written;
+}
+
+void FramePipeline::run() {
+    std::vector<std::uint8_t> image;
+    for (;;) {
+        std::size_t slot;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            notEmpty.wait(lock, [this] { return queued > 0 || closing; });
+            if (queued == 0) {
+                return;
+            }
+            slot = head;
+        }
+
+        const FrameSnapshot& frame = slots[slot];
+        if (!error) {
+            try {
+                ANT_PROFILE_SCOPE(ShowGround);
+                rasterize(frame, scale, image);
+                sink(image.data(), frame.width * scale, frame.length * scale);
+            }
+            catch (...) {
+                // Keep draining so the producer never blocks on a dead worker.
+                error = std::current_exception();
+            }
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            head = (head + 1) % slots.size();
+            --queued;
+            if (!error) {
+                ++written;
+            }
+        }
+        notFull.notify_one();
+    }
+}
+
+void FramePipeline::rasterize(const FrameSnapshot& frame, int scale, std::vector<std::uint8_t>& bgr) {
+    const int rows = frame.width * scale;
+    const int cols = frame.length * scale;
+    bgr.assign(static_cast<std::size_t>(rows) * cols * 3, 255);
+
+    const int radius = scale / 3;
+    std::vector<int> halfSpan(2 * radius + 1);
+    for (int dy = -radius; dy <= radius; ++dy) {
+        int span = 0;
+        while ((span + 1) * (span + 1) + dy * dy <= radius * radius) {
+            ++span;
+        }
+        halfSpan[dy + radius] = span;
+    }
+
+    const std::uint8_t none = static_cast<std::uint8_t>(AIConfig::ObjectType::None);
+    for (int y = 0; y < frame.length; ++y) {
+        for (int x = 0; x < frame.width; ++x) {
+            std::uint8_t type = frame.types[static_cast<std::size_t>(y) * frame.width + x];
+            if (type != none) {
+                paintCell(bgr, cols, scale, x, y, halfSpan, colorOf(type));
+            }
+        }
+    }
+
+    const Bgr antColor{ 0, 0, 255 }; // Red
+    const std::size_t ants = std::min(frame.antX.size(), frame.antY.size());
+    for (std::size_t i = 0; i < ants; ++i) {
+        paintCell(bgr, cols, scale, frame.antX[i], frame.antY[i], halfSpan, antColor);
+    }
+}
@@ -0,0 +1,76 @@
+#include "ant_intelligence/Grid.h"
+#include <algorithm>
+
+namespace {
+    std::size_t blocksFor(int cells) {
+        return (static_cast<std::size_t>(cells) + AIConfig::GRID_TILE_SIZE - 1) >> AIConfig::GRID_TILE_SHIFT;
+    }
+}
+
+Grid::Grid(int width, int length, AIConfig::GridLayout layout)
+    : width(width > 0 ? width : 0)
+    , length(length > 0 ? length : 0)
+    , layout(layout)
+{
+    std::size_t storage = size();
+    if (layout == AIConfig::GridLayout::Tiled) {
+        tilesX = blocksFor(this->width);
+        storage = tilesX * blocksFor(this->length) << (2 * AIConfig::GRID_TILE_SHIFT);
+    }
+    cells.assign(storage, static_cast<std::uint8_t>(AIConfig::ObjectType::None));
+}
+
+template <typename Visit>
+void Grid::forEachRun(Visit visit) const {
+    if (layout == AIConfig::GridLayout::RowMajor) {
+        for (int y = 0; y < length; ++y) {
+            visit(y, 0, index(0, y), static_cast<std::size_t>(width));
+        }
+        return;
+    }
+    for (int y = 0; y < length; ++y) {
+        for (int x = 0; x < width; x += AIConfig::GRID_TILE_SIZE) {
+            visit(y, x, index(x, y), static_cast<std::size_t>(std::min(AIConfig::GRID_TILE_SIZE, width - x)));
+        }
+    }
+}
+
+void Grid::fill(AIConfig::ObjectType type) {
+    // Tile padding is never read, so it can take the fill value too.
+    std::fill(cells.begin(), cells.end(), static_cast<std::uint8_t>(type));
+}
+
+std::size_t Grid::count(AIConfig::ObjectType type) const {
+    const std::uint8_t value = static_cast<std::uint8_t>(type);
+    std::size_t total = 0;
+    forEachRun([&](int, int, std::size_t offset, std::size_t n) {
+        total += static_cast<std::size_t>(std::count(cells.begin() + offset, cells.begin() + offset + n, value));
+    });
+    return total;
+}
+
+void Grid::exportRowMajor(std::uint8_t* out) const {
+    forEachRun([&](int y, int x, std::size_t offset, std::size_t n) {
+        std::copy(cells.begin() + offset, cells.begin() + offset + n,
+            out + static_cast<std::size_t>(y) * width + x);
+    });
+}
+
+void Grid::importRowMajor(const std::uint8_t* in) {
+    forEachRun([&](int y, int x, std::size_t offset, std::size_t n) {
+        const std::uint8_t* row = in + static_cast<std::size_t>(y) * width + x;
+        std::copy(row, row + n, cells.begin() + offset);
+    });
+}
+
+std::uint64_t Grid::neighborsAcrossBlocks(int x, int y) const {
+    std::uint64_t packed = ~std::uint64_t(0);
+    int mask = Neighborhood::validMask(x, y, width, length);
+    for (int d = 0; d < AIConfig::NUM_DIRECTIONS; ++d) {
+        if (mask & (1 << d)) {
+            packed = Neighborhood::withSlot(packed, d,
+                cells[index(x + AIConfig::DIRECTION_DX[d], y + AIConfig::DIRECTION_DY[d])]);
+        }
+    }
+    return packed;
+}
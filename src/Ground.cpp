@@ -1,6 +1,9 @@
 #include "ant_intelligence/Ground.h"
 #include "ant_intelligence/Config.h"
 #include "ant_intelligence/Objects.h"
+#include "ant_intelligence/Neighborhood.h"
+#include "ant_intelligence/BinaryIO.h"
+#include "ant_intelligence/Profiling.h"
 #include <random>
 #include <algorithm>
 #include <numeric>
@@ -11,240 +14,544 @@
 #include <stdexcept>  // For std::invalid_argument
 #include <cstdlib>
 
-// Constructor: Build adjacency list of possible positions
+// Constructor: Set up the grid and the per-step index structures
 Ground::Ground(int width,
     int length,
     const std::vector<double>& probabilities,
     const std::vector<double>& probRelu,
     int similarityThreshold,
-    int interactionCooldown) // Added cooldown to constructor
+    int interactionCooldown, // Added cooldown to constructor
+    std::uint64_t seed)
     : width(width)
     , length(length)
     , probabilities(probabilities)
+    , directionSampler(probabilities)
     , probRelu(probRelu)
     , similarityThreshold(similarityThreshold)
     , cooldown_duration(interactionCooldown) // Initialize new member
+    , seed(seed)
 {
     if (width <= 0 || length <= 0) {
         throw std::invalid_argument("Invalid grid dimensions");
     }
-    possiblePositions = getPossiblePositions();
+    grid = Grid(width, length, AIConfig::DEFAULT_GRID_LAYOUT);
+    cellIndex = CellIndex(width, length);
+    clusterTracker = ClusterTracker(width, length);
+
+    tilesX = (width + AIConfig::PARALLEL_TILE_SIZE - 1) / AIConfig::PARALLEL_TILE_SIZE;
+    tilesY = (length + AIConfig::PARALLEL_TILE_SIZE - 1) / AIConfig::PARALLEL_TILE_SIZE;
+    tilesByColor.assign(4, {});
+    for (int ty = 0; ty < tilesY; ++ty) {
+        for (int tx = 0; tx < tilesX; ++tx) {
+            tilesByColor[(tx & 1) | ((ty & 1) << 1)].push_back(ty * tilesX + tx);
+        }
+    }
+    tileStart.assign(static_cast<size_t>(tilesX) * tilesY + 1, 0);
+    tileCursor.assign(static_cast<size_t>(tilesX) * tilesY, 0);
+
+    densityRamp = buildDensityRamp(probRelu);
+    selectKernels();
+}
+
+Ground::DensityRamp Ground::buildDensityRamp(const std::vector<double>& probRelu) {
+    // OPTIMIZATION: The pick/drop ramp only ever sees k / n for k <= n <= 8,
+    // so it is tabulated instead of divided and clamped for every ant.
+    DensityRamp ramp{};
+    if (probRelu.size() >= 2) {
+        for (int n = 0; n <= AIConfig::NUM_DIRECTIONS; ++n) {
+            for (int k = 0; k <= n; ++k) {
+                ramp[n][k] = reluRange(double(k) / n, probRelu[0], probRelu[1]);
+            }
+        }
+    }
+    return ramp;
 }
 
 void Ground::addAnt(int memorySize) {
-    if (possiblePositions.empty()) {
+    if (grid.size() == 0) {
+        std::cerr << "Cannot add ant: No valid positions available." << std::endl;
+        return;
+    }
+    placeAnt(memorySize);
+    selectKernels();
+}
+
+void Ground::addAnts(int count, int memorySize) {
+    if (count <= 0) {
+        return;
+    }
+    if (grid.size() == 0) {
         std::cerr << "Cannot add ant: No valid positions available." << std::endl;
         return;
     }
+    colony.reserve(colony.size() + static_cast<std::size_t>(count));
+    for (int k = 0; k < count; ++k) {
+        placeAnt(memorySize);
+    }
+    selectKernels();
+}
 
-    auto position = getRandomPosition();
-    Ant newAnt(position, width, length, true, memorySize);
-    agents.push_back(newAnt);
+void Ground::placeAnt(int memorySize) {
+    // Each ant draws from its own stream, keyed by its index.
+    auto gen = makeRng(RngStream::Placement, colony.size(), 0);
+    auto position = getRandomPosition(gen);
+    int direction = gen.uniformInt(AIConfig::NUM_DIRECTIONS);
+    colony.add(position.first, position.second, direction, memorySize);
 }
 
-void Ground::addObject(const std::unordered_map<std::shared_ptr<Object>, double>& objDict) {
-    std::vector<std::shared_ptr<Object>> keys;
+Ground::ObjectSampler::ObjectSampler(const std::unordered_map<AIConfig::ObjectType, double>& typeDict) {
     std::vector<double> values;
-    keys.reserve(objDict.size());
-    values.reserve(objDict.size());
-
-    for (auto& kv : objDict) {
+    keys.reserve(typeDict.size());
+    values.reserve(typeDict.size());
+    for (auto& kv : typeDict) {
         keys.push_back(kv.first);
         values.push_back(kv.second);
     }
+    distribution = std::discrete_distribution<>(values.begin(), values.end());
+}
 
-    for (int x = 0; x < width; ++x) {
-        for (int y = 0; y < length; ++y) {
-            auto tempObject = getRandomObject(keys, values);
-            if (tempObject) {
-                obj[{x, y}] = tempObject;
+void Ground::addObject(const std::unordered_map<AIConfig::ObjectType, double>& typeDict) {
+    // OPTIMIZATION: The distribution used to be rebuilt for every cell. Cells
+    // are keyed by their row-major id, so rows can be filled in any order,
+    // on any thread, and every layout draws alike.
+    ObjectSampler sampler(typeDict);
+    const std::uint64_t fill = objectFills;
+#pragma omp parallel for schedule(static) firstprivate(sampler) \
+    if(static_cast<long long>(width) * length >= AIConfig::PARALLEL_FILL_MIN_CELLS)
+    for (int y = 0; y < length; ++y) {
+        for (int x = 0; x < width; ++x) {
+            auto gen = makeRng(RngStream::Objects, static_cast<std::uint64_t>(y) * width + x, fill);
+            auto type = sampler(gen);
+            if (type != AIConfig::ObjectType::None) {
+                grid.set(x, y, type);
             }
         }
     }
+    ++objectFills;
+    clusterTracker.invalidate();
+}
+
+void Ground::addObject(const std::unordered_map<std::shared_ptr<Object>, double>& objDict) {
+    // Probabilities of instances sharing a type (e.g. several nullptr keys) add up.
+    std::unordered_map<AIConfig::ObjectType, double> typeDict;
+    for (auto& kv : objDict) {
+        typeDict[objectTypeOf(kv.first)] += kv.second;
+    }
+    addObject(typeDict);
 }
 
 void Ground::moveAnts() {
-    thread_local static std::random_device rd;
-    thread_local static std::mt19937 gen(rd());
+    ANT_PROFILE_SCOPE(MoveAnts);
+    sortAntsIfDue();
+    // Moves only touch the moving ant, so they are trivially data-parallel.
+    // OPTIMIZATION: Each block of ants derives its random stream states in
+    // one pass before moving, rather than hashing a full key per ant.
+    prepareRng(moveRng, RngStream::Move, moveSteps);
+    const std::uint32_t* ids = colony.idData();
+    const long long numBlocks = static_cast<long long>(
+        (colony.size() + AIConfig::RNG_BLOCK_SIZE - 1) / AIConfig::RNG_BLOCK_SIZE);
+#pragma omp parallel for schedule(static) if(stepMode == AIConfig::StepMode::Parallel)
+    for (long long b = 0; b < numBlocks; ++b) {
+        const size_t begin = static_cast<size_t>(b) * AIConfig::RNG_BLOCK_SIZE;
+        const size_t end = std::min(begin + AIConfig::RNG_BLOCK_SIZE, colony.size());
+        moveRng.fill(begin, end, ids);
+        for (size_t i = begin; i < end; ++i) {
+            moveAnt(i);
+        }
+    }
+    ++moveSteps;
+}
+
+void Ground::moveAnt(size_t antIndex) {
+    auto gen = moveRng.at(antIndex);
+    std::pair<int, int> position{ colony.getX(antIndex), colony.getY(antIndex) };
+    int prevDirection = colony.getPrevDirection(antIndex);
+    Ant::moveStep(position, prevDirection, width, length, directionSampler, gen);
+    colony.setPosition(antIndex, position.first, position.second);
+    colony.setPrevDirection(antIndex, prevDirection);
+    if (recordPath) {
+        // Parallel moves may land on the same cell.
+        std::uint32_t previous;
+#pragma omp atomic capture
+        previous = visitCounts[grid.index(position.first, position.second)]++;
+        if (previous == 0) {
+#pragma omp atomic
+            ++covered;
+        }
+    }
+}
+
+void Ground::setRecordPath(bool record) {
+    recordPath = record;
+    covered = 0;
+    if (record) {
+        visitCounts.assign(grid.storageSize(), 0);
+    }
+    else {
+        std::vector<std::uint32_t>().swap(visitCounts);
+    }
+}
+
+void Ground::step() {
+    ANT_PROFILE_SCOPE(Step);
+    if (stepMode == AIConfig::StepMode::Serial) {
+        // Work only reads the grid and the working ant, never another ant's
+        // position, so moving and working each ant in turn matches the
+        // phased order exactly.
+        sortAntsIfDue();
+        prepareRng(moveRng, RngStream::Move, moveSteps);
+        prepareRng(workRng, RngStream::Work, workSteps);
+        const std::uint32_t* ids = colony.idData();
+        for (size_t begin = 0; begin < colony.size(); begin += AIConfig::RNG_BLOCK_SIZE) {
+            const size_t end = std::min(begin + AIConfig::RNG_BLOCK_SIZE, colony.size());
+            moveRng.fill(begin, end, ids);
+            workRng.fill(begin, end, ids);
+            for (size_t i = begin; i < end; ++i) {
+                moveAnt(i);
+                workAnt(i);
+            }
+        }
+        ++moveSteps;
+        ++workSteps;
+    }
+    else {
+        // The tile schedule needs every ant's new position first.
+        moveAnts();
+        assignWork();
+    }
 
-    for (auto& ant : agents) {
-        ant.move(possiblePositions, probabilities, gen);
+    // Interactions read the neighbours' post-work memories, so they need a
+    // second pass. An ant's cooldown is only read by the ant itself, which
+    // lets its countdown join that pass.
+    cellIndex.rebuild(colony);
+    for (size_t i = 0; i < colony.size(); ++i) {
+        interactAnt(i);
+        if (colony.getCooldown(i) > 0)
+            colony.setCooldown(i, colony.getCooldown(i) - 1);
     }
 }
 
 void Ground::assignWork() {
-    thread_local static std::random_device rd;
-    thread_local static std::mt19937 gen(rd());
-    std::uniform_real_distribution<double> dist(0.0, 1.0);
-
-    for (auto& ant : agents) {
-        auto pos = ant.getPosition();
-        auto it = obj.find(pos);
-        auto groundObject = (it != obj.end()) ? it->second : nullptr;
-        auto carried = ant.getLoad();
-
-        ant.updateMemory(groundObject);
-
-        if (!carried) {
-            if (groundObject) {
-                int neighborCount = countNeighbors(pos, groundObject);
-                double pickProb = reluRange(double(neighborCount) / possiblePositions[pos].size(),
-                    probRelu[0], probRelu[1]);
-                double randVal = dist(gen);
-                if (randVal > pickProb) {
-                    ant.setLoad(groundObject);
-                    obj[pos] = nullptr;
-                    ant.updateMemory(groundObject);
+    ANT_PROFILE_SCOPE(AssignWork);
+    prepareRng(workRng, RngStream::Work, workSteps);
+    const std::uint32_t* ids = colony.idData();
+    if (stepMode == AIConfig::StepMode::Serial) {
+        for (size_t begin = 0; begin < colony.size(); begin += AIConfig::RNG_BLOCK_SIZE) {
+            const size_t end = std::min(begin + AIConfig::RNG_BLOCK_SIZE, colony.size());
+            workRng.fill(begin, end, ids);
+            for (size_t i = begin; i < end; ++i) {
+                workAnt(i);
+            }
+        }
+    }
+    else {
+        // Tiles visit ants out of index order, so derive every state first.
+        const long long numAgents = static_cast<long long>(colony.size());
+#pragma omp parallel for schedule(static)
+        for (long long b = 0; b < numAgents; b += AIConfig::RNG_BLOCK_SIZE) {
+            workRng.fill(static_cast<size_t>(b), std::min(static_cast<size_t>(b) + AIConfig::RNG_BLOCK_SIZE, colony.size()), ids);
+        }
+        bucketAntsByTile();
+        for (const auto& tiles : tilesByColor) {
+            const int numTiles = static_cast<int>(tiles.size());
+#pragma omp parallel for schedule(dynamic, 1)
+            for (int t = 0; t < numTiles; ++t) {
+                int tile = tiles[t];
+                for (int k = tileStart[tile]; k < tileStart[tile + 1]; ++k) {
+                    workAnt(static_cast<size_t>(tileAnts[k]));
                 }
             }
         }
+        clusterTracker.invalidate();
+    }
+    ++workSteps;
+}
+
+void Ground::bucketAntsByTile() {
+    // Counting sort keeps ants of a tile in ascending index order.
+    std::fill(tileStart.begin(), tileStart.end(), 0);
+    for (size_t i = 0; i < colony.size(); ++i) {
+        int tile = (colony.getY(i) / AIConfig::PARALLEL_TILE_SIZE) * tilesX + colony.getX(i) / AIConfig::PARALLEL_TILE_SIZE;
+        ++tileStart[tile + 1];
+    }
+    for (size_t t = 1; t < tileStart.size(); ++t) {
+        tileStart[t] += tileStart[t - 1];
+    }
+    std::copy(tileStart.begin(), tileStart.end() - 1, tileCursor.begin());
+    tileAnts.resize(colony.size());
+    for (size_t i = 0; i < colony.size(); ++i) {
+        int tile = (colony.getY(i) / AIConfig::PARALLEL_TILE_SIZE) * tilesX + colony.getX(i) / AIConfig::PARALLEL_TILE_SIZE;
+        tileAnts[tileCursor[tile]++] = static_cast<int>(i);
+    }
+}
+
+template <int Capacity, AIConfig::NeighborhoodType N>
+void Ground::workAntKernel(size_t antIndex) {
+    auto remember = [&](AIConfig::ObjectType type) {
+        if constexpr (Capacity > 0) {
+            colony.updateMemoryFixed<Capacity>(antIndex, type);
+        }
         else {
-            ant.updateMemory(carried);
-
-            int neighborCount = countNeighbors(pos, carried);
-            double dropProb = reluRange(double(neighborCount) / possiblePositions[pos].size(),
-                probRelu[0], probRelu[1]);
-            double randVal = dist(gen);
-            if (randVal <= dropProb) {
-                if (!groundObject) {
-                    obj[pos] = carried;
-                    ant.setLoad(nullptr);
-                    ant.updateMemory(carried);
-                }
-                else {
-                    obj[pos] = carried;
-                    ant.setLoad(groundObject);
-                    ant.updateMemory(carried);
-                    ant.updateMemory(groundObject);
-                }
+            colony.updateMemory(antIndex, type);
+        }
+    };
+
+    auto gen = workRng.at(antIndex);
+    const int x = colony.getX(antIndex);
+    const int y = colony.getY(antIndex);
+    auto groundType = grid.get(x, y);
+    auto carried = colony.getLoad(antIndex);
+
+    remember(groundType);
+
+    if (carried == AIConfig::ObjectType::None) {
+        if (groundType != AIConfig::ObjectType::None) {
+            int neighborCount = countNeighbors<N>(x, y, groundType);
+            double pickProb = densityRamp[Neighborhood::count(x, y, width, length, N)][neighborCount];
+            double randVal = gen.uniform();
+            if (randVal > pickProb) {
+                colony.setLoad(antIndex, groundType);
+                setCell(x, y, AIConfig::ObjectType::None);
+                remember(groundType);
+                ANT_PROFILE_COUNT(Picks, 1);
+            }
+        }
+    }
+    else {
+        remember(carried);
+
+        int neighborCount = countNeighbors<N>(x, y, carried);
+        double dropProb = densityRamp[Neighborhood::count(x, y, width, length, N)][neighborCount];
+        double randVal = gen.uniform();
+        if (randVal <= dropProb) {
+            setCell(x, y, carried);
+            colony.setLoad(antIndex, groundType);
+            remember(carried);
+            remember(groundType);
+            if (groundType == AIConfig::ObjectType::None) {
+                ANT_PROFILE_COUNT(Drops, 1);
+            }
+            else {
+                ANT_PROFILE_COUNT(Swaps, 1);
             }
         }
     }
 }
 
+template <AIConfig::NeighborhoodType N>
+Ground::AntKernel Ground::workKernelFor(int capacity) {
+    // Memory sizes with a specialised kernel; anything else runs the
+    // generic one, which reads the capacity at run time.
+    switch (capacity) {
+    case 10: return &Ground::workAntKernel<10, N>;
+    case 20: return &Ground::workAntKernel<20, N>;
+    case 32: return &Ground::workAntKernel<32, N>;
+    default: return &Ground::workAntKernel<0, N>;
+    }
+}
 
-double Ground::averageClusterSize() {
-    std::unordered_set<std::pair<int, int>, pair_hash> visitedLocations;
-    visitedLocations.reserve(width * length);
-    std::vector<double> clusterSizes;
-    if (clusterSizes.capacity() < static_cast<size_t>((width * length) / 4)) {
-        clusterSizes.reserve((width * length) / 4);
+void Ground::selectKernels() {
+    const int capacity = specializedKernels ? colony.fixedCapacity() : -1;
+    if (neighborhood == AIConfig::NeighborhoodType::Moore) {
+        workKernel = workKernelFor<AIConfig::NeighborhoodType::Moore>(capacity);
+        interactKernel = &Ground::interactAntKernel<AIConfig::NeighborhoodType::Moore>;
     }
+    else {
+        workKernel = workKernelFor<AIConfig::NeighborhoodType::VonNeumann>(capacity);
+        interactKernel = &Ground::interactAntKernel<AIConfig::NeighborhoodType::VonNeumann>;
+    }
+}
 
-    for (int x = 0; x < width; ++x) {
-        for (int y = 0; y < length; ++y) {
-            std::pair<int, int> pos = { x, y };
+bool Ground::usesSpecializedKernel() const {
+    return workKernel != workKernelFor<AIConfig::NeighborhoodType::Moore>(0)
+        && workKernel != workKernelFor<AIConfig::NeighborhoodType::VonNeumann>(0);
+}
 
-            if (visitedLocations.find(pos) != visitedLocations.end()) {
-                continue;
-            }
+void Ground::setNeighborhood(AIConfig::NeighborhoodType type) {
+    neighborhood = type;
+    selectKernels();
+}
 
-            auto it = obj.find(pos);
-            if (it == obj.end() || !it->second) {
-                visitedLocations.insert(pos);
-                continue;
-            }
+void Ground::setSpecializedKernels(bool enabled) {
+    specializedKernels = enabled;
+    selectKernels();
+}
 
-            bool isValidType = std::dynamic_pointer_cast<Food>(it->second) ||
-                std::dynamic_pointer_cast<Waste>(it->second) ||
-                std::dynamic_pointer_cast<Egg>(it->second);
-            if (!isValidType) {
-                visitedLocations.insert(pos);
-                continue;
-            }
+void Ground::setGridLayout(AIConfig::GridLayout layout) {
+    if (layout == grid.getLayout()) {
+        return;
+    }
+    std::vector<std::uint8_t> types(grid.size());
+    grid.exportRowMajor(types.data());
+    Grid relaid(width, length, layout);
+    relaid.importRowMajor(types.data());
 
-            double csize = bfsCluster(pos, it->second, visitedLocations);
-            if (csize > 0) {
-                clusterSizes.push_back(csize);
+    if (recordPath) {
+        std::vector<std::uint32_t> counts(relaid.storageSize(), 0);
+        for (int y = 0; y < length; ++y) {
+            for (int x = 0; x < width; ++x) {
+                counts[relaid.index(x, y)] = visitCounts[grid.index(x, y)];
             }
         }
+        visitCounts.swap(counts);
     }
+    grid = std::move(relaid);
+}
 
-    if (clusterSizes.empty()) {
-        return 0.0;
+void Ground::sortAnts() {
+    // OPTIMIZATION: Ants in grid storage order make the per-ant passes walk
+    // the grid (and a tiled grid block by block) instead of jumping at random.
+    std::vector<std::pair<std::size_t, std::uint32_t>> keys(colony.size());
+    for (size_t i = 0; i < colony.size(); ++i) {
+        keys[i] = { grid.index(colony.getX(i), colony.getY(i)), static_cast<std::uint32_t>(i) };
+    }
+    std::sort(keys.begin(), keys.end());
+    std::vector<std::uint32_t> order(keys.size());
+    for (size_t k = 0; k < keys.size(); ++k) {
+        order[k] = keys[k].second;
     }
+    colony.permute(order);
+}
 
-    double sum = std::accumulate(clusterSizes.begin(), clusterSizes.end(), 0.0);
-    return sum / clusterSizes.size();
+void Ground::sortAntsIfDue() {
+    if (antSortInterval > 0 && moveSteps % static_cast<std::uint64_t>(antSortInterval) == 0) {
+        sortAnts();
+    }
 }
 
-double Ground::bfsCluster(
-    const std::pair<int, int>& startPos,
-    std::shared_ptr<Object> targetObj,
-    std::unordered_set<std::pair<int, int>, pair_hash>& visitedLocations
-) {
-    if (startPos.first < 0 || startPos.first >= width ||
-        startPos.second < 0 || startPos.second >= length) {
-        return 0.0;
+
+void Ground::setCell(int x, int y, AIConfig::ObjectType type) {
+    auto oldType = grid.get(x, y);
+    grid.set(x, y, type);
+    // Parallel workers cannot share the tracker; that pass invalidates it instead.
+    if (stepMode == AIConfig::StepMode::Serial) {
+        clusterTracker.update(grid, x, y, oldType);
     }
+}
 
-    double clusterSize = 0.0;
-    std::vector<std::pair<int, int>> queue;
-    queue.reserve(width * length);
-    queue.push_back(startPos);
-    size_t index = 0;
+double Ground::averageClusterSize() {
+    ANT_PROFILE_SCOPE(ClusterSize);
+    // OPTIMIZATION: Clusters are tracked incrementally with union-find instead
+    // of a full BFS over the grid with a hash-set of visited cells.
+    // FIX: The BFS marked neighbouring cells of other types as visited, so
+    // they were never counted in a cluster of their own.
+    return clusterTracker.averageSize(grid);
+}
 
-    while (index < queue.size()) {
-        auto current = queue[index++];
-        if (visitedLocations.find(current) != visitedLocations.end()) {
-            continue;
-        }
-        visitedLocations.insert(current);
-
-        auto it = obj.find(current);
-        if (it != obj.end() && it->second == targetObj) {
-            clusterSize += 1.0;
-            for (auto& neighbor : possiblePositions[current]) {
-                if (visitedLocations.find(neighbor) == visitedLocations.end()) {
-                    queue.push_back(neighbor);
-                }
-            }
-        }
+namespace {
+    const char STATE_MAGIC[8] = { 'A', 'N', 'T', 'G', 'N', 'D', '1', '\0' };
+    // Version 2 appends the ant ids to the colony.
+    const std::uint32_t STATE_VERSION = 2;
+    const std::size_t STATE_HEADER_SIZE = 64;
+}
+
+void Ground::saveState(std::ostream& out) const {
+    const StateCounters counters{ seed, objectFills, moveSteps, workSteps, interactionCounter };
+    // The saved grid is row-major whatever the layout in memory.
+    if (grid.getLayout() == AIConfig::GridLayout::RowMajor) {
+        writeState(out, width, length, counters, grid.data(), colony);
+    }
+    else {
+        std::vector<std::uint8_t> types(grid.size());
+        grid.exportRowMajor(types.data());
+        writeState(out, width, length, counters, types.data(), colony);
     }
-    return clusterSize;
 }
 
-#ifndef IS_TEST_BUILD
-void Ground::showGround(const std::string& windowName, cv::VideoWriter& video) const {
-    int scale = 6;
-    cv::Mat image = cv::Mat::ones(width * scale, length * scale, CV_8UC3) * 255;
+void Ground::writeState(std::ostream& out, int width, int length, const StateCounters& counters,
+    const std::uint8_t* rowMajor, const AntColony& colony) {
+    out.write(STATE_MAGIC, sizeof(STATE_MAGIC));
+    BinaryIO::write<std::uint32_t>(out, STATE_VERSION);
+    BinaryIO::write<std::int32_t>(out, width);
+    BinaryIO::write<std::int32_t>(out, length);
+    BinaryIO::write<std::uint64_t>(out, counters.seed);
+    BinaryIO::write<std::uint64_t>(out, counters.objectFills);
+    BinaryIO::write<std::uint64_t>(out, counters.moveSteps);
+    BinaryIO::write<std::uint64_t>(out, counters.workSteps);
+    BinaryIO::write<std::int64_t>(out, counters.interactions);
+    BinaryIO::pad(out, 60, STATE_HEADER_SIZE);
+    out.write(reinterpret_cast<const char*>(rowMajor),
+        static_cast<std::streamsize>(static_cast<std::size_t>(width) * static_cast<std::size_t>(length)));
+    colony.save(out);
+    if (!out) {
+        throw std::runtime_error("Failed to write ground state");
+    }
+}
 
-    for (int x = 0; x < width; ++x) {
-        for (int y = 0; y < length; ++y) {
-            auto it = obj.find({ x, y });
-            if (it != obj.end() && it->second) {
-                cv::Scalar color(128, 128, 128); // default gray
-                if (std::dynamic_pointer_cast<Food>(it->second)) {
-                    color = cv::Scalar(0, 255, 0);    // Green
-                }
-                else if (std::dynamic_pointer_cast<Egg>(it->second)) {
-                    color = cv::Scalar(0, 255, 255);  // Yellow
-                }
-                else if (std::dynamic_pointer_cast<Waste>(it->second)) {
-                    color = cv::Scalar(255, 0, 255);  // Magenta
-                }
-                cv::circle(
-                    image,
-                    cv::Point(y * scale + scale / 2, x * scale + scale / 2),
-                    scale / 3,
-                    color,
-                    -1
-                );
-            }
+void Ground::loadState(std::istream& in) {
+    char magic[sizeof(STATE_MAGIC)];
+    BinaryIO::readBytes(in, magic, sizeof(magic));
+    if (!std::equal(magic, magic + sizeof(magic), STATE_MAGIC)) {
+        throw std::runtime_error("Not a ground state");
+    }
+    std::uint32_t version = BinaryIO::read<std::uint32_t>(in);
+    if (version < 1 || version > STATE_VERSION) {
+        throw std::runtime_error("Unsupported ground state version");
+    }
+    if (BinaryIO::read<std::int32_t>(in) != width || BinaryIO::read<std::int32_t>(in) != length) {
+        throw std::runtime_error("Ground state was saved with different dimensions");
+    }
+
+    std::uint64_t newSeed = BinaryIO::read<std::uint64_t>(in);
+    std::uint64_t newObjectFills = BinaryIO::read<std::uint64_t>(in);
+    std::uint64_t newMoveSteps = BinaryIO::read<std::uint64_t>(in);
+    std::uint64_t newWorkSteps = BinaryIO::read<std::uint64_t>(in);
+    std::int64_t newInteractions = BinaryIO::read<std::int64_t>(in);
+    char padding[STATE_HEADER_SIZE - 60];
+    BinaryIO::readBytes(in, padding, sizeof(padding));
+
+    std::vector<std::uint8_t> types(grid.size());
+    BinaryIO::readBytes(in, reinterpret_cast<char*>(types.data()), types.size());
+    for (std::uint8_t type : types) {
+        if (type >= AIConfig::NUM_OBJECT_TYPES) {
+            throw std::runtime_error("Corrupt ground state");
+        }
+    }
+    Grid newGrid(width, length, grid.getLayout());
+    newGrid.importRowMajor(types.data());
+    AntColony newColony;
+    newColony.load(in, version >= 2);
+    for (std::size_t i = 0; i < newColony.size(); ++i) {
+        if (!newGrid.inBounds(newColony.getX(i), newColony.getY(i))) {
+            throw std::runtime_error("Corrupt ground state");
         }
     }
 
-    for (auto& ant : agents) {
-        auto pos = ant.getPosition();
-        cv::Scalar antColor(0, 0, 255); // Red
-        cv::circle(
-            image,
-            cv::Point(pos.second * scale + scale / 2, pos.first * scale + scale / 2),
-            scale / 3,
-            antColor,
-            -1
-        );
+    // Commit only once everything has been read and validated.
+    seed = newSeed;
+    objectFills = newObjectFills;
+    moveSteps = newMoveSteps;
+    workSteps = newWorkSteps;
+    interactionCounter = static_cast<int>(newInteractions);
+    grid = std::move(newGrid);
+    colony = std::move(newColony);
+    clusterTracker.invalidate();
+    selectKernels();
+}
+
+void Ground::snapshot(FrameSnapshot& frame) const {
+    ANT_PROFILE_SCOPE(Snapshot);
+    frame.width = width;
+    frame.length = length;
+    frame.types.resize(grid.size());
+    grid.exportRowMajor(frame.types.data());
+    frame.antX.resize(colony.size());
+    frame.antY.resize(colony.size());
+    for (size_t i = 0; i < colony.size(); ++i) {
+        frame.antX[i] = colony.getX(i);
+        frame.antY[i] = colony.getY(i);
     }
+}
+
+#ifndef IS_TEST_BUILD
+void Ground::showGround(const std::string& windowName, cv::VideoWriter& video, int scale) const {
+    ANT_PROFILE_SCOPE(ShowGround);
+    // Same rasteriser as the asynchronous FramePipeline, run inline.
+    FrameSnapshot frame;
+    snapshot(frame);
+    std::vector<std::uint8_t> pixels;
+    FramePipeline::rasterize(frame, scale, pixels);
+    cv::Mat image(width * scale, length * scale, CV_8UC3, pixels.data());
 
     cv::imshow(windowName, image);
     video.write(image);
@@ -253,90 +560,47 @@ void Ground::showGround(const std::string& windowName, cv::VideoWriter& video) c
 #endif
 
 void Ground::countObjects() const {
-    int foodCount = 0;
-    int eggCount = 0;
-    int wasteCount = 0;
-
-    for (auto& kv : obj) {
-        if (kv.second) {
-            if (std::dynamic_pointer_cast<Food>(kv.second)) {
-                foodCount++;
-            }
-            else if (std::dynamic_pointer_cast<Egg>(kv.second)) {
-                eggCount++;
-            }
-            else if (std::dynamic_pointer_cast<Waste>(kv.second)) {
-                wasteCount++;
-            }
-        }
-    }
+    auto foodCount = grid.count(AIConfig::ObjectType::Food);
+    auto eggCount = grid.count(AIConfig::ObjectType::Egg);
+    auto wasteCount = grid.count(AIConfig::ObjectType::Waste);
 
     std::cout << "Number of Food objects: " << foodCount << std::endl;
     std::cout << "Number of Egg objects: " << eggCount << std::endl;
     std::cout << "Number of Waste objects: " << wasteCount << std::endl;
 }
 
-const std::vector<Ant>& Ground::getAgents() const {
-    return agents;
+std::vector<Ant> Ground::getAgents() const {
+    std::vector<Ant> ants;
+    ants.reserve(colony.size());
+    for (size_t i = 0; i < colony.size(); ++i) {
+        ants.push_back(getAnt(i));
+    }
+    return ants;
 }
 
-std::unordered_map<std::pair<int, int>, std::vector<std::pair<int, int>>, pair_hash> Ground::getPossiblePositions() {
-    std::vector<std::pair<int, int>> neighborOffsets = {
-        { 0, -1}, { 1, -1}, { 1,  0}, { 1,  1},
-        { 0,  1}, {-1,  1}, {-1,  0}, {-1, -1}
-    };
-    std::unordered_map<std::pair<int, int>, std::vector<std::pair<int, int>>, pair_hash> result;
-
-    for (int x = 0; x < width; ++x) {
-        for (int y = 0; y < length; ++y) {
-            std::vector<std::pair<int, int>> neighbors;
-            for (auto& offset : neighborOffsets) {
-                int nx = x + offset.first;
-                int ny = y + offset.second;
-                if (nx >= 0 && nx < width && ny >= 0 && ny < length) {
-                    neighbors.push_back({ nx, ny });
-                }
-            }
-            result[{x, y}] = neighbors;
-        }
+Ant Ground::getAnt(size_t index) const {
+    Ant ant({ colony.getX(index), colony.getY(index) }, width, length, false,
+        colony.getMemoryCapacity(index), colony.getPrevDirection(index));
+    ant.setLoad(colony.getLoad(index));
+    ant.setInteractionCooldown(colony.getCooldown(index));
+    for (int type : colony.getMemory(index)) {
+        ant.updateMemory(static_cast<AIConfig::ObjectType>(type));
     }
-
-    return result;
+    return ant;
 }
 
-std::pair<int, int> Ground::getRandomPosition() {
-    thread_local static std::random_device rd;
-    thread_local static std::mt19937 gen(rd());
-
-    int size = static_cast<int>(possiblePositions.size());
+std::pair<int, int> Ground::getRandomPosition(CounterRng& gen) {
+    int size = static_cast<int>(grid.size());
     if (size == 0) {
         throw std::runtime_error("No possible positions available in Ground::getRandomPosition");
     }
-    std::uniform_int_distribution<> distrib(0, size - 1);
 
-    int index = distrib(gen);
-    auto it = possiblePositions.begin();
-    std::advance(it, index);
-    return it->first;
+    // Every cell is a valid position, so draw a flat row-major index directly.
+    int index = gen.uniformInt(size);
+    return { index % width, index / width };
 }
 
 
-std::shared_ptr<Object> Ground::getRandomObject(
-    const std::vector<std::shared_ptr<Object>>& keys,
-    const std::vector<double>& values
-) {
-    // FIX: Made the random number generator thread-local for safety in parallel execution.
-    thread_local static std::random_device rd;
-    thread_local static std::mt19937 gen(rd());
-    std::discrete_distribution<> dist(values.begin(), values.end());
-
-    int idx = dist(gen);
-    if (!keys[idx]) {
-        return nullptr;
-    }
-    return keys[idx];
-}
-
 double Ground::reluRange(double x, double a, double b) {
     if (x < a) {
         return 0.0;
@@ -349,75 +613,54 @@ double Ground::reluRange(double x, double a, double b) {
     }
 }
 
-int Ground::countNeighbors(const std::pair<int, int>& pos, std::shared_ptr<Object> objType) {
-    int count = 0;
-    for (auto& neighbor : possiblePositions[pos]) {
-        auto it = obj.find(neighbor);
-        if (it != obj.end() && it->second == objType) {
-            count++;
-        }
-    }
-    return count;
-}
-
-static int getTypeFromLoad(const std::shared_ptr<Object>& load) {
-    if (std::dynamic_pointer_cast<Food>(load)) {
-        return static_cast<int>(AIConfig::ObjectType::Food);
-    }
-    else if (std::dynamic_pointer_cast<Waste>(load)) {
-        return static_cast<int>(AIConfig::ObjectType::Waste);
-    }
-    else if (std::dynamic_pointer_cast<Egg>(load)) {
-        return static_cast<int>(AIConfig::ObjectType::Egg);
-    }
-    return static_cast<int>(AIConfig::ObjectType::None);
+template <AIConfig::NeighborhoodType N>
+int Ground::countNeighbors(int x, int y, AIConfig::ObjectType objType) const {
+    // OPTIMIZATION: The neighbour bytes are packed into one word and matched
+    // against the type in a single SWAR compare instead of a branch per direction.
+    constexpr std::uint64_t lanes = Neighborhood::laneMask(N);
+    return Neighborhood::countMatches(grid.neighbors(x, y), static_cast<std::uint8_t>(objType), lanes);
 }
 
 void Ground::handleAntInteractions(int currentIteration) {
-    std::unordered_map<std::pair<int, int>, std::vector<int>, pair_hash> positionsMap;
-    for (size_t i = 0; i < agents.size(); ++i) {
-        positionsMap[agents[i].getPosition()].push_back(static_cast<int>(i));
-    }
-
-    for (size_t i = 0; i < agents.size(); ++i) {
-        Ant& antA = agents[i];
-        if (antA.getInteractionCooldown() != 0 || !antA.getLoad())
-            continue;
-
-        auto posA = antA.getPosition();
-        auto neighborCells = possiblePositions[posA];
+    ANT_PROFILE_SCOPE(Interactions);
+    // OPTIMIZATION: Persistent cell list instead of a per-step hash map of
+    // ant positions; neighbour cells come straight from the direction table.
+    cellIndex.rebuild(colony);
 
-        bool interactionOccurred = false;
+    for (size_t i = 0; i < colony.size(); ++i) {
+        interactAnt(i);
+    }
 
-        for (const auto& cell : neighborCells) {
-            auto it = positionsMap.find(cell);
-            if (it == positionsMap.end())
-                continue;
+    for (size_t i = 0; i < colony.size(); ++i) {
+        if (colony.getCooldown(i) > 0)
+            colony.setCooldown(i, colony.getCooldown(i) - 1);
+    }
+}
 
-            for (int j : it->second) {
-                Ant& antB = agents[j];
-                int loadType = getTypeFromLoad(antA.getLoad());
+template <AIConfig::NeighborhoodType N>
+void Ground::interactAntKernel(size_t i) {
+    if (colony.getCooldown(i) != 0 || colony.getLoad(i) == AIConfig::ObjectType::None)
+        return;
 
-                int similarity = static_cast<int>(std::count(
-                    antB.getMemory().begin(),
-                    antB.getMemory().end(),
-                    loadType
-                ));
+    const int x = colony.getX(i);
+    const int y = colony.getY(i);
+    constexpr int stencil = Neighborhood::stencilMask(N);
 
-                if (similarity >= similarityThreshold) {
-                    interactionCounter++;
-                    antA.setPrevDirection((antB.getPrevDirection() + 4) % AIConfig::NUM_DIRECTIONS);
-                    antA.setInteractionCooldown(cooldown_duration);
-                    interactionOccurred = true;
-                    break;
-                }
+    for (int d = 0; d < AIConfig::NUM_DIRECTIONS; ++d) {
+        if (!(stencil & (1 << d)))
+            continue;
+        for (int j = cellIndex.first(x + AIConfig::DIRECTION_DX[d], y + AIConfig::DIRECTION_DY[d]);
+            j != -1; j = cellIndex.next(j)) {
+            int similarity = colony.countMemory(j, colony.getLoad(i));
+            ANT_PROFILE_COUNT(InteractionChecks, 1);
+
+            if (similarity >= similarityThreshold) {
+                ANT_PROFILE_COUNT(Interactions, 1);
+                interactionCounter++;
+                colony.setPrevDirection(i, (colony.getPrevDirection(j) + 4) % AIConfig::NUM_DIRECTIONS);
+                colony.setCooldown(i, cooldown_duration);
+                return;
             }
-            if (interactionOccurred) break;
         }
     }
-
-    for (auto& ant : agents) {
-        if (ant.getInteractionCooldown() > 0)
-            ant.setInteractionCooldown(ant.getInteractionCooldown() - 1);
-    }
 }
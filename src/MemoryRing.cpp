@@ -0,0 +1,18 @@
+#include "ant_intelligence/MemoryRing.h"
+#include <stdexcept>
+
+MemoryRing::MemoryRing(int capacity)
+{
+    if (capacity > UINT16_MAX) {
+        throw std::invalid_argument("Invalid ant memory size");
+    }
+    slots.assign(capacity > 0 ? capacity : 0, static_cast<std::uint8_t>(AIConfig::ObjectType::None));
+}
+
+std::deque<int> MemoryRing::toDeque() const {
+    std::deque<int> result;
+    for (int k = 0; k < used; ++k) {
+        result.push_back(at(k));
+    }
+    return result;
+}
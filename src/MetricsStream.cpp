@@ -0,0 +1,126 @@
+#include "ant_intelligence/MetricsStream.h"
+#include <chrono>
+#include <stdexcept>
+#include <utility>
+
+MetricsStream::MetricsStream(const std::string& filename, std::size_t runs, const std::string& parameters,
+    std::size_t queueDepth)
+    : file(filename, std::ios_base::trunc)
+    , capacity(queueDepth > 0 ? queueDepth : 1)
+{
+    if (!file.is_open()) {
+        throw std::runtime_error("Could not open the metrics stream '" + filename + "' for writing");
+    }
+    pending.reserve(capacity);
+    file.precision(10);
+    file << "{\"event\": \"start\", \"runs\": " << runs << ", \"parameters\": " << parameters << "}\n";
+    file.flush();
+    writer = std::thread(&MetricsStream::run, this);
+}
+
+MetricsStream::~MetricsStream() {
+    try {
+        finish();
+    }
+    catch (...) {
+        // Destructors must not throw; call finish() to observe write errors.
+    }
+}
+
+bool MetricsStream::publishSample(const ResultRow& row) {
+    return publish({ false, row });
+}
+
+bool MetricsStream::publishRunEnd(int cooldown, int threshold, int run, int convergedIteration) {
+    ResultRow row;
+    row.cooldown = cooldown;
+    row.threshold = threshold;
+    row.run = run;
+    row.convergedIteration = convergedIteration;
+    return publish({ true, row });
+}
+
+bool MetricsStream::publish(const Event& event) {
+    std::lock_guard<std::mutex> lock(mutex);
+    // Run ends are one per run, so they never make the buffer unbounded and
+    // are never dropped; consumers count them to know when a sweep is done.
+    if (finishing || (!event.runEnd && pending.size() >= capacity)) {
+        ++droppedEvents;
+        return false;
+    }
+    pending.push_back(event);
+    return true;
+}
+
+std::uint64_t MetricsStream::dropped() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return droppedEvents;
+}
+
+void MetricsStream::finish() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        finishing = true;
+    }
+    stop.notify_one();
+    if (writer.joinable()) {
+        writer.join();
+    }
+    if (!file.is_open()) {
+        return;
+    }
+    file << "{\"event\": \"end\", \"dropped\": " << droppedEvents << "}\n";
+    file.close();
+    if (failed || file.fail()) {
+        throw std::runtime_error("MetricsStream could not write every event");
+    }
+}
+
+void MetricsStream::run() {
+    std::vector<Event> events;
+    events.reserve(capacity);
+    for (;;) {
+        bool last;
+        {
+            // Publishers never notify; the writer polls at the flush interval
+            // and is only woken early by finish().
+            std::unique_lock<std::mutex> lock(mutex);
+            stop.wait_for(lock, std::chrono::milliseconds(AIConfig::DEFAULT_METRICS_FLUSH_MS),
+                [this] { return finishing; });
+            last = finishing;
+            events.swap(pending);
+        }
+        // Formatting and I/O happen outside the lock.
+        writeEvents(events);
+        events.clear();
+        if (last) {
+            return;
+        }
+    }
+}
+
+void MetricsStream::writeEvents(const std::vector<Event>& events) {
+    if (events.empty()) {
+        return;
+    }
+    for (const auto& event : events) {
+        const ResultRow& row = event.row;
+        file << "{\"event\": \"" << (event.runEnd ? "run_end" : "sample")
+            << "\", \"cooldown\": " << row.cooldown
+            << ", \"threshold\": " << row.threshold
+            << ", \"run\": " << row.run;
+        if (!event.runEnd) {
+            file << ", \"iteration\": " << row.iteration
+                << ", \"cluster\": " << row.clusterSize
+                << ", \"interactions\": " << row.interactionCount;
+        }
+        else if (row.convergedIteration >= 0) {
+            file << ", \"converged\": " << row.convergedIteration;
+        }
+        file << "}\n";
+    }
+    file.flush();
+    if (!file) {
+        failed = true;
+    }
+}
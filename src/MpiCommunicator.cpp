@@ -0,0 +1,104 @@
+#include "ant_intelligence/MpiCommunicator.h"
+
+#ifdef ANT_WITH_MPI
+
+#include <iterator>
+#include <limits>
+#include <stdexcept>
+
+namespace {
+    const int MESSAGE_TAG = 17;
+
+    void check(int status, const char* what) {
+        if (status != MPI_SUCCESS) {
+            throw std::runtime_error(what);
+        }
+    }
+
+    int byteCount(std::size_t size) {
+        if (size > static_cast<std::size_t>(std::numeric_limits<int>::max())) {
+            throw std::length_error("Message too large for MPI");
+        }
+        return static_cast<int>(size);
+    }
+}
+
+MpiCommunicator::MpiCommunicator(MPI_Comm comm)
+    : comm(comm)
+{
+    check(MPI_Comm_rank(comm, &ownRank), "MPI_Comm_rank failed");
+    check(MPI_Comm_size(comm, &ranks), "MPI_Comm_size failed");
+}
+
+MpiCommunicator::~MpiCommunicator() {
+    for (auto& message : pending) {
+        MPI_Wait(&message.request, MPI_STATUS_IGNORE);
+    }
+}
+
+void MpiCommunicator::reap() {
+    for (auto it = pending.begin(); it != pending.end();) {
+        int done = 0;
+        MPI_Test(&it->request, &done, MPI_STATUS_IGNORE);
+        it = done ? pending.erase(it) : std::next(it);
+    }
+}
+
+void MpiCommunicator::send(int destination, const Buffer& message) {
+    reap();
+    pending.push_back({ MPI_REQUEST_NULL, message });
+    Pending& posted = pending.back();
+    check(MPI_Isend(posted.data.data(), byteCount(posted.data.size()), MPI_BYTE, destination, MESSAGE_TAG,
+        comm, &posted.request), "MPI_Isend failed");
+}
+
+void MpiCommunicator::recv(int source, Buffer& message) {
+    MPI_Status status;
+    check(MPI_Probe(source, MESSAGE_TAG, comm, &status), "MPI_Probe failed");
+    int count = 0;
+    MPI_Get_count(&status, MPI_BYTE, &count);
+    message.resize(static_cast<std::size_t>(count));
+    check(MPI_Recv(message.data(), count, MPI_BYTE, source, MESSAGE_TAG, comm, MPI_STATUS_IGNORE),
+        "MPI_Recv failed");
+}
+
+void MpiCommunicator::allreduceSum(std::vector<std::int64_t>& values) {
+    check(MPI_Allreduce(MPI_IN_PLACE, values.data(), byteCount(values.size()), MPI_INT64_T, MPI_SUM, comm),
+        "MPI_Allreduce failed");
+}
+
+void MpiCommunicator::gather(const Buffer& local, std::vector<Buffer>& all, int root) {
+    int localSize = byteCount(local.size());
+    std::vector<int> sizes(rank() == root ? ranks : 0);
+    check(MPI_Gather(&localSize, 1, MPI_INT, sizes.data(), 1, MPI_INT, root, comm), "MPI_Gather failed");
+
+    std::vector<int> offsets;
+    Buffer joined;
+    if (rank() == root) {
+        offsets.resize(ranks);
+        std::size_t total = 0;
+        for (int r = 0; r < ranks; ++r) {
+            offsets[r] = byteCount(total);
+            total += static_cast<std::size_t>(sizes[r]);
+        }
+        joined.resize(total);
+    }
+    check(MPI_Gatherv(local.data(), localSize, MPI_BYTE, joined.data(), sizes.data(), offsets.data(), MPI_BYTE,
+        root, comm), "MPI_Gatherv failed");
+
+    all.clear();
+    if (rank() == root) {
+        for (int r = 0; r < ranks; ++r) {
+            all.emplace_back(joined.begin() + offsets[r], joined.begin() + offsets[r] + sizes[r]);
+        }
+    }
+}
+
+void MpiCommunicator::broadcast(Buffer& data, int root) {
+    unsigned long long size = data.size();
+    check(MPI_Bcast(&size, 1, MPI_UNSIGNED_LONG_LONG, root, comm), "MPI_Bcast failed");
+    data.resize(static_cast<std::size_t>(size));
+    check(MPI_Bcast(data.data(), byteCount(data.size()), MPI_BYTE, root, comm), "MPI_Bcast failed");
+}
+
+#endif
@@ -0,0 +1,201 @@
+#include "ant_intelligence/Profiling.h"
+#include <iomanip>
+#include <string>
+
+#ifdef ANT_PROFILING
+#include <atomic>
+#include <memory>
+#include <mutex>
+#endif
+
+namespace Profiling {
+
+const char* phaseName(Phase phase) {
+    switch (phase) {
+    case Phase::MoveAnts: return "moveAnts";
+    case Phase::AssignWork: return "assignWork";
+    case Phase::Interactions: return "handleAntInteractions";
+    case Phase::ClusterSize: return "averageClusterSize";
+    case Phase::Snapshot: return "snapshot";
+    case Phase::ShowGround: return "showGround";
+    case Phase::Step: return "step";
+    case Phase::Exchange: return "exchange";
+    default: return "unknown";
+    }
+}
+
+const char* counterName(Counter counter) {
+    switch (counter) {
+    case Counter::Picks: return "picks";
+    case Counter::Drops: return "drops";
+    case Counter::Swaps: return "swaps";
+    case Counter::InteractionChecks: return "interactionChecks";
+    case Counter::Interactions: return "interactions";
+    default: return "unknown";
+    }
+}
+
+ThreadTotals Report::total() const {
+    ThreadTotals sum;
+    for (const auto& t : threads) {
+        for (int p = 0; p < NUM_PHASES; ++p) {
+            sum.phaseNs[p] += t.phaseNs[p];
+            sum.phaseCalls[p] += t.phaseCalls[p];
+        }
+        for (int c = 0; c < NUM_COUNTERS; ++c) {
+            sum.counters[c] += t.counters[c];
+        }
+    }
+    return sum;
+}
+
+#ifdef ANT_PROFILING
+namespace {
+    // Each thread owns one slot and is its only writer, so updates are plain
+    // relaxed load/store pairs; the atomics only make collect() race-free.
+    struct Slot {
+        int thread = 0;
+        std::array<std::atomic<std::uint64_t>, NUM_PHASES> phaseNs{};
+        std::array<std::atomic<std::uint64_t>, NUM_PHASES> phaseCalls{};
+        std::array<std::atomic<std::uint64_t>, NUM_COUNTERS> counters{};
+    };
+
+    void bump(std::atomic<std::uint64_t>& value, std::uint64_t n) {
+        value.store(value.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+    }
+
+    struct Registry {
+        std::mutex mutex;
+        std::vector<std::unique_ptr<Slot>> slots;
+    };
+
+    // Never destroyed: worker threads may still record during static teardown.
+    Registry& registry() {
+        static Registry* instance = new Registry();
+        return *instance;
+    }
+
+    Slot& localSlot() {
+        thread_local Slot* slot = nullptr;
+        if (!slot) {
+            Registry& reg = registry();
+            std::lock_guard<std::mutex> lock(reg.mutex);
+            reg.slots.push_back(std::make_unique<Slot>());
+            slot = reg.slots.back().get();
+            slot->thread = static_cast<int>(reg.slots.size()) - 1;
+        }
+        return *slot;
+    }
+}
+
+void addTime(Phase phase, std::uint64_t ns) {
+    Slot& slot = localSlot();
+    bump(slot.phaseNs[static_cast<int>(phase)], ns);
+    bump(slot.phaseCalls[static_cast<int>(phase)], 1);
+}
+
+void addCount(Counter counter, std::uint64_t n) {
+    bump(localSlot().counters[static_cast<int>(counter)], n);
+}
+
+Report collect() {
+    Report report;
+    Registry& reg = registry();
+    std::lock_guard<std::mutex> lock(reg.mutex);
+    for (const auto& slot : reg.slots) {
+        ThreadTotals totals;
+        totals.thread = slot->thread;
+        for (int p = 0; p < NUM_PHASES; ++p) {
+            totals.phaseNs[p] = slot->phaseNs[p].load(std::memory_order_relaxed);
+            totals.phaseCalls[p] = slot->phaseCalls[p].load(std::memory_order_relaxed);
+        }
+        for (int c = 0; c < NUM_COUNTERS; ++c) {
+            totals.counters[c] = slot->counters[c].load(std::memory_order_relaxed);
+        }
+        report.threads.push_back(totals);
+    }
+    return report;
+}
+
+void reset() {
+    Registry& reg = registry();
+    std::lock_guard<std::mutex> lock(reg.mutex);
+    for (const auto& slot : reg.slots) {
+        for (auto& v : slot->phaseNs) v.store(0, std::memory_order_relaxed);
+        for (auto& v : slot->phaseCalls) v.store(0, std::memory_order_relaxed);
+        for (auto& v : slot->counters) v.store(0, std::memory_order_relaxed);
+    }
+}
+#else
+Report collect() {
+    return Report();
+}
+
+void reset() {
+}
+#endif
+
+namespace {
+    void writeTotalsJson(std::ostream& out, const ThreadTotals& totals) {
+        out << "{\"phases\": {";
+        for (int p = 0; p < NUM_PHASES; ++p) {
+            out << (p ? ", " : "") << "\"" << phaseName(static_cast<Phase>(p)) << "\": {\"ns\": "
+                << totals.phaseNs[p] << ", \"calls\": " << totals.phaseCalls[p] << "}";
+        }
+        out << "}, \"counters\": {";
+        for (int c = 0; c < NUM_COUNTERS; ++c) {
+            out << (c ? ", " : "") << "\"" << counterName(static_cast<Counter>(c)) << "\": " << totals.counters[c];
+        }
+        out << "}}";
+    }
+
+    void writeTotalsCsv(std::ostream& out, const std::string& thread, const ThreadTotals& totals) {
+        for (int p = 0; p < NUM_PHASES; ++p) {
+            out << thread << ",phase," << phaseName(static_cast<Phase>(p)) << ","
+                << totals.phaseCalls[p] << "," << totals.phaseNs[p] << "\n";
+        }
+        for (int c = 0; c < NUM_COUNTERS; ++c) {
+            out << thread << ",counter," << counterName(static_cast<Counter>(c)) << ",,"
+                << totals.counters[c] << "\n";
+        }
+    }
+}
+
+void writeJson(std::ostream& out, const Report& report) {
+    out << "{\"enabled\": " << (ENABLED ? "true" : "false") << ", \"total\": ";
+    writeTotalsJson(out, report.total());
+    out << ", \"threads\": [";
+    for (std::size_t i = 0; i < report.threads.size(); ++i) {
+        out << (i ? ", " : "") << "{\"thread\": " << report.threads[i].thread << ", \"totals\": ";
+        writeTotalsJson(out, report.threads[i]);
+        out << "}";
+    }
+    out << "]}\n";
+}
+
+void writeCsv(std::ostream& out, const Report& report) {
+    out << "Thread,Kind,Name,Calls,Value\n";
+    writeTotalsCsv(out, "total", report.total());
+    for (const auto& t : report.threads) {
+        writeTotalsCsv(out, std::to_string(t.thread), t);
+    }
+}
+
+void writeSummary(std::ostream& out, const Report& report) {
+    ThreadTotals total = report.total();
+    out << "Profile (" << report.threads.size() << " threads):" << std::endl;
+    for (int p = 0; p < NUM_PHASES; ++p) {
+        if (total.phaseCalls[p] == 0) {
+            continue;
+        }
+        out << "  " << std::left << std::setw(24) << phaseName(static_cast<Phase>(p)) << std::right
+            << std::fixed << std::setprecision(3) << std::setw(12) << total.phaseNs[p] * 1e-9 << " s"
+            << std::setw(14) << total.phaseCalls[p] << " calls" << std::defaultfloat << std::endl;
+    }
+    for (int c = 0; c < NUM_COUNTERS; ++c) {
+        out << "  " << std::left << std::setw(24) << counterName(static_cast<Counter>(c)) << std::right
+            << std::setw(14) << total.counters[c] << std::endl;
+    }
+}
+
+}
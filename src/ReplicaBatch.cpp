@@ -0,0 +1,273 @@
+#include "ant_intelligence/ReplicaBatch.h"
+#include "ant_intelligence/AntColony.h"
+#include "ant_intelligence/Neighborhood.h"
+#include "ant_intelligence/Profiling.h"
+#include "ant_intelligence/Rng.h"
+#include <algorithm>
+#include <stdexcept>
+
+namespace {
+    constexpr std::uint8_t NONE = static_cast<std::uint8_t>(AIConfig::ObjectType::None);
+}
+
+ReplicaBatch::ReplicaBatch(const std::vector<const Ground*>& replicas)
+    : replicaCount(replicas.size())
+{
+    if (replicas.empty()) {
+        throw std::invalid_argument("A replica batch needs at least one ground");
+    }
+    const Ground& first = *replicas.front();
+    width = first.width;
+    length = first.length;
+    numAnts = first.colony.size();
+    capacity = first.colony.empty() ? 0 : first.colony.getMemoryCapacity(0);
+    densityRamp = first.densityRamp;
+    neighborhood = first.neighborhood;
+    lanes = Neighborhood::laneMask(neighborhood);
+    moveSteps = first.moveSteps;
+    workSteps = first.workSteps;
+
+    const DirectionSampler& sampler = first.directionSampler;
+    if (sampler.size() != AIConfig::NUM_DIRECTIONS) {
+        throw std::invalid_argument("Replicas need one movement probability per direction");
+    }
+    const std::size_t tableSize = static_cast<std::size_t>(AIConfig::NUM_DIRECTIONS) * AIConfig::NUM_DIRECTIONS;
+    acceptance.assign(sampler.acceptanceTable(), sampler.acceptanceTable() + tableSize);
+    alias.assign(sampler.aliasTable(), sampler.aliasTable() + tableSize);
+
+    for (const Ground* ground : replicas) {
+        const AntColony& colony = ground->colony;
+        if (ground->width != width || ground->length != length
+            || ground->probabilities != first.probabilities || ground->probRelu != first.probRelu
+            || ground->neighborhood != neighborhood || colony.size() != numAnts
+            || (!colony.empty() && colony.fixedCapacity() != capacity)
+            || ground->moveSteps != moveSteps || ground->workSteps != workSteps
+            || ground->antSortInterval != 0) {
+            throw std::invalid_argument("Grounds cannot be batched together");
+        }
+    }
+
+    const std::size_t entries = numAnts * replicaCount;
+    ids.resize(entries);
+    xs.resize(entries);
+    ys.resize(entries);
+    directions.resize(entries);
+    loads.resize(entries);
+    cooldowns.resize(entries);
+    memory.resize(entries * static_cast<std::size_t>(capacity));
+    memoryHead.resize(entries);
+    memoryCount.resize(entries);
+    typeCounts.resize(entries * AIConfig::NUM_OBJECT_TYPES);
+    moveStates.resize(replicaCount);
+    workStates.resize(replicaCount);
+    cellHead.assign(static_cast<std::size_t>(width) * length * replicaCount, -1);
+    nextAnt.resize(entries);
+    antSlot.clear();
+
+    for (std::size_t r = 0; r < replicaCount; ++r) {
+        const Ground& ground = *replicas[r];
+        const AntColony& colony = ground.colony;
+        Grid grid(width, length);
+        ground.grid.exportRowMajor(grid.data());
+        grids.push_back(std::move(grid));
+        clusterTrackers.emplace_back(width, length);
+        seeds.push_back(ground.seed);
+        objectFills.push_back(ground.objectFills);
+        thresholds.push_back(ground.similarityThreshold);
+        cooldownDurations.push_back(ground.cooldown_duration);
+        interactions.push_back(ground.interactionCounter);
+
+        for (std::size_t i = 0; i < numAnts; ++i) {
+            const std::size_t k = i * replicaCount + r;
+            ids[k] = colony.ids[i];
+            xs[k] = colony.xs[i];
+            ys[k] = colony.ys[i];
+            directions[k] = colony.prevDirections[i];
+            loads[k] = colony.loads[i];
+            cooldowns[k] = colony.cooldowns[i];
+            memoryHead[k] = colony.memoryHead[i];
+            memoryCount[k] = colony.memoryCount[i];
+            std::copy_n(&colony.memory[i * colony.stride], capacity, &memory[k * capacity]);
+            std::copy_n(&colony.memoryTypeCounts[i * AIConfig::NUM_OBJECT_TYPES], AIConfig::NUM_OBJECT_TYPES,
+                &typeCounts[k * AIConfig::NUM_OBJECT_TYPES]);
+        }
+    }
+}
+
+void ReplicaBatch::step() {
+    ANT_PROFILE_SCOPE(Step);
+    const std::size_t R = replicaCount;
+    const std::uint64_t moveStream = Ground::streamId(Ground::RngStream::Move, 0);
+    const std::uint64_t workStream = Ground::streamId(Ground::RngStream::Work, 0);
+    const std::uint64_t moveHash = CounterRng::counterHash(moveSteps);
+    const std::uint64_t workHash = CounterRng::counterHash(workSteps);
+    const std::uint64_t* seed = seeds.data();
+    std::uint64_t* moveState = moveStates.data();
+    std::uint64_t* workState = workStates.data();
+
+    // Serial Ground order: each ant moves and works before the next one, and
+    // replicas only ever touch their own grid.
+    for (std::size_t i = 0; i < numAnts; ++i) {
+        const std::uint32_t* rowIds = &ids[i * R];
+#pragma omp simd
+        for (std::size_t r = 0; r < R; ++r) {
+            moveState[r] = CounterRng::keyFromCounterHash(seed[r], moveStream ^ rowIds[r], moveHash);
+            workState[r] = CounterRng::keyFromCounterHash(seed[r], workStream ^ rowIds[r], workHash);
+        }
+        for (std::size_t r = 0; r < R; ++r) {
+            moveAnt(i * R + r, r);
+        }
+        for (std::size_t r = 0; r < R; ++r) {
+            workAnt(i * R + r, r);
+        }
+    }
+    ++moveSteps;
+    ++workSteps;
+
+    // As in Ground::step, interactions read the post-work memories of every
+    // ant, and each ant's cooldown counts down right after its own check.
+    rebuildCells();
+    for (std::size_t k = 0; k < numAnts * R; ++k) {
+        interactAnt(k, k % R);
+    }
+}
+
+void ReplicaBatch::moveAnt(std::size_t k, std::size_t replica) {
+    CounterRng gen = CounterRng::fromState(moveStates[replica]);
+    const int x = xs[k];
+    const int y = ys[k];
+    int direction;
+    if (Neighborhood::isInterior(x, y, width, length)) {
+        // DirectionSampler::sample on the copied tables.
+        const int column = gen.uniformInt(AIConfig::NUM_DIRECTIONS);
+        const double coin = gen.uniform();
+        const int slot = directions[k] * AIConfig::NUM_DIRECTIONS + column;
+        direction = coin < acceptance[slot] ? column : alias[slot];
+    }
+    else {
+        const int mask = Neighborhood::validMask(x, y, width, length);
+        direction = Neighborhood::nthValidDirection(mask, gen.uniformInt(Neighborhood::countMask(mask)));
+    }
+    if (direction >= 0) {
+        xs[k] = x + AIConfig::DIRECTION_DX[direction];
+        ys[k] = y + AIConfig::DIRECTION_DY[direction];
+        directions[k] = static_cast<std::uint8_t>(direction);
+    }
+}
+
+void ReplicaBatch::workAnt(std::size_t k, std::size_t replica) {
+    CounterRng gen = CounterRng::fromState(workStates[replica]);
+    Grid& grid = grids[replica];
+    std::uint8_t* ring = &memory[k * capacity];
+    std::uint16_t* counts = &typeCounts[k * AIConfig::NUM_OBJECT_TYPES];
+    auto remember = [&](std::uint8_t type) {
+        MemoryRing::push(ring, memoryHead[k], memoryCount[k], capacity, counts, type);
+    };
+
+    const int x = xs[k];
+    const int y = ys[k];
+    const std::uint8_t groundType = static_cast<std::uint8_t>(grid.get(x, y));
+    const std::uint8_t carried = loads[k];
+    const auto& densities = densityRamp[Neighborhood::count(x, y, width, length, neighborhood)];
+
+    remember(groundType);
+    if (carried == NONE) {
+        if (groundType != NONE) {
+            const int matches = Neighborhood::countMatches(grid.neighbors(x, y), groundType, lanes);
+            if (gen.uniform() > densities[matches]) {
+                loads[k] = groundType;
+                grid.set(x, y, AIConfig::ObjectType::None);
+                clusterTrackers[replica].invalidate();
+                remember(groundType);
+            }
+        }
+    }
+    else {
+        remember(carried);
+        const int matches = Neighborhood::countMatches(grid.neighbors(x, y), carried, lanes);
+        if (gen.uniform() <= densities[matches]) {
+            grid.set(x, y, static_cast<AIConfig::ObjectType>(carried));
+            clusterTrackers[replica].invalidate();
+            loads[k] = groundType;
+            remember(carried);
+            remember(groundType);
+        }
+    }
+}
+
+void ReplicaBatch::rebuildCells() {
+    const std::size_t R = replicaCount;
+    const std::size_t cells = static_cast<std::size_t>(width) * length;
+    for (int slot : antSlot) {
+        cellHead[slot] = -1;
+    }
+    antSlot.resize(numAnts * R);
+    // Prepending in descending order leaves every list sorted ascending.
+    for (std::size_t i = numAnts; i-- > 0;) {
+        for (std::size_t r = 0; r < R; ++r) {
+            const std::size_t k = i * R + r;
+            const int slot = static_cast<int>(r * cells + static_cast<std::size_t>(ys[k]) * width + xs[k]);
+            antSlot[k] = slot;
+            nextAnt[k] = cellHead[slot];
+            cellHead[slot] = static_cast<int>(i);
+        }
+    }
+}
+
+void ReplicaBatch::interactAnt(std::size_t k, std::size_t replica) {
+    const std::size_t R = replicaCount;
+    if (cooldowns[k] == 0 && loads[k] != NONE) {
+        const int x = xs[k];
+        const int y = ys[k];
+        const int type = loads[k];
+        const int stencil = Neighborhood::stencilMask(neighborhood);
+        const int* replicaCells = &cellHead[replica * static_cast<std::size_t>(width) * length];
+        bool found = false;
+        for (int d = 0; d < AIConfig::NUM_DIRECTIONS && !found; ++d) {
+            const int nx = x + AIConfig::DIRECTION_DX[d];
+            const int ny = y + AIConfig::DIRECTION_DY[d];
+            if (!(stencil & (1 << d)) || nx < 0 || nx >= width || ny < 0 || ny >= length) {
+                continue;
+            }
+            for (int j = replicaCells[static_cast<std::size_t>(ny) * width + nx]; j != -1;
+                j = nextAnt[j * R + replica]) {
+                const std::size_t other = j * R + replica;
+                if (typeCounts[other * AIConfig::NUM_OBJECT_TYPES + type] >= thresholds[replica]) {
+                    ++interactions[replica];
+                    directions[k] = static_cast<std::uint8_t>((directions[other] + 4) % AIConfig::NUM_DIRECTIONS);
+                    cooldowns[k] = cooldownDurations[replica];
+                    found = true;
+                    break;
+                }
+            }
+        }
+    }
+    if (cooldowns[k] > 0) {
+        --cooldowns[k];
+    }
+}
+
+double ReplicaBatch::averageClusterSize(std::size_t replica) {
+    ANT_PROFILE_SCOPE(ClusterSize);
+    return clusterTrackers.at(replica).averageSize(grids[replica]);
+}
+
+void ReplicaBatch::saveState(std::size_t replica, std::ostream& out) const {
+    AntColony colony;
+    colony.reserve(numAnts);
+    for (std::size_t i = 0; i < numAnts; ++i) {
+        const std::size_t k = i * replicaCount + replica;
+        colony.add(xs[k], ys[k], directions[k], capacity);
+        colony.ids[i] = ids[k];
+        colony.loads[i] = loads[k];
+        colony.cooldowns[i] = cooldowns[k];
+        colony.memoryHead[i] = memoryHead[k];
+        colony.memoryCount[i] = memoryCount[k];
+        std::copy_n(&memory[k * capacity], capacity, &colony.memory[i * colony.stride]);
+        std::copy_n(&typeCounts[k * AIConfig::NUM_OBJECT_TYPES], AIConfig::NUM_OBJECT_TYPES,
+            &colony.memoryTypeCounts[i * AIConfig::NUM_OBJECT_TYPES]);
+    }
+    const Ground::StateCounters counters{ seeds[replica], objectFills[replica], moveSteps, workSteps,
+        interactions[replica] };
+    Ground::writeState(out, width, length, counters, grids[replica].data(), colony);
+}
@@ -0,0 +1,146 @@
+#include "ant_intelligence/ResultsWriter.h"
+#include "ant_intelligence/BinaryIO.h"
+#include <stdexcept>
+#include <utility>
+
+ResultsWriter::ResultsWriter(const std::string& filename, Format format, const std::string& metadata,
+    bool convergenceColumn)
+    : file(filename, format == Format::Binary ? std::ios_base::trunc | std::ios_base::binary : std::ios_base::trunc)
+    , format(format)
+    , metadata(metadata)
+    , convergenceColumn(convergenceColumn)
+{
+    if (!file.is_open()) {
+        throw std::runtime_error("Could not open the output file '" + filename + "' for writing");
+    }
+    if (format == Format::Csv) {
+        file << "Cooldown,Threshold,Run,Iteration,ClusterSize,InteractionCount"
+            << (convergenceColumn ? ",ConvergedIteration\n" : "\n");
+    }
+    writer = std::thread(&ResultsWriter::run, this);
+}
+
+ResultsWriter::Format ResultsWriter::parseFormat(const std::string& name) {
+    if (name == "csv") {
+        return Format::Csv;
+    }
+    if (name == "binary") {
+        return Format::Binary;
+    }
+    throw std::invalid_argument("Unknown output format '" + name + "' (expected csv or binary)");
+}
+
+ResultsWriter::~ResultsWriter() {
+    try {
+        finish();
+    }
+    catch (...) {
+        // Destructors must not throw; call finish() to observe write errors.
+    }
+}
+
+void ResultsWriter::submit(std::size_t sequence, std::vector<ResultRow> rows) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (finishing) {
+            throw std::runtime_error("ResultsWriter::submit called after finish");
+        }
+        if (sequence < nextSequence || !pending.emplace(sequence, std::move(rows)).second) {
+            throw std::invalid_argument("Run submitted twice to ResultsWriter");
+        }
+    }
+    ready.notify_one();
+}
+
+void ResultsWriter::finish() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        finishing = true;
+    }
+    ready.notify_one();
+    if (writer.joinable()) {
+        writer.join();
+    }
+    if (!file.is_open()) {
+        return;
+    }
+    if (format == Format::Binary && !failed && pending.empty()) {
+        writeColumns();
+    }
+    file.close();
+    if (failed || !pending.empty()) {
+        pending.clear();
+        throw std::runtime_error("ResultsWriter could not write every run in order");
+    }
+}
+
+void ResultsWriter::run() {
+    for (;;) {
+        std::vector<ResultRow> rows;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            ready.wait(lock, [this] {
+                return finishing || (!pending.empty() && pending.begin()->first == nextSequence);
+            });
+            if (pending.empty() || pending.begin()->first != nextSequence) {
+                return;
+            }
+            rows = std::move(pending.begin()->second);
+            pending.erase(pending.begin());
+            ++nextSequence;
+        }
+        // Formatting and I/O happen outside the lock.
+        writeRows(rows);
+    }
+}
+
+void ResultsWriter::writeRows(const std::vector<ResultRow>& rows) {
+    if (format == Format::Binary) {
+        for (const auto& row : rows) {
+            clusterSizes.push_back(row.clusterSize);
+            cooldowns.push_back(row.cooldown);
+            thresholds.push_back(row.threshold);
+            runs.push_back(row.run);
+            iterations.push_back(row.iteration);
+            interactionCounts.push_back(row.interactionCount);
+            if (convergenceColumn) {
+                convergedIterations.push_back(row.convergedIteration);
+            }
+        }
+        return;
+    }
+    for (const auto& row : rows) {
+        file << row.cooldown << "," << row.threshold << "," << row.run << "," << row.iteration << ","
+            << row.clusterSize << "," << row.interactionCount;
+        if (convergenceColumn) {
+            file << "," << row.convergedIteration;
+        }
+        file << "\n";
+    }
+    if (!file) {
+        failed = true;
+    }
+}
+
+void ResultsWriter::writeColumns() {
+    file.write("ANTCOL1\0", 8);
+    BinaryIO::write<std::uint32_t>(file, convergenceColumn ? 2 : 1);
+    BinaryIO::write<std::uint32_t>(file, static_cast<std::uint32_t>(metadata.size()));
+    file.write(metadata.data(), static_cast<std::streamsize>(metadata.size()));
+    // Pad so the float64 column starts 8-byte aligned for memory mapping.
+    BinaryIO::pad(file, 16 + metadata.size(), 8);
+
+    BinaryIO::write<std::uint64_t>(file, clusterSizes.size());
+    BinaryIO::writeArray(file, clusterSizes);
+    BinaryIO::writeArray(file, cooldowns);
+    BinaryIO::writeArray(file, thresholds);
+    BinaryIO::writeArray(file, runs);
+    BinaryIO::writeArray(file, iterations);
+    BinaryIO::writeArray(file, interactionCounts);
+    if (convergenceColumn) {
+        BinaryIO::writeArray(file, convergedIterations);
+    }
+    if (!file) {
+        failed = true;
+    }
+}
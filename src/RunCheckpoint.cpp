@@ -0,0 +1,154 @@
+#include "ant_intelligence/RunCheckpoint.h"
+#include "ant_intelligence/BinaryIO.h"
+#include "ant_intelligence/Ground.h"
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+namespace {
+    const char RUN_MAGIC[8] = { 'A', 'N', 'T', 'R', 'U', 'N', '2', '\0' };
+    const char RUN_MAGIC_V1[8] = { 'A', 'N', 'T', 'R', 'U', 'N', '1', '\0' };
+    const char DONE_MAGIC[8] = { 'A', 'N', 'T', 'D', 'O', 'N', 'E', '1' };
+
+    void writeIdentity(std::ostream& out, const RunIdentity& identity) {
+        BinaryIO::write<std::uint64_t>(out, identity.seed);
+        BinaryIO::write<std::uint32_t>(out, static_cast<std::uint32_t>(identity.parameters.size()));
+        for (const auto& parameter : identity.parameters) {
+            BinaryIO::write<double>(out, parameter.second);
+        }
+    }
+
+    // Read an identity and, if expected is given, throw unless it matches.
+    void checkIdentity(std::istream& in, const std::string& filename, const RunIdentity* expected) {
+        const std::uint64_t seed = BinaryIO::read<std::uint64_t>(in);
+        const std::uint32_t count = BinaryIO::read<std::uint32_t>(in);
+        if (expected && count != expected->parameters.size()) {
+            throw std::runtime_error("Checkpoint " + filename + " has an unknown parameter layout");
+        }
+        for (std::uint32_t k = 0; k < count; ++k) {
+            const double value = BinaryIO::read<double>(in);
+            if (expected && value != expected->parameters[k].second) {
+                throw std::runtime_error("Checkpoint " + filename + " was written with a different "
+                    + expected->parameters[k].first + "; rerun with the original value or remove it");
+            }
+        }
+        if (expected && seed != expected->seed) {
+            throw std::runtime_error("Checkpoint " + filename
+                + " was written with a different --seed; rerun with the original value or remove it");
+        }
+    }
+
+    void writeRows(std::ostream& out, const std::vector<ResultRow>& rows) {
+        BinaryIO::write<std::uint64_t>(out, rows.size());
+        for (const auto& row : rows) {
+            BinaryIO::write<std::int32_t>(out, row.iteration);
+            BinaryIO::write<double>(out, row.clusterSize);
+            BinaryIO::write<std::int32_t>(out, row.interactionCount);
+        }
+    }
+
+    void readRows(std::istream& in, const ResultRow& tag, std::vector<ResultRow>& rows) {
+        const std::uint64_t count = BinaryIO::read<std::uint64_t>(in);
+        rows.clear();
+        for (std::uint64_t k = 0; k < count; ++k) {
+            ResultRow row{ tag.cooldown, tag.threshold, tag.run, 0, 0.0, 0 };
+            row.iteration = BinaryIO::read<std::int32_t>(in);
+            row.clusterSize = BinaryIO::read<double>(in);
+            row.interactionCount = BinaryIO::read<std::int32_t>(in);
+            rows.push_back(row);
+        }
+    }
+
+    // Write through filename.tmp and move it into place.
+    void writeAtomically(const std::string& filename, const std::function<void(std::ostream&)>& write) {
+        const std::string tempFilename = filename + ".tmp";
+        {
+            std::ofstream out(tempFilename, std::ios_base::binary | std::ios_base::trunc);
+            write(out);
+            if (!out) {
+                throw std::runtime_error("Failed to write checkpoint " + tempFilename);
+            }
+        }
+        std::remove(filename.c_str());
+        if (std::rename(tempFilename.c_str(), filename.c_str()) != 0) {
+            throw std::runtime_error("Failed to move checkpoint into place: " + filename);
+        }
+    }
+}
+
+void RunCheckpoint::save(const std::string& filename, const std::function<void(std::ostream&)>& writeState,
+    const RunIdentity& identity, int nextIteration, const std::vector<ResultRow>& rows) {
+    writeAtomically(filename, [&](std::ostream& out) {
+        writeState(out);
+        out.write(RUN_MAGIC, sizeof(RUN_MAGIC));
+        writeIdentity(out, identity);
+        BinaryIO::write<std::int32_t>(out, nextIteration);
+        writeRows(out, rows);
+    });
+}
+
+bool RunCheckpoint::load(const std::string& filename, const ResultRow& tag, const RunIdentity* expected,
+    Ground& ground, int& nextIteration, std::vector<ResultRow>& rows) {
+    std::ifstream in(filename, std::ios_base::binary);
+    if (!in.is_open()) {
+        return false;
+    }
+    ground.loadState(in);
+    char magic[sizeof(RUN_MAGIC)];
+    BinaryIO::readBytes(in, magic, sizeof(magic));
+    const bool versioned = std::equal(magic, magic + sizeof(magic), RUN_MAGIC);
+    if (!versioned && !std::equal(magic, magic + sizeof(magic), RUN_MAGIC_V1)) {
+        throw std::runtime_error("Not a run checkpoint: " + filename);
+    }
+    if (versioned) {
+        checkIdentity(in, filename, expected);
+    }
+    else if (expected) {
+        throw std::runtime_error("Checkpoint " + filename + " records no run parameters and cannot be resumed");
+    }
+    nextIteration = BinaryIO::read<std::int32_t>(in);
+    readRows(in, tag, rows);
+    return true;
+}
+
+void RunCheckpoint::saveDone(const std::string& filename, const RunIdentity& identity, int convergedIteration,
+    const std::vector<ResultRow>& rows) {
+    writeAtomically(filename, [&](std::ostream& out) {
+        out.write(DONE_MAGIC, sizeof(DONE_MAGIC));
+        writeIdentity(out, identity);
+        BinaryIO::write<std::int32_t>(out, convergedIteration);
+        writeRows(out, rows);
+    });
+}
+
+bool RunCheckpoint::loadDone(const std::string& filename, const ResultRow& tag, const RunIdentity& expected,
+    std::vector<ResultRow>& rows) {
+    std::ifstream in(filename, std::ios_base::binary);
+    if (!in.is_open()) {
+        return false;
+    }
+    char magic[sizeof(DONE_MAGIC)];
+    BinaryIO::readBytes(in, magic, sizeof(magic));
+    if (!std::equal(magic, magic + sizeof(magic), DONE_MAGIC)) {
+        throw std::runtime_error("Not a finished run record: " + filename);
+    }
+    checkIdentity(in, filename, &expected);
+    const int convergedIteration = BinaryIO::read<std::int32_t>(in);
+    readRows(in, tag, rows);
+    for (auto& row : rows) {
+        row.convergedIteration = convergedIteration;
+    }
+    return true;
+}
+
+std::uint64_t RunCheckpoint::stateHash(const Ground& ground) {
+    std::ostringstream state;
+    ground.saveState(state);
+    std::uint64_t hash = 0xcbf29ce484222325ULL;
+    for (char byte : state.str()) {
+        hash = (hash ^ static_cast<std::uint8_t>(byte)) * 0x100000001b3ULL;
+    }
+    return hash;
+}
@@ -0,0 +1,14 @@
+#include "ant_intelligence/VisitBitmap.h"
+#include <algorithm>
+
+VisitBitmap::VisitBitmap(int width, int length)
+    : width(width > 0 ? width : 0)
+    , length(length > 0 ? length : 0)
+    , words((static_cast<std::size_t>(this->width) * static_cast<std::size_t>(this->length) + 63) / 64, 0)
+{
+}
+
+void VisitBitmap::clear() {
+    std::fill(words.begin(), words.end(), 0);
+    visited = 0;
+}
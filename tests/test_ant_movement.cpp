@@ -6,10 +6,10 @@
 //
 // How to compile (from the root project directory):
 //   Using g++:
-//   g++ -std=c++17 -Iinclude tests/run_all_tests.cpp src/Ant.cpp src/Ground.cpp -o tests/ant_suite
+//   g++ -std=c++17 -Iinclude tests/run_all_tests.cpp src/Ant.cpp src/AntColony.cpp src/Ground.cpp src/Grid.cpp src/DirectionSampler.cpp src/MemoryRing.cpp src/CellIndex.cpp src/ClusterTracker.cpp src/ConvergenceDetector.cpp src/FramePipeline.cpp src/ResultsWriter.cpp src/MetricsStream.cpp src/Profiling.cpp src/VisitBitmap.cpp src/Communicator.cpp src/DistributedGround.cpp src/DistributedRun.cpp src/DeviceGround.cpp src/ReplicaBatch.cpp src/RunCheckpoint.cpp -o tests/ant_suite
 //
 //   Using MSVC (Visual Studio Command Prompt):
-//   cl /EHsc /Iinclude tests/run_all_tests.cpp src/Ant.cpp src/Ground.cpp /Fe:tests/ant_suite.exe
+//   cl /EHsc /Iinclude tests/run_all_tests.cpp src/Ant.cpp src/AntColony.cpp src/Ground.cpp src/Grid.cpp src/DirectionSampler.cpp src/MemoryRing.cpp src/CellIndex.cpp src/ClusterTracker.cpp src/ConvergenceDetector.cpp src/FramePipeline.cpp src/ResultsWriter.cpp src/MetricsStream.cpp src/Profiling.cpp src/VisitBitmap.cpp src/Communicator.cpp src/DistributedGround.cpp src/DistributedRun.cpp src/DeviceGround.cpp src/ReplicaBatch.cpp src/RunCheckpoint.cpp /Fe:tests/ant_suite.exe
 //
 // How to run:
 //   ./tests/ant_suite
@@ -19,15 +19,46 @@
 #include "ant_intelligence/Ground.h" // Now needed for interaction tests
 #include "ant_intelligence/Config.h"
 #include "ant_intelligence/Objects.h"
+#include "ant_intelligence/Grid.h"
+#include "ant_intelligence/AntColony.h"
+#include "ant_intelligence/MemoryRing.h"
+#include "ant_intelligence/CellIndex.h"
+#include "ant_intelligence/ClusterTracker.h"
+#include "ant_intelligence/Neighborhood.h"
+#include "ant_intelligence/FramePipeline.h"
+#include "ant_intelligence/ResultsWriter.h"
+#include "ant_intelligence/MetricsStream.h"
+#include "ant_intelligence/ConvergenceDetector.h"
+#include "ant_intelligence/Profiling.h"
+#include "ant_intelligence/VisitBitmap.h"
+#include "ant_intelligence/Rng.h"
+#include "ant_intelligence/Communicator.h"
+#include "ant_intelligence/DistributedGround.h"
+#include "ant_intelligence/DistributedRun.h"
+#include "ant_intelligence/DeviceGround.h"
+#include "ant_intelligence/ReplicaBatch.h"
+#include "ant_intelligence/RunCheckpoint.h"
 #include <iostream>
 #include <vector>
 #include <map>
+#include <set>
 #include <numeric>
 #include <algorithm>
 #include <string>
 #include <functional>
 #include <random> // Added for std::mt19937
+#include <cmath>
 #include <deque>  // Added for std::deque
+#include <fstream>
+#include <sstream>
+#include <thread>
+#include <cstdio>
+#include <cstring>
+#include <iterator>
+#include <memory>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 // A simple helper struct to manage running tests and reporting results.
 struct TestSuite {
@@ -64,9 +95,10 @@ struct TestSuite {
 // (This section is unchanged)
 bool test_movement_for_single_direction(int prevDirection, const std::vector<double>& probabilities, int numSamples) {
     Ant testAnt;
+    CounterRng gen(AIConfig::DEFAULT_SEED, static_cast<std::uint64_t>(prevDirection));
     std::map<int, int> directionCounts;
     for (int i = 0; i < numSamples; ++i) {
-        directionCounts[testAnt.getRandomWeightedDirection(probabilities, prevDirection)]++;
+        directionCounts[testAnt.getRandomWeightedDirection(probabilities, prevDirection, gen)]++;
     }
     auto mostFrequent = std::max_element(directionCounts.begin(), directionCounts.end(),
         [](const auto& a, const auto& b) { return a.second < b.second; });
@@ -91,6 +123,58 @@ bool test_movement_inertia() {
     return all_passed;
 }
 
+// The alias tables must reproduce the rotated distribution of
+// getRandomWeightedDirection for every previous direction.
+bool test_direction_sampler_matches_rotation() {
+    const int numSamples = 200000;
+    std::vector<double> prob = { 12, 5, 2, 1, 0.1, 1, 2, 5 };
+    double prob_sum = std::accumulate(prob.begin(), prob.end(), 0.0);
+    for (auto& p : prob) { p /= prob_sum; }
+
+    DirectionSampler sampler(prob);
+    CounterRng gen(12345);
+    bool all_passed = true;
+    for (int prev = 0; prev < AIConfig::NUM_DIRECTIONS; ++prev) {
+        std::vector<int> counts(AIConfig::NUM_DIRECTIONS, 0);
+        for (int i = 0; i < numSamples; ++i) {
+            counts[sampler.sample(prev, gen)]++;
+        }
+        for (int d = 0; d < AIConfig::NUM_DIRECTIONS; ++d) {
+            // Rotating right by prev moves weight k to direction (k + prev) % 8.
+            double expected = prob[(d - prev + AIConfig::NUM_DIRECTIONS) % AIConfig::NUM_DIRECTIONS];
+            double observed = double(counts[d]) / numSamples;
+            double sigma = std::sqrt(expected * (1.0 - expected) / numSamples);
+            if (std::abs(observed - expected) > 5.0 * sigma + 1e-9
+                || std::abs(sampler.probability(prev, d) - expected) > 1e-12) {
+                std::cout << "  [FAIL] prev " << prev << ", dir " << d << ": expected " << expected
+                    << ", observed " << observed << std::endl;
+                all_passed = false;
+            }
+        }
+    }
+    return all_passed;
+}
+
+// A block of stream states filled in pieces must yield exactly the
+// generators keyed one entity at a time.
+bool test_rng_block_matches_keys() {
+    const std::uint64_t seed = 77;
+    const std::uint64_t stream = 3ULL << 56;
+    CounterRngBlock block;
+    block.prepare(seed, stream, 41, 1000);
+    block.fill(0, 300);
+    block.fill(300, 1000);
+    for (std::size_t i = 0; i < block.size(); ++i) {
+        CounterRng expected(seed, stream ^ i, 41);
+        CounterRng actual = block.at(i);
+        if (expected() != actual() || expected() != actual()) {
+            std::cout << "  [FAIL] Block state " << i << " differs from its keyed generator." << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
 
 // --- Test Case 2: Ant Memory Logic ---
 // OPTIMIZATION: Updated to test the std::deque-based memory
@@ -144,8 +228,12 @@ bool run_single_interaction_test(int threshold, int num_matching_memories) {
         antB.updateMemory(std::make_shared<Food>());
     }
     int loadType = 1;
-    auto& antB_memory = antB.getMemory(); // Get reference to the deque
+    const auto antB_memory = antB.getMemory();
     auto similarity = std::count(antB_memory.begin(), antB_memory.end(), loadType);
+    if (similarity != antB.countMemory(AIConfig::ObjectType::Food)) {
+        std::cout << "    [FAIL] Running memory count disagrees with the FIFO contents." << std::endl;
+        return false;
+    }
     return similarity >= threshold;
 }
 
@@ -205,11 +293,11 @@ bool test_movement_at_boundaries() {
     bool all_passed = true;
 
     // Create a random number generator for this test.
-    std::random_device rd;
-    std::mt19937 gen(rd());
+    CounterRng gen(AIConfig::DEFAULT_SEED);
 
     auto possiblePositions = get_test_possible_positions(width, length);
     std::vector<double> uniform_prob(AIConfig::NUM_DIRECTIONS, 1.0 / AIConfig::NUM_DIRECTIONS);
+    DirectionSampler sampler(uniform_prob);
 
     auto run_boundary_test = [&](const std::pair<int, int>& startPos, const std::string& posName) {
         const auto& legalNextPositions = possiblePositions.at(startPos);
@@ -217,7 +305,7 @@ bool test_movement_at_boundaries() {
         for (int i = 0; i < numSamples; ++i) {
             Ant sampleAnt(startPos, width, length, false, 5);
             // Pass the generator to the move function.
-            sampleAnt.move(possiblePositions, uniform_prob, gen);
+            sampleAnt.move(sampler, gen);
             auto newPos = sampleAnt.getPosition();
 
             bool found_in_legal_moves = false;
@@ -248,15 +336,1774 @@ bool test_movement_at_boundaries() {
     return all_passed;
 }
 
+// The offset tables with their boundary mask must list exactly the in-bounds
+// neighbours, in the same order as an explicit adjacency list.
+bool test_neighborhood_matches_adjacency() {
+    bool all_passed = true;
+    for (auto dims : std::vector<std::pair<int, int>>{ { 1, 1 }, { 2, 5 }, { 4, 3 }, { 6, 6 } }) {
+        auto adjacency = get_test_possible_positions(dims.first, dims.second);
+        for (const auto& entry : adjacency) {
+            int x = entry.first.first;
+            int y = entry.first.second;
+            int mask = Neighborhood::validMask(x, y, dims.first, dims.second);
+            int count = Neighborhood::count(x, y, dims.first, dims.second);
+            bool ok = count == static_cast<int>(entry.second.size())
+                && Neighborhood::countMask(mask) == count
+                && Neighborhood::isInterior(x, y, dims.first, dims.second) == (count == AIConfig::NUM_DIRECTIONS);
+            for (int k = 0; ok && k < count; ++k) {
+                int d = Neighborhood::nthValidDirection(mask, k);
+                ok = std::make_pair(x + AIConfig::DIRECTION_DX[d], y + AIConfig::DIRECTION_DY[d]) == entry.second[k];
+            }
+            if (!ok) {
+                std::cout << "  [FAIL] Neighbourhood of (" << x << "," << y << ") on a "
+                    << dims.first << "x" << dims.second << " grid is wrong." << std::endl;
+                all_passed = false;
+            }
+        }
+    }
+    return all_passed;
+}
+
+
+// The packed SWAR count must agree with a direct scan of the neighbourhood,
+// on the border as well as in the interior, for every type and stencil.
+bool test_packed_neighbor_counts() {
+    bool all_passed = true;
+    std::mt19937 rng(7);
+    std::uniform_int_distribution<int> typeDist(0, AIConfig::NUM_OBJECT_TYPES - 1);
+    for (auto dims : std::vector<std::pair<int, int>>{ { 1, 1 }, { 2, 5 }, { 3, 3 }, { 9, 7 } }) {
+        Grid grid(dims.first, dims.second);
+        for (int y = 0; y < dims.second; ++y) {
+            for (int x = 0; x < dims.first; ++x) {
+                grid.set(x, y, static_cast<AIConfig::ObjectType>(typeDist(rng)));
+            }
+        }
+        for (auto type : { AIConfig::NeighborhoodType::Moore, AIConfig::NeighborhoodType::VonNeumann }) {
+            const int stencil = Neighborhood::stencilMask(type);
+            for (int y = 0; y < dims.second; ++y) {
+                for (int x = 0; x < dims.first; ++x) {
+                    std::uint64_t packed = Neighborhood::gather(grid.data(), x, y, dims.first, dims.second);
+                    for (int t = 0; t < AIConfig::NUM_OBJECT_TYPES; ++t) {
+                        int expected = 0;
+                        for (int d = 0; d < AIConfig::NUM_DIRECTIONS; ++d) {
+                            int nx = x + AIConfig::DIRECTION_DX[d];
+                            int ny = y + AIConfig::DIRECTION_DY[d];
+                            expected += (stencil & (1 << d)) && grid.inBounds(nx, ny)
+                                && grid.get(nx, ny) == static_cast<AIConfig::ObjectType>(t);
+                        }
+                        int counted = Neighborhood::countMatches(packed, static_cast<std::uint8_t>(t),
+                            Neighborhood::laneMask(type));
+                        if (counted != expected) {
+                            std::cout << "  [FAIL] Packed count at (" << x << "," << y << ") on a " << dims.first
+                                << "x" << dims.second << " grid for type " << t << ": expected " << expected
+                                << ", got " << counted << std::endl;
+                            all_passed = false;
+                        }
+                    }
+                }
+            }
+        }
+    }
+    return all_passed;
+}
+
+// --- Test Case 5: Flat Type Grid ---
+bool test_grid_row_major_storage() {
+    Grid grid(4, 3);
+    if (grid.size() != 12) {
+        std::cout << "  [FAIL] Expected 12 cells, got " << grid.size() << std::endl;
+        return false;
+    }
+    grid.set(1, 2, AIConfig::ObjectType::Egg);
+    grid.set(2, 1, AIConfig::ObjectType::Food);
+
+    // (x, y) and (y, x) must be distinct cells.
+    bool ok = grid.get(1, 2) == AIConfig::ObjectType::Egg
+        && grid.get(2, 1) == AIConfig::ObjectType::Food
+        && grid.data()[2 * 4 + 1] == static_cast<std::uint8_t>(AIConfig::ObjectType::Egg)
+        && grid.count(AIConfig::ObjectType::None) == 10
+        && !grid.inBounds(4, 0) && !grid.inBounds(0, 3);
+    if (!ok) {
+        std::cout << "  [FAIL] Row-major indexing or counting is wrong." << std::endl;
+    }
+    return ok;
+}
+
+bool test_ground_object_fill() {
+    Ground ground(20, 30, {}, { 0.3, 0.7 }, 10);
+    std::unordered_map<std::shared_ptr<Object>, double> objDict = {
+        {std::make_shared<Food>(), 1.0}
+    };
+    ground.addObject(objDict);
+    const Grid& grid = ground.getGrid();
+    if (grid.getWidth() != 20 || grid.getLength() != 30
+        || grid.count(AIConfig::ObjectType::Food) != grid.size()) {
+        std::cout << "  [FAIL] Ground did not fill every cell with Food." << std::endl;
+        return false;
+    }
+    return ground.getObjectType({ 19, 29 }) == AIConfig::ObjectType::Food;
+}
+
+// --- Test Case 6: Type-Tagged Loads ---
+bool test_object_type_adapter() {
+    Ant testAnt({}, 0, 0, false, 3);
+    testAnt.setLoad(std::make_shared<Waste>());
+    if (testAnt.getLoad() != AIConfig::ObjectType::Waste || !testAnt.hasLoad()) {
+        std::cout << "  [FAIL] Waste instance was not stored as a Waste tag." << std::endl;
+        return false;
+    }
+    testAnt.setLoad(nullptr);
+    if (testAnt.hasLoad()) {
+        std::cout << "  [FAIL] nullptr load should clear the carried type." << std::endl;
+        return false;
+    }
+    for (auto type : { AIConfig::ObjectType::Food, AIConfig::ObjectType::Waste, AIConfig::ObjectType::Egg }) {
+        if (objectTypeOf(makeObject(type)) != type) {
+            std::cout << "  [FAIL] makeObject/objectTypeOf round trip failed." << std::endl;
+            return false;
+        }
+    }
+    return makeObject(AIConfig::ObjectType::None) == nullptr;
+}
+
+// --- Test Case 7: Seeded Reproducibility ---
+
+// Helper that runs a small simulation and returns its grid plus ant positions.
+std::vector<int> run_seeded_simulation(std::uint64_t seed,
+    AIConfig::StepMode mode = AIConfig::StepMode::Serial,
+    int width = 30, int length = 20, int numAnts = 25) {
+    std::vector<double> prob = { 12, 5, 2, 1, 0.1, 1, 2, 5 };
+    Ground ground(width, length, prob, { 0.3, 0.7 }, 5, 5, seed);
+    ground.setStepMode(mode);
+    std::unordered_map<AIConfig::ObjectType, double> objDict = {
+        {AIConfig::ObjectType::Food, 0.1}, {AIConfig::ObjectType::Egg, 0.1},
+        {AIConfig::ObjectType::None, 0.8}
+    };
+    ground.addObject(objDict);
+    for (int i = 0; i < numAnts; ++i) {
+        ground.addAnt(10);
+    }
+    for (int i = 0; i < 200; ++i) {
+        ground.moveAnts();
+        ground.assignWork();
+        ground.handleAntInteractions(i);
+    }
+
+    const Grid& grid = ground.getGrid();
+    std::vector<int> state(grid.data(), grid.data() + grid.size());
+    for (const auto& ant : ground.getAgents()) {
+        state.push_back(ant.getPosition().first);
+        state.push_back(ant.getPosition().second);
+        state.push_back(static_cast<int>(ant.getLoad()));
+    }
+    state.push_back(ground.getInteractionCount());
+    return state;
+}
+
+bool test_seeded_reproducibility() {
+    auto first = run_seeded_simulation(42);
+    auto second = run_seeded_simulation(42);
+    auto other = run_seeded_simulation(43);
+    if (first != second) {
+        std::cout << "  [FAIL] Two runs with the same seed diverged." << std::endl;
+        return false;
+    }
+    if (first == other) {
+        std::cout << "  [FAIL] Different seeds produced identical runs." << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// addAnts places exactly the ants of repeated addAnt calls, and a large
+// object fill is the same on one thread as on several.
+bool test_bulk_initialization() {
+    const std::vector<double> probabilities(AIConfig::NUM_DIRECTIONS, 1.0 / AIConfig::NUM_DIRECTIONS);
+    const std::unordered_map<AIConfig::ObjectType, double> objects = {
+        { AIConfig::ObjectType::Food, 0.1 }, { AIConfig::ObjectType::Egg, 0.2 },
+        { AIConfig::ObjectType::Waste, 0.05 }, { AIConfig::ObjectType::None, 0.65 } };
+    // Wide enough for the threaded fill, and not square, so rows and columns cannot be confused.
+    const int width = 300, length = 257;
+    auto build = [&](int threads, bool bulk) {
+#ifdef _OPENMP
+        int maxThreads = omp_get_max_threads();
+        omp_set_num_threads(threads);
+#else
+        (void)threads;
+#endif
+        Ground ground(width, length, probabilities, { 0.3, 0.7 }, 10, 5, 99);
+        ground.addObject(objects);
+#ifdef _OPENMP
+        omp_set_num_threads(maxThreads);
+#endif
+        if (bulk) {
+            ground.addAnt(6);
+            ground.addAnts(499, 6);
+        }
+        else {
+            for (int i = 0; i < 500; ++i) {
+                ground.addAnt(6);
+            }
+        }
+        std::stringstream bytes;
+        ground.saveState(bytes);
+        return bytes.str();
+    };
+    const std::string reference = build(1, false);
+    if (build(1, true) != reference) {
+        std::cout << "  [FAIL] addAnts placed ants differently from addAnt." << std::endl;
+        return false;
+    }
+    if (build(4, false) != reference) {
+        std::cout << "  [FAIL] Object fill depends on the thread count." << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// --- Test Case 8: Parallel Step Mode ---
+bool test_parallel_step_is_thread_count_independent() {
+    const int width = 70, length = 45, numAnts = 300;
+#ifdef _OPENMP
+    int maxThreads = omp_get_max_threads();
+    omp_set_num_threads(1);
+#endif
+    auto single = run_seeded_simulation(7, AIConfig::StepMode::Parallel, width, length, numAnts);
+#ifdef _OPENMP
+    omp_set_num_threads(std::max(4, maxThreads));
+#endif
+    auto multi = run_seeded_simulation(7, AIConfig::StepMode::Parallel, width, length, numAnts);
+#ifdef _OPENMP
+    omp_set_num_threads(maxThreads);
+#endif
+    if (single != multi) {
+        std::cout << "  [FAIL] Parallel step result depends on the thread count." << std::endl;
+        return false;
+    }
+
+    // Objects are neither created nor destroyed: grid objects plus carried loads.
+    auto serial = run_seeded_simulation(7, AIConfig::StepMode::Serial, width, length, numAnts);
+    auto countObjects = [&](const std::vector<int>& state) {
+        int total = 0;
+        for (int i = 0; i < width * length; ++i) total += state[i] != 0;
+        for (int a = 0; a < numAnts; ++a) total += state[width * length + 3 * a + 2] != 0;
+        return total;
+    };
+    if (countObjects(multi) != countObjects(serial)) {
+        std::cout << "  [FAIL] Parallel step did not conserve objects." << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// --- Test Case 9: Structure-of-Arrays Colony ---
+bool test_colony_memory_matches_ant() {
+    AntColony colony;
+    colony.add(1, 2, 3, 3);
+    Ant reference({ 1, 2 }, 0, 0, false, 3);
+
+    const AIConfig::ObjectType sequence[] = {
+        AIConfig::ObjectType::Food, AIConfig::ObjectType::None, AIConfig::ObjectType::Waste,
+        AIConfig::ObjectType::Egg, AIConfig::ObjectType::Food, AIConfig::ObjectType::Food
+    };
+    for (auto type : sequence) {
+        colony.updateMemory(0, type);
+        reference.updateMemory(type);
+    }
+    // A larger ant forces the shared memory array to re-stride.
+    colony.add(4, 5, 6, 8);
+    colony.updateMemory(1, AIConfig::ObjectType::Egg);
+
+    if (colony.getMemory(0) != reference.getMemory()) {
+        std::cout << "  [FAIL] Colony ring diverged from the Ant memory FIFO." << std::endl;
+        return false;
+    }
+    bool ok = colony.countMemory(0, AIConfig::ObjectType::Food) == 2
+        && colony.getMemory(1) == std::deque<int>{ 3 }
+        && colony.getX(1) == 4 && colony.getY(1) == 5 && colony.getPrevDirection(1) == 6;
+    if (!ok) {
+        std::cout << "  [FAIL] Colony state after re-stride is wrong." << std::endl;
+    }
+    return ok;
+}
+
+// --- Test Case 10: Memory Ring Running Counts ---
+bool test_memory_ring_counts() {
+    MemoryRing ring(5);
+    std::deque<int> expected;
+    for (int step = 0; step < 40; ++step) {
+        auto type = static_cast<AIConfig::ObjectType>((step * 7 + step / 3) % AIConfig::NUM_OBJECT_TYPES);
+        ring.push(type);
+        if (type != AIConfig::ObjectType::None) {
+            if (expected.size() == 5) {
+                expected.pop_front();
+            }
+            expected.push_back(static_cast<int>(type));
+        }
+        if (ring.toDeque() != expected) {
+            std::cout << "  [FAIL] Ring contents diverged at step " << step << "." << std::endl;
+            return false;
+        }
+        for (int t = 1; t < AIConfig::NUM_OBJECT_TYPES; ++t) {
+            if (ring.count(static_cast<AIConfig::ObjectType>(t)) != std::count(expected.begin(), expected.end(), t)) {
+                std::cout << "  [FAIL] Count for type " << t << " wrong at step " << step << "." << std::endl;
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+// --- Test Case 11: Cell List Index ---
+bool test_cell_index() {
+    AntColony colony;
+    colony.add(2, 3, 0, 1);
+    colony.add(4, 1, 0, 1);
+    colony.add(2, 3, 0, 1);
+    CellIndex index(6, 5);
+    index.rebuild(colony);
+
+    int a = index.first(2, 3);
+    bool ok = a == 0 && index.next(a) == 2 && index.next(index.next(a)) == -1
+        && index.countAt(4, 1) == 1 && index.first(0, 0) == -1 && index.first(-1, 3) == -1;
+
+    // Moving ants must clear their old cells on the next rebuild.
+    colony.setPosition(0, 5, 4);
+    colony.setPosition(2, 4, 1);
+    index.rebuild(colony);
+    ok = ok && index.countAt(2, 3) == 0 && index.countAt(5, 4) == 1
+        && index.first(4, 1) == 1 && index.next(1) == 2;
+    if (!ok) {
+        std::cout << "  [FAIL] Cell list does not match ant positions." << std::endl;
+    }
+    return ok;
+}
+
+// Reference flood fill: mean size of 8-connected same-type clusters.
+double brute_force_average_cluster(const Grid& grid) {
+    std::vector<bool> visited(grid.size(), false);
+    size_t objects = 0, clusters = 0;
+    for (int y = 0; y < grid.getLength(); ++y) {
+        for (int x = 0; x < grid.getWidth(); ++x) {
+            auto type = grid.get(x, y);
+            if (type == AIConfig::ObjectType::None || visited[grid.index(x, y)]) continue;
+            ++clusters;
+            std::vector<std::pair<int, int>> stack = { { x, y } };
+            visited[grid.index(x, y)] = true;
+            while (!stack.empty()) {
+                auto cur = stack.back();
+                stack.pop_back();
+                ++objects;
+                for (int d = 0; d < AIConfig::NUM_DIRECTIONS; ++d) {
+                    int nx = cur.first + AIConfig::DIRECTION_DX[d];
+                    int ny = cur.second + AIConfig::DIRECTION_DY[d];
+                    if (grid.inBounds(nx, ny) && !visited[grid.index(nx, ny)] && grid.get(nx, ny) == type) {
+                        visited[grid.index(nx, ny)] = true;
+                        stack.push_back({ nx, ny });
+                    }
+                }
+            }
+        }
+    }
+    return clusters == 0 ? 0.0 : double(objects) / clusters;
+}
+
+// --- Test Case 12: Incremental Cluster Tracking ---
+bool test_cluster_tracker_matches_flood_fill() {
+    Grid grid(12, 9);
+    ClusterTracker tracker(12, 9);
+    CounterRng gen(99);
+    for (int step = 0; step < 3000; ++step) {
+        int x = gen.uniformInt(12);
+        int y = gen.uniformInt(9);
+        auto oldType = grid.get(x, y);
+        // Bias toward empty cells so clusters both grow and split.
+        auto newType = static_cast<AIConfig::ObjectType>(gen.uniformInt(6) < 3 ? 0 : 1 + gen.uniformInt(3));
+        grid.set(x, y, newType);
+        tracker.update(grid, x, y, oldType);
+        if (step % 7 == 0 && tracker.averageSize(grid) != brute_force_average_cluster(grid)) {
+            std::cout << "  [FAIL] Tracker disagrees with flood fill at step " << step << "." << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+// --- Test Case 13: Asynchronous Frame Pipeline ---
+bool test_frame_pipeline() {
+    const int scale = 6;
+    Ground ground(8, 5, std::vector<double>(AIConfig::NUM_DIRECTIONS, 1.0), { 0.3, 0.7 }, 5, 5, 11);
+    ground.addObject(std::unordered_map<AIConfig::ObjectType, double>{
+        { AIConfig::ObjectType::Food, 0.3 }, { AIConfig::ObjectType::None, 0.7 } });
+    for (int i = 0; i < 3; ++i) {
+        ground.addAnt(5);
+    }
+
+    // Rasteriser: x runs down the rows, y across the columns.
+    FrameSnapshot frame;
+    ground.snapshot(frame);
+    std::vector<std::uint8_t> pixels;
+    FramePipeline::rasterize(frame, scale, pixels);
+    auto pixel = [&](int x, int y, int channel) {
+        int row = x * scale + scale / 2;
+        int col = y * scale + scale / 2;
+        return pixels[(static_cast<size_t>(row) * frame.length * scale + col) * 3 + channel];
+    };
+    bool ok = pixels.size() == static_cast<size_t>(8 * scale) * (5 * scale) * 3
+        && pixel(frame.antX[0], frame.antY[0], 2) == 255 && pixel(frame.antX[0], frame.antY[0], 1) == 0;
+    for (int x = 0; ok && x < 8; ++x) {
+        for (int y = 0; ok && y < 5; ++y) {
+            bool hasAnt = false;
+            for (size_t i = 0; i < frame.antX.size(); ++i) {
+                hasAnt = hasAnt || (frame.antX[i] == x && frame.antY[i] == y);
+            }
+            if (!hasAnt && ground.getObjectType({ x, y }) == AIConfig::ObjectType::None) {
+                ok = pixel(x, y, 0) == 255 && pixel(x, y, 1) == 255 && pixel(x, y, 2) == 255;
+            }
+            else if (!hasAnt) {
+                ok = pixel(x, y, 0) == 0 && pixel(x, y, 1) == 255 && pixel(x, y, 2) == 0;
+            }
+        }
+    }
+    if (!ok) {
+        std::cout << "  [FAIL] Rasterised frame has wrong colours." << std::endl;
+        return false;
+    }
+
+    // A shallow queue forces the producer to wait on the worker; every frame
+    // must arrive, in order, identical to an inline rasterisation.
+    std::vector<std::vector<std::uint8_t>> expected;
+    std::vector<std::vector<std::uint8_t>> received;
+    {
+        FramePipeline pipeline(scale, 2, [&](const std::uint8_t* bgr, int rows, int cols) {
+            received.emplace_back(bgr, bgr + static_cast<size_t>(rows) * cols * 3);
+        });
+        for (int step = 0; step < 12; ++step) {
+            ground.moveAnts();
+            ground.assignWork();
+            ground.snapshot(frame);
+            FramePipeline::rasterize(frame, scale, pixels);
+            expected.push_back(pixels);
+            pipeline.submit(ground);
+        }
+        pipeline.close();
+        ok = pipeline.framesWritten() == expected.size();
+    }
+    if (!ok || received != expected) {
+        std::cout << "  [FAIL] Pipeline dropped or reordered frames." << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// --- Test Case 14: Ordered In-Memory Results ---
+bool test_results_writer_order() {
+    const std::string filename = "test_results_writer.csv";
+    {
+        ResultsWriter writer(filename);
+        // Runs finish out of order on different threads.
+        std::vector<std::thread> workers;
+        for (int run : { 3, 0, 2, 1 }) {
+            workers.emplace_back([&writer, run] {
+                std::vector<ResultRow> rows;
+                for (int i = 0; i < 3; ++i) {
+                    rows.push_back({ 5, 10, run + 1, i * 100, 1.5 + run, run * 10 + i });
+                }
+                writer.submit(static_cast<size_t>(run), std::move(rows));
+            });
+        }
+        for (auto& worker : workers) {
+            worker.join();
+        }
+        writer.finish();
+    }
+
+    std::ostringstream expected;
+    expected << "Cooldown,Threshold,Run,Iteration,ClusterSize,InteractionCount\n";
+    for (int run = 0; run < 4; ++run) {
+        for (int i = 0; i < 3; ++i) {
+            expected << 5 << "," << 10 << "," << run + 1 << "," << i * 100 << ","
+                << 1.5 + run << "," << run * 10 + i << "\n";
+        }
+    }
+    std::ifstream in(filename);
+    std::stringstream actual;
+    actual << in.rdbuf();
+    in.close();
+    std::remove(filename.c_str());
+    if (actual.str() != expected.str()) {
+        std::cout << "  [FAIL] Results were not written in sequence order." << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// The binary columnar file must follow the documented little-endian layout.
+bool test_results_writer_binary_layout() {
+    const std::string filename = "test_results_writer.antcol";
+    const std::string metadata = "{\"seed\": 7}";
+    {
+        ResultsWriter writer(filename, ResultsWriter::Format::Binary, metadata);
+        writer.submit(1, { { 5, 10, 2, 100, 2.25, 9 } });
+        writer.submit(0, { { 5, 10, 1, 0, 1.5, -3 }, { 5, 10, 1, 100, 0.125, 4 } });
+        writer.finish();
+    }
+    std::ifstream in(filename, std::ios::binary);
+    std::string bytes((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    in.close();
+    std::remove(filename.c_str());
+
+    auto readLE = [&](size_t offset, int width) {
+        std::uint64_t value = 0;
+        for (int k = width - 1; k >= 0; --k) {
+            value = (value << 8) | static_cast<unsigned char>(bytes[offset + k]);
+        }
+        return value;
+    };
+    size_t offset = 16 + metadata.size();
+    offset += (8 - offset % 8) % 8;
+    bool ok = bytes.compare(0, 8, std::string("ANTCOL1\0", 8)) == 0
+        && readLE(8, 4) == 1 && readLE(12, 4) == metadata.size()
+        && bytes.compare(16, metadata.size(), metadata) == 0
+        && readLE(offset, 8) == 3
+        && bytes.size() == offset + 8 + 3 * 8 + 5 * 3 * 4;
+    if (ok) {
+        offset += 8;
+        const double sizes[] = { 1.5, 0.125, 2.25 };
+        for (int i = 0; i < 3; ++i) {
+            std::uint64_t bits = readLE(offset + 8 * i, 8);
+            double value;
+            std::memcpy(&value, &bits, sizeof(value));
+            ok = ok && value == sizes[i];
+        }
+        offset += 3 * 8;
+        // Columns: Cooldown, Threshold, Run, Iteration, InteractionCount.
+        const std::int32_t expected[5][3] = { { 5, 5, 5 }, { 10, 10, 10 }, { 1, 1, 2 }, { 0, 100, 100 }, { -3, 4, 9 } };
+        for (int c = 0; c < 5; ++c) {
+            for (int i = 0; i < 3; ++i) {
+                ok = ok && static_cast<std::int32_t>(readLE(offset + (c * 3 + i) * 4, 4)) == expected[c][i];
+            }
+        }
+    }
+    if (!ok) {
+        std::cout << "  [FAIL] Binary results file does not match the documented layout." << std::endl;
+    }
+    return ok;
+}
+
+// Events published from several threads all reach the stream, one valid line
+// each, between the start and end events; a full buffer drops samples, never
+// blocks, and still takes run ends.
+bool test_metrics_stream() {
+    const std::string filename = "test_metrics_stream.ndjson";
+    const int threads = 4;
+    const int samples = 50;
+    bool published = true;
+    {
+        MetricsStream stream(filename, threads, "{\"seed\": 7}");
+        std::vector<std::thread> workers;
+        std::vector<char> ok(threads, 1);
+        for (int run = 0; run < threads; ++run) {
+            workers.emplace_back([&stream, &ok, run] {
+                for (int i = 0; i < samples; ++i) {
+                    ok[run] &= stream.publishSample({ 5, 10, run + 1, i * 100, 0.5 * i, i });
+                }
+                ok[run] &= stream.publishRunEnd(5, 10, run + 1);
+            });
+        }
+        for (auto& worker : workers) {
+            worker.join();
+        }
+        for (char flag : ok) {
+            published = published && flag;
+        }
+        stream.finish();
+        published = published && stream.dropped() == 0;
+    }
+
+    std::ifstream in(filename);
+    std::vector<std::string> lines;
+    for (std::string line; std::getline(in, line);) {
+        lines.push_back(line);
+    }
+    in.close();
+    std::remove(filename.c_str());
+
+    // Per run, samples arrive in publication order and end with run_end.
+    std::vector<int> nextSample(threads, 0);
+    std::vector<bool> ended(threads, false);
+    bool ok = published && lines.size() == static_cast<size_t>(threads * (samples + 1) + 2)
+        && lines.front() == "{\"event\": \"start\", \"runs\": 4, \"parameters\": {\"seed\": 7}}"
+        && lines.back() == "{\"event\": \"end\", \"dropped\": 0}";
+    for (size_t k = 1; ok && k + 1 < lines.size(); ++k) {
+        int run = 0;
+        int iteration = 0;
+        double cluster = 0.0;
+        int interactions = 0;
+        if (std::sscanf(lines[k].c_str(), "{\"event\": \"sample\", \"cooldown\": 5, \"threshold\": 10, \"run\": %d, "
+            "\"iteration\": %d, \"cluster\": %lf, \"interactions\": %d}", &run, &iteration, &cluster, &interactions) == 4) {
+            const int i = nextSample[run - 1]++;
+            ok = !ended[run - 1] && iteration == i * 100 && cluster == 0.5 * i && interactions == i;
+        }
+        else if (std::sscanf(lines[k].c_str(), "{\"event\": \"run_end\", \"cooldown\": 5, \"threshold\": 10, \"run\": %d}", &run) == 1) {
+            ok = !ended[run - 1] && nextSample[run - 1] == samples;
+            ended[run - 1] = true;
+        }
+        else {
+            ok = false;
+        }
+    }
+
+    // A stream whose buffer is full drops new samples and counts them, but
+    // the run end that follows a dropped sample still gets through.
+    {
+        MetricsStream stream(filename, 1, "{}", 2);
+        int accepted = 0;
+        bool dropped = false;
+        for (int i = 0; i < 1000; ++i) {
+            const bool sent = stream.publishSample({ 0, 0, 1, i, 1.0, 0 });
+            accepted += sent ? 1 : 0;
+            dropped = dropped || !sent;
+        }
+        const bool ended = stream.publishRunEnd(0, 0, 1);
+        stream.finish();
+        ok = ok && dropped && ended && accepted >= 2 && stream.dropped() == static_cast<std::uint64_t>(1000 - accepted);
+    }
+    std::ifstream full(filename);
+    int runEnds = 0;
+    for (std::string line; std::getline(full, line);) {
+        runEnds += line.find("\"run_end\"") != std::string::npos ? 1 : 0;
+    }
+    full.close();
+    ok = ok && runEnds == 1;
+    std::remove(filename.c_str());
+
+    if (!ok) {
+        std::cout << "  [FAIL] Metrics stream lost, reordered or malformed events." << std::endl;
+    }
+    return ok;
+}
+
+// A run converges once the window of samples is flat within the tolerance,
+// and the iteration it stopped at is written as an extra results column.
+bool test_convergence_detector() {
+    bool ok = true;
+
+    // Growth, then a plateau: converged on the third flat sample of a 2-interval window.
+    ConvergenceDetector detector(2, 0.01);
+    const double series[] = { 1.0, 2.0, 3.0, 4.0, 4.01, 4.02, 4.0, 3.0 };
+    int convergedAt = -1;
+    for (int k = 0; k < 8 && convergedAt < 0; ++k) {
+        if (detector.add(series[k])) {
+            convergedAt = k;
+        }
+    }
+    ok = ok && convergedAt == 5 && detector.converged() && detector.add(100.0);
+
+    // Oscillation around a level never settles, however small the change between the ends.
+    ConvergenceDetector oscillating(2, 0.01);
+    for (int k = 0; k < 20; ++k) {
+        ok = ok && !oscillating.add(k % 2 == 0 ? 4.0 : 5.0);
+    }
+
+    // A zero tolerance disables detection.
+    ConvergenceDetector disabled(2, 0.0);
+    for (int k = 0; k < 10; ++k) {
+        ok = ok && !disabled.add(1.0);
+    }
+    ok = ok && !disabled.enabled();
+
+    bool threw = false;
+    try {
+        ConvergenceDetector invalid(0, 0.1);
+    }
+    catch (const std::invalid_argument&) {
+        threw = true;
+    }
+    ok = ok && threw;
+
+    const std::string filename = "test_convergence_column.csv";
+    {
+        ResultsWriter writer(filename, ResultsWriter::Format::Csv, "", true);
+        ResultRow converged{ 5, 10, 1, 500, 2.5, 7 };
+        converged.convergedIteration = 500;
+        writer.submit(0, { converged });
+        writer.submit(1, { { 5, 10, 2, 500, 1.5, 3 } });
+        writer.finish();
+    }
+    std::ifstream in(filename);
+    std::stringstream actual;
+    actual << in.rdbuf();
+    in.close();
+    std::remove(filename.c_str());
+    ok = ok && actual.str() == "Cooldown,Threshold,Run,Iteration,ClusterSize,InteractionCount,ConvergedIteration\n"
+        "5,10,1,500,2.5,7,500\n5,10,2,500,1.5,3,-1\n";
+
+    if (!ok) {
+        std::cout << "  [FAIL] Convergence was not detected or recorded as expected." << std::endl;
+    }
+    return ok;
+}
+
+// --- Test Case 15: Checkpoint and Resume ---
+bool test_save_and_load_state() {
+    std::vector<double> prob = { 12, 5, 2, 1, 0.1, 1, 2, 5 };
+    auto makeGround = [&]() { return Ground(30, 20, prob, { 0.3, 0.7 }, 5, 5, 77); };
+    auto step = [](Ground& ground, int from, int to) {
+        for (int i = from; i < to; ++i) {
+            ground.moveAnts();
+            ground.assignWork();
+            ground.handleAntInteractions(i);
+        }
+    };
+    auto fingerprint = [](Ground& ground) {
+        std::stringstream bytes;
+        ground.saveState(bytes);
+        return std::make_pair(bytes.str(), ground.averageClusterSize());
+    };
+
+    Ground original = makeGround();
+    original.addObject(std::unordered_map<AIConfig::ObjectType, double>{
+        { AIConfig::ObjectType::Food, 0.1 }, { AIConfig::ObjectType::Waste, 0.1 }, { AIConfig::ObjectType::None, 0.8 } });
+    for (int i = 0; i < 25; ++i) {
+        original.addAnt(10);
+    }
+    step(original, 0, 150);
+
+    std::stringstream checkpoint;
+    original.saveState(checkpoint);
+    Ground resumed = makeGround();
+    resumed.loadState(checkpoint);
+
+    step(original, 150, 300);
+    step(resumed, 150, 300);
+    if (fingerprint(original) != fingerprint(resumed) || original.getInteractionCount() != resumed.getInteractionCount()) {
+        std::cout << "  [FAIL] Resumed ground diverged from the uninterrupted one." << std::endl;
+        return false;
+    }
+
+    // Mismatched dimensions and garbage must be rejected without touching the ground.
+    Ground other(31, 20, prob, { 0.3, 0.7 }, 5, 5, 1);
+    std::stringstream again;
+    original.saveState(again);
+    std::stringstream garbage("not a checkpoint at all");
+    bool rejected = false;
+    try { other.loadState(again); } catch (const std::runtime_error&) { rejected = true; }
+    try { other.loadState(garbage); rejected = false; } catch (const std::runtime_error&) {}
+    if (!rejected || !other.getColony().empty()) {
+        std::cout << "  [FAIL] Invalid state was accepted." << std::endl;
+        return false;
+    }
+
+    // Stored type counters are rebuilt from the ring; loads and ring bytes
+    // that are not object types are rejected. One ant with stride 4: its load
+    // is byte 21, the counters start at byte 32 and the ring follows them.
+    AntColony colony;
+    colony.add(1, 1, 0, 4);
+    colony.updateMemory(0, AIConfig::ObjectType::Food);
+    colony.updateMemory(0, AIConfig::ObjectType::Waste);
+    std::stringstream saved;
+    colony.save(saved);
+    const std::string bytes = saved.str();
+    const std::size_t countsAt = 32, ringAt = countsAt + 2 * AIConfig::NUM_OBJECT_TYPES;
+    auto patchedLoad = [&](std::size_t offset, char value) {
+        std::string patched = bytes;
+        patched[offset] = value;
+        std::stringstream in(patched);
+        AntColony loaded;
+        loaded.load(in);
+        return loaded.countMemory(0, AIConfig::ObjectType::Food);
+    };
+    auto rejects = [&](std::size_t offset) {
+        try { patchedLoad(offset, static_cast<char>(200)); } catch (const std::runtime_error&) { return true; }
+        return false;
+    };
+    const std::size_t foodCount = countsAt + 2 * static_cast<int>(AIConfig::ObjectType::Food);
+    if (patchedLoad(foodCount, 9) != 1 || !rejects(21) || !rejects(ringAt) || !rejects(ringAt + 3)) {
+        std::cout << "  [FAIL] Corrupt colony memory was accepted." << std::endl;
+        return false;
+    }
+    std::stringstream single;
+    colony.saveAnt(0, single);
+    std::string antBytes = single.str();
+    antBytes[24 + 2 * AIConfig::NUM_OBJECT_TYPES] = static_cast<char>(200);
+    std::stringstream corruptAnt(antBytes);
+    bool antRejected = false;
+    try { colony.loadAnt(corruptAnt); } catch (const std::runtime_error&) { antRejected = true; }
+    if (!antRejected || colony.size() != 1) {
+        std::cout << "  [FAIL] Corrupt ant memory was accepted." << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// --- Run checkpoints only resume the run they were written for ---
+bool test_run_checkpoint_identity() {
+    const std::string filename = "test_run_checkpoint.antsnap";
+    std::vector<double> prob = { 0.125, 0.125, 0.125, 0.125, 0.125, 0.125, 0.125, 0.125 };
+    Ground ground(12, 9, prob, { 0.3, 0.7 }, 10, 5, 3);
+    ground.addAnts(6, 5);
+    const RunIdentity identity{ 42, { { "--ants", 6 }, { "--prob_relu_low", 0.3 } } };
+    std::vector<ResultRow> rows;
+    for (int i = 0; i < 4; ++i) {
+        rows.push_back({ 5, 10, 2, i * 100, 1.0 / (i + 3), i * 7 });
+    }
+    RunCheckpoint::save(filename, [&](std::ostream& out) { ground.saveState(out); }, identity, 400, rows);
+
+    auto load = [&](const RunIdentity* expected, std::vector<ResultRow>& restored) {
+        Ground target(12, 9, prob, { 0.3, 0.7 }, 10, 5, 1);
+        int next = 0;
+        const bool found = RunCheckpoint::load(filename, { 5, 10, 2, 0, 0.0, 0 }, expected, target, next, restored);
+        return found && next == 400 && target.getColony().size() == 6;
+    };
+    auto rejected = [&](const RunIdentity& expected) {
+        std::vector<ResultRow> restored;
+        try { load(&expected, restored); } catch (const std::runtime_error&) { return true; }
+        return false;
+    };
+    std::vector<ResultRow> any, same;
+    bool ok = load(nullptr, any) && load(&identity, same) && same.size() == rows.size();
+    for (std::size_t k = 0; ok && k < rows.size(); ++k) {
+        ok = same[k].iteration == rows[k].iteration && same[k].clusterSize == rows[k].clusterSize
+            && same[k].interactionCount == rows[k].interactionCount && same[k].run == 2;
+    }
+    RunIdentity otherSeed = identity, otherAnts = identity;
+    otherSeed.seed = 43;
+    otherAnts.parameters[0].second = 7;
+    ok = ok && rejected(otherSeed) && rejected(otherAnts);
+
+    // Seeded runs identify their starting ground by its hash, which a
+    // reload keeps and any other ground changes.
+    Ground reloaded(12, 9, prob, { 0.3, 0.7 }, 2, 3, 1);
+    Ground other(12, 9, prob, { 0.3, 0.7 }, 10, 5, 4);
+    other.addAnts(6, 5);
+    int resumeAt = 0;
+    ok = ok && RunCheckpoint::load(filename, {}, nullptr, reloaded, resumeAt, any)
+        && RunCheckpoint::stateHash(reloaded) == RunCheckpoint::stateHash(ground)
+        && RunCheckpoint::stateHash(other) != RunCheckpoint::stateHash(ground);
+    std::remove(filename.c_str());
+    Ground unused(12, 9, prob, { 0.3, 0.7 }, 10, 5, 1);
+    int next = 0;
+    ok = ok && !RunCheckpoint::load(filename, {}, nullptr, unused, next, any);
+    if (!ok) {
+        std::cout << "  [FAIL] Run checkpoint identity was not enforced." << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// --- A sweep killed after its first run resumes to the same results file ---
+// Mirrors ConsoleApp_ffmpeg: finished runs leave done records, running ones
+// checkpoints, and the resumed sweep rewrites the results file from both.
+bool test_resumed_sweep_matches_uninterrupted() {
+    std::vector<double> prob = { 12, 5, 2, 1, 0.1, 1, 2, 5 };
+    double prob_sum = std::accumulate(prob.begin(), prob.end(), 0.0);
+    for (auto& p : prob) {
+        p /= prob_sum;
+    }
+    const int runs = 3, iterations = 400, interval = 50;
+    auto identity = [&](int run) { return RunIdentity{ static_cast<std::uint64_t>(run), { { "run", run } } }; };
+    auto makeGround = [&](int run) {
+        Ground ground(25, 20, prob, { 0.3, 0.7 }, 10, 5, static_cast<std::uint64_t>(run));
+        ground.addObject(std::unordered_map<AIConfig::ObjectType, double>{
+            { AIConfig::ObjectType::Food, 0.1 }, { AIConfig::ObjectType::Waste, 0.1 }, { AIConfig::ObjectType::None, 0.8 } });
+        ground.addAnts(20, 10);
+        return ground;
+    };
+    auto step = [&](Ground& ground, int run, int from, int to, std::vector<ResultRow>& rows) {
+        for (int i = from; i < to; ++i) {
+            ground.step();
+            if (i % interval == 0) {
+                rows.push_back({ 5, 10, run, i, ground.averageClusterSize(), ground.getInteractionCount(), -1 });
+            }
+        }
+    };
+    auto checkpointName = [](int run) { return "test_resume_R" + std::to_string(run) + ".antsnap"; };
+    auto doneName = [](int run) { return "test_resume_R" + std::to_string(run) + ".antdone"; };
+    auto readFile = [](const std::string& filename) {
+        std::ifstream in(filename, std::ios_base::binary);
+        std::stringstream bytes;
+        bytes << in.rdbuf();
+        return bytes.str();
+    };
+
+    {
+        ResultsWriter writer("test_resume_expected.csv", ResultsWriter::Format::Csv, "", true);
+        for (int run = 1; run <= runs; ++run) {
+            Ground ground = makeGround(run);
+            std::vector<ResultRow> rows;
+            step(ground, run, 0, iterations, rows);
+            // Stands in for a converged run, whose iteration the done record keeps.
+            for (auto& row : rows) {
+                row.convergedIteration = run == 1 ? iterations - interval : -1;
+            }
+            writer.submit(static_cast<std::size_t>(run - 1), std::move(rows));
+        }
+        writer.finish();
+    }
+
+    // Run 1 finishes and run 2 checkpoints half way before the process is
+    // killed; the results file never sees a row.
+    {
+        ResultsWriter killed("test_resume_actual.csv", ResultsWriter::Format::Csv, "", true);
+        Ground first = makeGround(1);
+        std::vector<ResultRow> rows;
+        step(first, 1, 0, iterations, rows);
+        RunCheckpoint::saveDone(doneName(1), identity(1), iterations - interval, rows);
+        Ground second = makeGround(2);
+        rows.clear();
+        step(second, 2, 0, iterations / 2, rows);
+        RunCheckpoint::save(checkpointName(2), [&](std::ostream& out) { second.saveState(out); },
+            identity(2), iterations / 2, rows);
+    }
+
+    {
+        ResultsWriter writer("test_resume_actual.csv", ResultsWriter::Format::Csv, "", true);
+        for (int run = 1; run <= runs; ++run) {
+            const ResultRow tag{ 5, 10, run, 0, 0.0, 0 };
+            std::vector<ResultRow> rows;
+            if (!RunCheckpoint::loadDone(doneName(run), tag, identity(run), rows)) {
+                // Runs without a checkpoint start from the fresh ground.
+                Ground ground = makeGround(run);
+                int next = 0;
+                const RunIdentity expected = identity(run);
+                RunCheckpoint::load(checkpointName(run), tag, &expected, ground, next, rows);
+                step(ground, run, next, iterations, rows);
+            }
+            writer.submit(static_cast<std::size_t>(run - 1), std::move(rows));
+        }
+        writer.finish();
+    }
+
+    const std::string expected = readFile("test_resume_expected.csv");
+    const bool same = !expected.empty() && expected == readFile("test_resume_actual.csv");
+    for (const std::string& filename : { std::string("test_resume_expected.csv"), std::string("test_resume_actual.csv"),
+        doneName(1), checkpointName(2) }) {
+        std::remove(filename.c_str());
+    }
+    if (!same) {
+        std::cout << "  [FAIL] The resumed sweep wrote different results." << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool test_profiling_report() {
+    Profiling::Report report;
+    Profiling::ThreadTotals a, b;
+    a.thread = 0;
+    a.phaseNs[static_cast<int>(Profiling::Phase::MoveAnts)] = 5;
+    a.counters[static_cast<int>(Profiling::Counter::Picks)] = 2;
+    b.thread = 1;
+    b.phaseNs[static_cast<int>(Profiling::Phase::MoveAnts)] = 7;
+    b.counters[static_cast<int>(Profiling::Counter::Picks)] = 3;
+    report.threads = { a, b };
+    Profiling::ThreadTotals total = report.total();
+    if (total.phaseNs[static_cast<int>(Profiling::Phase::MoveAnts)] != 12
+        || total.counters[static_cast<int>(Profiling::Counter::Picks)] != 5) {
+        std::cout << "  [FAIL] Thread totals were not summed." << std::endl;
+        return false;
+    }
+
+    std::stringstream csv;
+    Profiling::writeCsv(csv, report);
+    std::string line;
+    int rows = 0;
+    while (std::getline(csv, line)) {
+        ++rows;
+    }
+    // Header, then one row per phase and counter for the total and each thread.
+    if (rows != 1 + 3 * (Profiling::NUM_PHASES + Profiling::NUM_COUNTERS)) {
+        std::cout << "  [FAIL] Unexpected CSV row count " << rows << std::endl;
+        return false;
+    }
+
+    Profiling::reset();
+    Ground ground(20, 20, { 12, 5, 2, 1, 0.1, 1, 2, 5 }, { 0.3, 0.7 }, 2, 5, 3);
+    ground.addObject(std::unordered_map<AIConfig::ObjectType, double>{
+        { AIConfig::ObjectType::Food, 0.3 }, { AIConfig::ObjectType::None, 0.7 } });
+    for (int i = 0; i < 20; ++i) {
+        ground.addAnt(5);
+    }
+    for (int i = 0; i < 50; ++i) {
+        ground.moveAnts();
+        ground.assignWork();
+        ground.handleAntInteractions(i);
+    }
+    Profiling::ThreadTotals recorded = Profiling::collect().total();
+    if (!Profiling::ENABLED) {
+        // Compiled out: nothing may be recorded.
+        return recorded.phaseCalls[static_cast<int>(Profiling::Phase::MoveAnts)] == 0;
+    }
+    std::uint64_t events = recorded.counters[static_cast<int>(Profiling::Counter::Picks)]
+        + recorded.counters[static_cast<int>(Profiling::Counter::Drops)]
+        + recorded.counters[static_cast<int>(Profiling::Counter::Swaps)];
+    if (recorded.phaseCalls[static_cast<int>(Profiling::Phase::MoveAnts)] != 50 || events == 0
+        || recorded.counters[static_cast<int>(Profiling::Counter::Interactions)]
+            > recorded.counters[static_cast<int>(Profiling::Counter::InteractionChecks)]) {
+        std::cout << "  [FAIL] Profile counters do not match the steps taken." << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool test_fused_step_matches_phases() {
+    std::vector<double> prob = { 12, 5, 2, 1, 0.1, 1, 2, 5 };
+    for (auto mode : { AIConfig::StepMode::Serial, AIConfig::StepMode::Parallel }) {
+        auto makeGround = [&]() {
+            Ground ground(40, 30, prob, { 0.3, 0.7 }, 3, 4, 123);
+            ground.setStepMode(mode);
+            ground.addObject(std::unordered_map<AIConfig::ObjectType, double>{
+                { AIConfig::ObjectType::Food, 0.1 }, { AIConfig::ObjectType::Egg, 0.1 },
+                { AIConfig::ObjectType::Waste, 0.1 }, { AIConfig::ObjectType::None, 0.7 } });
+            for (int i = 0; i < 60; ++i) {
+                ground.addAnt(8);
+            }
+            return ground;
+        };
+        Ground phased = makeGround();
+        Ground fused = makeGround();
+        for (int i = 0; i < 400; ++i) {
+            phased.moveAnts();
+            phased.assignWork();
+            phased.handleAntInteractions(i);
+            fused.step();
+        }
+        std::stringstream a, b;
+        phased.saveState(a);
+        fused.saveState(b);
+        if (a.str() != b.str() || phased.averageClusterSize() != fused.averageClusterSize()) {
+            std::cout << "  [FAIL] Fused step diverged from the phased step." << std::endl;
+            return false;
+        }
+        if (phased.getInteractionCount() == 0) {
+            std::cout << "  [FAIL] Scenario produced no interactions to compare." << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+bool test_visited_path_recording() {
+    const int width = 15, length = 12;
+    DirectionSampler sampler({ 12, 5, 2, 1, 0.1, 1, 2, 5 });
+
+    // Off by default: nothing is recorded.
+    Ant quiet({ 5, 5 }, width, length);
+    CounterRng quietGen(1, 0, 0);
+    for (int i = 0; i < 50; ++i) {
+        quiet.move(sampler, quietGen);
+    }
+    if (!quiet.getVisitedPositions().empty()) {
+        std::cout << "  [FAIL] Ant recorded a path without recordPath." << std::endl;
+        return false;
+    }
+
+    Ant ant({ 5, 5 }, width, length, true);
+    CounterRng gen(2, 0, 0);
+    std::set<std::pair<int, int>> expected;
+    for (int i = 0; i < 500; ++i) {
+        ant.move(sampler, gen);
+        expected.insert(ant.getPosition());
+    }
+    const VisitBitmap& visited = ant.getVisitedPositions();
+    if (visited.size() != expected.size()) {
+        std::cout << "  [FAIL] Bitmap holds " << visited.size() << " cells, expected " << expected.size() << std::endl;
+        return false;
+    }
+    for (int y = 0; y < length; ++y) {
+        for (int x = 0; x < width; ++x) {
+            if (visited.contains(x, y) != (expected.count({ x, y }) > 0)) {
+                std::cout << "  [FAIL] Cell (" << x << ", " << y << ") recorded wrongly." << std::endl;
+                return false;
+            }
+        }
+    }
+    if (visited.contains(-1, 0) || visited.contains(width, 0)) {
+        std::cout << "  [FAIL] Off-grid cells reported as visited." << std::endl;
+        return false;
+    }
+
+    // Ground coverage: every move lands somewhere, and covered counts distinct cells.
+    for (auto mode : { AIConfig::StepMode::Serial, AIConfig::StepMode::Parallel }) {
+        Ground ground(width, length, { 12, 5, 2, 1, 0.1, 1, 2, 5 }, { 0.3, 0.7 }, 5, 5, 9);
+        ground.setStepMode(mode);
+        for (int i = 0; i < 30; ++i) {
+            ground.addAnt(5);
+        }
+        ground.setRecordPath(true);
+        for (int i = 0; i < 40; ++i) {
+            ground.moveAnts();
+        }
+        std::uint64_t moves = 0;
+        std::size_t nonzero = 0;
+        for (int y = 0; y < length; ++y) {
+            for (int x = 0; x < width; ++x) {
+                moves += ground.visitCount(x, y);
+                nonzero += ground.visitCount(x, y) > 0;
+            }
+        }
+        if (moves != 30u * 40u || nonzero != ground.coveredCells()) {
+            std::cout << "  [FAIL] Coverage counts " << moves << " moves over " << ground.coveredCells()
+                      << " cells, grid shows " << nonzero << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+bool test_specialized_kernels_match_generic() {
+    std::vector<double> prob = { 12, 5, 2, 1, 0.1, 1, 2, 5 };
+    for (auto neighborhood : { AIConfig::NeighborhoodType::Moore, AIConfig::NeighborhoodType::VonNeumann }) {
+        for (int memorySize : { 10, 20, 32, 7 }) {
+            auto makeGround = [&](bool specialized) {
+                Ground ground(25, 25, prob, { 0.3, 0.7 }, 2, 4, 55);
+                ground.setNeighborhood(neighborhood);
+                ground.setSpecializedKernels(specialized);
+                ground.addObject(std::unordered_map<AIConfig::ObjectType, double>{
+                    { AIConfig::ObjectType::Food, 0.15 }, { AIConfig::ObjectType::Egg, 0.15 },
+                    { AIConfig::ObjectType::None, 0.7 } });
+                for (int i = 0; i < 40; ++i) {
+                    ground.addAnt(memorySize);
+                }
+                return ground;
+            };
+            Ground specialized = makeGround(true);
+            Ground generic = makeGround(false);
+            bool expectSpecialized = memorySize != 7;
+            if (specialized.usesSpecializedKernel() != expectSpecialized || generic.usesSpecializedKernel()) {
+                std::cout << "  [FAIL] Wrong kernel selected for memory size " << memorySize << std::endl;
+                return false;
+            }
+            for (int i = 0; i < 300; ++i) {
+                specialized.step();
+                generic.step();
+            }
+            std::stringstream a, b;
+            specialized.saveState(a);
+            generic.saveState(b);
+            if (a.str() != b.str()) {
+                std::cout << "  [FAIL] Specialised kernel diverged for memory size " << memorySize << std::endl;
+                return false;
+            }
+        }
+    }
+
+    // Mixed memory sizes have no fixed capacity and fall back to the generic path.
+    Ground mixed(10, 10, prob, { 0.3, 0.7 }, 2);
+    mixed.addAnt(10);
+    mixed.addAnt(20);
+    if (mixed.usesSpecializedKernel()) {
+        std::cout << "  [FAIL] Mixed memory sizes used a specialised kernel." << std::endl;
+        return false;
+    }
+
+    // Diagonal neighbours count for Moore but not for von Neumann. An ant
+    // on a Food cell whose four diagonal cells hold Food sees density 4/8
+    // (pick-up chance 0.5) under Moore but 0/4 (always picks up) under von
+    // Neumann. The state is written by hand: the grid starts at byte 64 and
+    // the single ant's x and y follow the colony count and stride.
+    auto picksUp = [&](AIConfig::NeighborhoodType neighborhood, std::uint64_t seed) {
+        Ground ground(3, 3, prob, { 0.3, 0.7 }, 100, 5, seed);
+        ground.setNeighborhood(neighborhood);
+        ground.addAnt(10);
+        std::stringstream state;
+        ground.saveState(state);
+        std::string bytes = state.str();
+        const char food = static_cast<char>(AIConfig::ObjectType::Food);
+        const char none = static_cast<char>(AIConfig::ObjectType::None);
+        const char cells[9] = { food, none, food, none, food, none, food, none, food };
+        std::copy(cells, cells + 9, bytes.begin() + 64);
+        const char one[4] = { 1, 0, 0, 0 };
+        std::copy(one, one + 4, bytes.begin() + 64 + 9 + 12);
+        std::copy(one, one + 4, bytes.begin() + 64 + 9 + 16);
+        std::stringstream patched(bytes);
+        ground.loadState(patched);
+        ground.assignWork();
+        return ground.getColony().getLoad(0) == AIConfig::ObjectType::Food;
+    };
+    int moore = 0, vonNeumann = 0;
+    for (std::uint64_t seed = 1; seed <= 40; ++seed) {
+        moore += picksUp(AIConfig::NeighborhoodType::Moore, seed);
+        vonNeumann += picksUp(AIConfig::NeighborhoodType::VonNeumann, seed);
+    }
+    if (vonNeumann != 40 || moore == 0 || moore == 40) {
+        std::cout << "  [FAIL] Pick-ups: von Neumann " << vonNeumann << "/40, Moore " << moore << "/40" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+
+// A tiled grid must behave exactly like a row-major one, on grids that end
+// partway through a block and when the layout changes mid-run.
+bool test_tiled_layout_matches_row_major() {
+    const int width = 130, length = 70;
+    Grid flat(width, length);
+    Grid tiled(width, length, AIConfig::GridLayout::Tiled);
+    std::mt19937 rng(5);
+    std::uniform_int_distribution<int> typeDist(0, AIConfig::NUM_OBJECT_TYPES - 1);
+    std::vector<std::uint8_t> types(flat.size());
+    for (auto& t : types) {
+        t = static_cast<std::uint8_t>(typeDist(rng));
+    }
+    flat.importRowMajor(types.data());
+    tiled.importRowMajor(types.data());
+
+    std::vector<bool> used(tiled.storageSize(), false);
+    for (int y = 0; y < length; ++y) {
+        for (int x = 0; x < width; ++x) {
+            std::size_t index = tiled.index(x, y);
+            if (index >= used.size() || used[index] || tiled.get(x, y) != flat.get(x, y)
+                || tiled.neighbors(x, y) != flat.neighbors(x, y)) {
+                std::cout << "  [FAIL] Tiled cell (" << x << "," << y << ") is wrong." << std::endl;
+                return false;
+            }
+            used[index] = true;
+        }
+    }
+    std::vector<std::uint8_t> exported(tiled.size());
+    tiled.exportRowMajor(exported.data());
+    if (exported != types || tiled.count(AIConfig::ObjectType::Food) != flat.count(AIConfig::ObjectType::Food)) {
+        std::cout << "  [FAIL] Tiled export or count differs." << std::endl;
+        return false;
+    }
+
+    std::vector<double> prob = { 12, 5, 2, 1, 0.1, 1, 2, 5 };
+    auto makeGround = [&](AIConfig::GridLayout layout) {
+        Ground ground(width, length, prob, { 0.3, 0.7 }, 3, 4, 77);
+        ground.setGridLayout(layout);
+        ground.setRecordPath(true);
+        ground.addObject(std::unordered_map<AIConfig::ObjectType, double>{
+            { AIConfig::ObjectType::Food, 0.2 }, { AIConfig::ObjectType::Egg, 0.2 }, { AIConfig::ObjectType::None, 0.6 } });
+        for (int i = 0; i < 200; ++i) {
+            ground.addAnt(8);
+        }
+        return ground;
+    };
+    Ground rowMajor = makeGround(AIConfig::GridLayout::RowMajor);
+    Ground blocked = makeGround(AIConfig::GridLayout::Tiled);
+    for (int i = 0; i < 300; ++i) {
+        if (i == 150) {
+            rowMajor.setGridLayout(AIConfig::GridLayout::Tiled);
+            blocked.setGridLayout(AIConfig::GridLayout::RowMajor);
+        }
+        rowMajor.step();
+        blocked.step();
+    }
+    std::stringstream a, b;
+    rowMajor.saveState(a);
+    blocked.saveState(b);
+    bool ok = a.str() == b.str() && rowMajor.averageClusterSize() == blocked.averageClusterSize()
+        && rowMajor.coveredCells() == blocked.coveredCells();
+    for (int y = 0; ok && y < length; ++y) {
+        for (int x = 0; ok && x < width; ++x) {
+            ok = rowMajor.visitCount(x, y) == blocked.visitCount(x, y);
+        }
+    }
+    if (!ok) {
+        std::cout << "  [FAIL] Tiled ground diverged from the row-major one." << std::endl;
+    }
+    return ok;
+}
+
+// Sorting reorders ants but each ant keeps its random streams, and a sorted
+// run resumes from a saved state exactly.
+bool test_ant_sorting_keeps_streams() {
+    std::vector<double> prob = { 12, 5, 2, 1, 0.1, 1, 2, 5 };
+    auto makeGround = [&]() {
+        Ground ground(90, 70, prob, { 0.3, 0.7 }, 3, 4, 31);
+        ground.setGridLayout(AIConfig::GridLayout::Tiled);
+        ground.addObject(std::unordered_map<AIConfig::ObjectType, double>{
+            { AIConfig::ObjectType::Food, 0.3 }, { AIConfig::ObjectType::None, 0.7 } });
+        for (int i = 0; i < 150; ++i) {
+            ground.addAnt(6);
+        }
+        return ground;
+    };
+
+    // Moves never read other ants, so positions per id must not depend on order.
+    Ground unsorted = makeGround();
+    Ground sorted = makeGround();
+    sorted.setAntSortInterval(7);
+    for (int i = 0; i < 50; ++i) {
+        unsorted.moveAnts();
+        sorted.moveAnts();
+    }
+    const AntColony& plain = unsorted.getColony();
+    const AntColony& shuffled = sorted.getColony();
+    bool moved = false;
+    for (std::size_t k = 0; k < shuffled.size(); ++k) {
+        std::uint32_t id = shuffled.getId(k);
+        moved = moved || id != k;
+        if (plain.getId(id) != id || shuffled.getX(k) != plain.getX(id) || shuffled.getY(k) != plain.getY(id)
+            || shuffled.getPrevDirection(k) != plain.getPrevDirection(id)) {
+            std::cout << "  [FAIL] Ant " << id << " moved differently after sorting." << std::endl;
+            return false;
+        }
+    }
+    sorted.sortAnts();
+    for (std::size_t k = 1; k < shuffled.size(); ++k) {
+        const Grid& grid = sorted.getGrid();
+        if (grid.index(shuffled.getX(k - 1), shuffled.getY(k - 1)) > grid.index(shuffled.getX(k), shuffled.getY(k))) {
+            std::cout << "  [FAIL] Ants are not in grid storage order." << std::endl;
+            return false;
+        }
+    }
+    if (!moved) {
+        std::cout << "  [FAIL] Sorting never reordered any ant." << std::endl;
+        return false;
+    }
+
+    for (int i = 0; i < 100; ++i) {
+        sorted.step();
+    }
+    std::stringstream checkpoint;
+    sorted.saveState(checkpoint);
+    Ground resumed = makeGround();
+    resumed.setAntSortInterval(7);
+    resumed.loadState(checkpoint);
+    for (int i = 0; i < 100; ++i) {
+        sorted.step();
+        resumed.step();
+    }
+    std::stringstream a, b;
+    sorted.saveState(a);
+    resumed.saveState(b);
+    if (a.str() != b.str()) {
+        std::cout << "  [FAIL] Sorted run did not resume exactly." << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// Run body once per rank of an in-process world, each rank on its own thread.
+// Returns false if any rank threw.
+bool run_ranks(int ranks, const std::function<void(Communicator&)>& body) {
+    InProcessWorld world(ranks);
+    std::vector<std::thread> threads;
+    std::vector<std::string> errors(ranks);
+    for (int r = 0; r < ranks; ++r) {
+        threads.emplace_back([&, r]() {
+            try {
+                body(world.communicator(r));
+            }
+            catch (const std::exception& e) {
+                errors[r] = e.what();
+            }
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+    for (int r = 0; r < ranks; ++r) {
+        if (!errors[r].empty()) {
+            std::cout << "  [FAIL] Rank " << r << " threw: " << errors[r] << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+const std::unordered_map<AIConfig::ObjectType, double> DISTRIBUTED_OBJECTS = {
+    { AIConfig::ObjectType::Food, 0.2 }, { AIConfig::ObjectType::Egg, 0.1 },
+    { AIConfig::ObjectType::Waste, 0.1 }, { AIConfig::ObjectType::None, 0.6 } };
+
+// Without interactions a split ground is the parallel Ground, cell for cell.
+bool test_distributed_ground_matches_parallel() {
+    const int width = 130, length = 70;
+    std::vector<double> prob = { 12, 5, 2, 1, 0.1, 1, 2, 5 };
+    Ground reference(width, length, prob, { 0.3, 0.7 }, 3, 4, 61);
+    reference.setStepMode(AIConfig::StepMode::Parallel);
+    reference.addObject(DISTRIBUTED_OBJECTS);
+    for (int i = 0; i < 300; ++i) {
+        reference.addAnt(8);
+    }
+    for (int i = 0; i < 120; ++i) {
+        reference.moveAnts();
+        reference.assignWork();
+    }
+    std::stringstream expected;
+    reference.saveState(expected);
+    const double expectedCluster = reference.averageClusterSize();
+
+    std::stringstream gathered;
+    std::vector<double> clusters(3, -1.0);
+    bool ran = run_ranks(3, [&](Communicator& comm) {
+        DistributedGround ground(comm, width, length, prob, { 0.3, 0.7 }, 3, 4, 61);
+        ground.addObject(DISTRIBUTED_OBJECTS);
+        for (int i = 0; i < 300; ++i) {
+            ground.addAnt(8);
+        }
+        for (int i = 0; i < 120; ++i) {
+            ground.moveAnts();
+            ground.assignWork();
+        }
+        for (std::size_t k = 0; k < ground.getColony().size(); ++k) {
+            int y = ground.getColony().getY(k);
+            if (y < ground.firstRow() || y >= ground.endRow()) {
+                throw std::runtime_error("ant outside its slab");
+            }
+        }
+        clusters[comm.rank()] = ground.averageClusterSize();
+        ground.gatherState(gathered);
+    });
+    if (!ran) {
+        return false;
+    }
+    if (gathered.str() != expected.str()) {
+        std::cout << "  [FAIL] Gathered state differs from the parallel Ground." << std::endl;
+        return false;
+    }
+    for (double c : clusters) {
+        if (c != expectedCluster) {
+            std::cout << "  [FAIL] Cluster size " << c << ", expected " << expectedCluster << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+// Full steps, interactions included, give the same run on any number of ranks.
+bool test_distributed_ground_rank_independent() {
+    const int width = 96, length = 70;
+    std::vector<double> prob = { 12, 5, 2, 1, 0.1, 1, 2, 5 };
+    auto simulate = [&](Communicator& comm, std::ostream& state, int& interactions) {
+        DistributedGround ground(comm, width, length, prob, { 0.3, 0.7 }, 2, 3, 83);
+        ground.setNeighborhood(AIConfig::NeighborhoodType::VonNeumann);
+        ground.addObject(DISTRIBUTED_OBJECTS);
+        for (int i = 0; i < 400; ++i) {
+            ground.addAnt(6);
+        }
+        for (int i = 0; i < 150; ++i) {
+            ground.step();
+        }
+        interactions = ground.getInteractionCount();
+        ground.gatherState(state);
+    };
+
+    SelfCommunicator self;
+    std::stringstream single;
+    int singleInteractions = 0;
+    simulate(self, single, singleInteractions);
+    if (singleInteractions == 0) {
+        std::cout << "  [FAIL] No interactions happened." << std::endl;
+        return false;
+    }
+    Ground loaded(width, length, prob, { 0.3, 0.7 }, 2, 3, 83);
+    loaded.loadState(single);
+    if (loaded.getColony().size() != 400 || loaded.getInteractionCount() != singleInteractions) {
+        std::cout << "  [FAIL] Gathered state does not load into a Ground." << std::endl;
+        return false;
+    }
+
+    for (int ranks : { 2, 4 }) {
+        std::stringstream split;
+        std::vector<int> interactions(ranks, -1);
+        bool ran = run_ranks(ranks, [&](Communicator& comm) {
+            simulate(comm, split, interactions[comm.rank()]);
+        });
+        if (!ran) {
+            return false;
+        }
+        if (split.str() != single.str()
+            || std::count(interactions.begin(), interactions.end(), singleInteractions) != ranks) {
+            std::cout << "  [FAIL] " << ranks << " ranks diverged from one." << std::endl;
+            return false;
+        }
+    }
+
+    try {
+        DistributedGround::slabRows(length, 6, 0);
+        std::cout << "  [FAIL] More ranks than tile rows was accepted." << std::endl;
+        return false;
+    }
+    catch (const std::invalid_argument&) {
+    }
+    return true;
+}
+
+// Only the root holds a metrics stream and prints progress, yet every rank
+// must enter the collective metrics together: progress iterations that are
+// not sample iterations used to leave the root out and hang the others.
+bool test_distributed_run_with_metrics() {
+    const std::string filename = "test_distributed_metrics.ndjson";
+    const int width = 96, length = 70;
+    std::vector<double> prob = { 12, 5, 2, 1, 0.1, 1, 2, 5 };
+    DistributedRun::Options options;
+    options.iterations = 200;
+    options.sampleInterval = 30;
+    options.reportInterval = 40;
+    const ResultRow tag{ 5, 10, 1, 0, 0.0, 0 };
+    auto simulate = [&](Communicator& comm, MetricsStream* metrics, std::ostream* progress) {
+        DistributedGround ground(comm, width, length, prob, { 0.3, 0.7 }, 10, 5, 29);
+        ground.addObject(DISTRIBUTED_OBJECTS);
+        for (int i = 0; i < 300; ++i) {
+            ground.addAnt(8);
+        }
+        return DistributedRun::run(ground, comm, tag, options, metrics, progress);
+    };
+
+    SelfCommunicator self;
+    const std::vector<ResultRow> expected = simulate(self, nullptr, nullptr);
+
+    std::vector<ResultRow> rows;
+    std::ostringstream progress;
+    bool ran = false;
+    {
+        MetricsStream metrics(filename, 1);
+        ran = run_ranks(2, [&](Communicator& comm) {
+            const bool root = comm.rank() == 0;
+            std::vector<ResultRow> ranked = simulate(comm, root ? &metrics : nullptr, root ? &progress : nullptr);
+            if (root) {
+                rows = std::move(ranked);
+            }
+            else if (!ranked.empty()) {
+                throw std::runtime_error("a non-root rank returned rows");
+            }
+        });
+        metrics.finish();
+    }
+    std::ifstream in(filename);
+    int samples = 0, runEnds = 0;
+    for (std::string line; std::getline(in, line);) {
+        samples += line.find("\"sample\"") != std::string::npos ? 1 : 0;
+        runEnds += line.find("\"run_end\"") != std::string::npos ? 1 : 0;
+    }
+    in.close();
+    std::remove(filename.c_str());
+    if (!ran) {
+        return false;
+    }
+
+    bool ok = rows.size() == expected.size() && samples == static_cast<int>(rows.size()) && runEnds == 1;
+    for (std::size_t k = 0; ok && k < rows.size(); ++k) {
+        ok = rows[k].iteration == expected[k].iteration && rows[k].clusterSize == expected[k].clusterSize
+            && rows[k].interactionCount == expected[k].interactionCount;
+    }
+    // Progress at iterations 0, 40, ..., 160.
+    const std::string lines = progress.str();
+    ok = ok && std::count(lines.begin(), lines.end(), '\n') == 5;
+    if (!ok) {
+        std::cout << "  [FAIL] Distributed run with metrics lost or changed samples." << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// Device moves are Ground's moves, ant by ant, whatever the host ant order.
+bool test_device_ground_matches_ground_moves() {
+    const int width = 90, length = 60;
+    std::vector<double> prob = { 12, 5, 2, 1, 0.1, 1, 2, 5 };
+    Ground reference(width, length, prob, { 0.3, 0.7 }, 3, 4, 29);
+    reference.addObject(DISTRIBUTED_OBJECTS);
+    for (int i = 0; i < 500; ++i) {
+        reference.addAnt(8);
+    }
+    reference.sortAnts();
+    DeviceGround device(reference);
+    for (int i = 0; i < 150; ++i) {
+        reference.moveAnts();
+        device.moveAnts();
+    }
+
+    std::stringstream state;
+    device.saveState(state);
+    Ground loaded(width, length, prob, { 0.3, 0.7 }, 3, 4, 29);
+    loaded.loadState(state);
+    const AntColony& expected = reference.getColony();
+    const AntColony& actual = loaded.getColony();
+    if (actual.size() != expected.size()) {
+        std::cout << "  [FAIL] Device ground has " << actual.size() << " ants." << std::endl;
+        return false;
+    }
+    for (std::size_t k = 0; k < expected.size(); ++k) {
+        const std::uint32_t id = expected.getId(k);
+        if (actual.getId(id) != id || actual.getX(id) != expected.getX(k) || actual.getY(id) != expected.getY(k)
+            || actual.getPrevDirection(id) != expected.getPrevDirection(k)) {
+            std::cout << "  [FAIL] Ant " << id << " moved differently on the device." << std::endl;
+            return false;
+        }
+    }
+    if (device.averageClusterSize() != reference.averageClusterSize()) {
+        std::cout << "  [FAIL] Device cluster size differs before any work." << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// Full device steps conserve objects, are thread-count independent, and the
+// device cluster labelling agrees with ClusterTracker.
+bool test_device_ground_steps() {
+    const int width = 80, length = 70;
+    std::vector<double> prob = { 12, 5, 2, 1, 0.1, 1, 2, 5 };
+    Ground initial(width, length, prob, { 0.3, 0.7 }, 2, 3, 47);
+    initial.setNeighborhood(AIConfig::NeighborhoodType::VonNeumann);
+    initial.addObject(DISTRIBUTED_OBJECTS);
+    for (int i = 0; i < 900; ++i) {
+        initial.addAnt(6);
+    }
+    auto typeTotals = [](const Ground& ground) {
+        std::vector<int> totals(AIConfig::NUM_OBJECT_TYPES, 0);
+        for (std::size_t c = 0; c < ground.getGrid().size(); ++c) {
+            ++totals[ground.getGrid().data()[c]];
+        }
+        for (std::size_t i = 0; i < ground.getColony().size(); ++i) {
+            ++totals[static_cast<int>(ground.getColony().getLoad(i))];
+        }
+        return totals;
+    };
+    const std::vector<int> before = typeTotals(initial);
+
+    auto simulate = [&](int threads, std::string& state, double& cluster, int& interactions) {
+#ifdef _OPENMP
+        const int saved = omp_get_max_threads();
+        omp_set_num_threads(threads);
+#else
+        (void)threads;
+#endif
+        DeviceGround device(initial);
+        for (int i = 0; i < 200; ++i) {
+            device.step();
+        }
+        cluster = device.averageClusterSize();
+        interactions = device.getInteractionCount();
+        std::stringstream out;
+        device.saveState(out);
+        state = out.str();
+#ifdef _OPENMP
+        omp_set_num_threads(saved);
+#endif
+    };
+    std::string serialState, parallelState;
+    double serialCluster = 0.0, parallelCluster = 0.0;
+    int serialInteractions = 0, parallelInteractions = 0;
+    simulate(1, serialState, serialCluster, serialInteractions);
+    simulate(4, parallelState, parallelCluster, parallelInteractions);
+    if (serialState != parallelState || serialCluster != parallelCluster || serialInteractions != parallelInteractions) {
+        std::cout << "  [FAIL] Device run depends on the thread count." << std::endl;
+        return false;
+    }
+    if (serialInteractions == 0) {
+        std::cout << "  [FAIL] No interactions happened." << std::endl;
+        return false;
+    }
+
+    Ground loaded(width, length, prob, { 0.3, 0.7 }, 2, 3, 47);
+    std::stringstream in(serialState);
+    loaded.loadState(in);
+    if (typeTotals(loaded) != before) {
+        std::cout << "  [FAIL] Objects were created or lost on the device." << std::endl;
+        return false;
+    }
+    if (std::abs(loaded.averageClusterSize() - serialCluster) > 1e-12) {
+        std::cout << "  [FAIL] Device cluster size " << serialCluster << ", expected "
+                  << loaded.averageClusterSize() << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// Every replica of a batch is the serial Ground it was built from, stepped alone.
+bool test_replica_batch_matches_grounds() {
+    const int width = 40, length = 30;
+    std::vector<double> prob = { 12, 5, 2, 1, 0.1, 1, 2, 5 };
+    std::vector<std::unique_ptr<Ground>> grounds;
+    std::vector<const Ground*> replicas;
+    for (int r = 0; r < 5; ++r) {
+        grounds.push_back(std::make_unique<Ground>(width, length, prob, std::vector<double>{ 0.3, 0.7 },
+            1 + r % 3, 2 + r, 100 + r));
+        grounds.back()->addObject(DISTRIBUTED_OBJECTS);
+        for (int i = 0; i < 60; ++i) {
+            grounds.back()->addAnt(6);
+        }
+        replicas.push_back(grounds.back().get());
+    }
+    // Ant ids need not follow the index order.
+    grounds[2]->sortAnts();
+
+    ReplicaBatch batch(replicas);
+    for (int step = 0; step < 300; ++step) {
+        batch.step();
+        for (auto& ground : grounds) {
+            ground->moveAnts();
+            ground->assignWork();
+            ground->handleAntInteractions(step);
+        }
+    }
+    for (std::size_t r = 0; r < grounds.size(); ++r) {
+        std::stringstream expected, actual;
+        grounds[r]->saveState(expected);
+        batch.saveState(r, actual);
+        if (actual.str() != expected.str()) {
+            std::cout << "  [FAIL] Replica " << r << " diverged from its Ground." << std::endl;
+            return false;
+        }
+        if (batch.averageClusterSize(r) != grounds[r]->averageClusterSize()
+            || batch.getInteractionCount(r) != grounds[r]->getInteractionCount()) {
+            std::cout << "  [FAIL] Replica " << r << " metrics differ." << std::endl;
+            return false;
+        }
+    }
+    if (grounds[0]->getInteractionCount() == 0) {
+        std::cout << "  [FAIL] No interactions happened." << std::endl;
+        return false;
+    }
+
+    Ground other(width + 1, length, prob, { 0.3, 0.7 }, 1, 2, 7);
+    replicas.push_back(&other);
+    try {
+        ReplicaBatch mixed(replicas);
+        std::cout << "  [FAIL] Grounds of different sizes were batched." << std::endl;
+        return false;
+    }
+    catch (const std::invalid_argument&) {
+    }
+    return true;
+}
 
 int main() {
     TestSuite suite;
 
     suite.run("Movement Inertia", test_movement_inertia);
+    suite.run("Direction Sampler Matches Rotation", test_direction_sampler_matches_rotation);
+    suite.run("Rng Block Matches Keys", test_rng_block_matches_keys);
     suite.run("Memory FIFO Logic", test_memory_fifo);
     suite.run("Memory Ignores Null", test_memory_ignores_nullptr);
     suite.run("Interaction Logic by Threshold", test_interaction_thresholds);
     suite.run("Movement at Boundaries", test_movement_at_boundaries);
+    suite.run("Neighborhood Matches Adjacency", test_neighborhood_matches_adjacency);
+    suite.run("Packed Neighbor Counts", test_packed_neighbor_counts);
+    suite.run("Grid Row-Major Storage", test_grid_row_major_storage);
+    suite.run("Ground Object Fill", test_ground_object_fill);
+    suite.run("Object Type Adapter", test_object_type_adapter);
+    suite.run("Seeded Reproducibility", test_seeded_reproducibility);
+    suite.run("Bulk Initialization", test_bulk_initialization);
+    suite.run("Parallel Step Thread Independence", test_parallel_step_is_thread_count_independent);
+    suite.run("Colony Memory Matches Ant", test_colony_memory_matches_ant);
+    suite.run("Memory Ring Running Counts", test_memory_ring_counts);
+    suite.run("Cell List Index", test_cell_index);
+    suite.run("Cluster Tracker Matches Flood Fill", test_cluster_tracker_matches_flood_fill);
+    suite.run("Frame Pipeline", test_frame_pipeline);
+    suite.run("Results Writer Order", test_results_writer_order);
+    suite.run("Results Writer Binary Layout", test_results_writer_binary_layout);
+    suite.run("Metrics Stream", test_metrics_stream);
+    suite.run("Convergence Detector", test_convergence_detector);
+    suite.run("Save and Load State", test_save_and_load_state);
+    suite.run("Run Checkpoint Identity", test_run_checkpoint_identity);
+    suite.run("Resumed Sweep Matches Uninterrupted", test_resumed_sweep_matches_uninterrupted);
+    suite.run("Profiling Report", test_profiling_report);
+    suite.run("Fused Step Matches Phases", test_fused_step_matches_phases);
+    suite.run("Visited Path Recording", test_visited_path_recording);
+    suite.run("Specialized Kernels Match Generic", test_specialized_kernels_match_generic);
+    suite.run("Tiled Layout Matches Row-Major", test_tiled_layout_matches_row_major);
+    suite.run("Ant Sorting Keeps Streams", test_ant_sorting_keeps_streams);
+    suite.run("Distributed Ground Matches Parallel", test_distributed_ground_matches_parallel);
+    suite.run("Distributed Ground Rank Independent", test_distributed_ground_rank_independent);
+    suite.run("Distributed Run With Metrics", test_distributed_run_with_metrics);
+    suite.run("Device Ground Matches Ground Moves", test_device_ground_matches_ground_moves);
+    suite.run("Device Ground Steps", test_device_ground_steps);
+    suite.run("Replica Batch Matches Grounds", test_replica_batch_matches_grounds);
 
     suite.summary();
 